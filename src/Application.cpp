@@ -39,6 +39,7 @@
 #include "common/Player.h"
 #include "common/Properties.h"
 #include "gfx/DebugLayer.h"
+#include "gfx/FontCache.h"
 #include "gfx/GameWindow.h"
 #include "gfx/Stage.h"
 #include "gfx/race/ui/RaceUI.h"
@@ -59,6 +60,12 @@ const int SYNC_PARAM = 1;
 #endif
 
 
+/** Releases cached fonts when leaving the scope */
+struct FontCacheGuard
+{
+	~FontCacheGuard() { Gfx::FontCache::clear(); }
+};
+
 class Application
 {
 	public:
@@ -178,6 +185,9 @@ int Application::main(const std::vector<CL_String> &args)
 
 		CL_DisplayWindow displayWindow(winDesc);
 
+		// fonts must go before the display window, also on exception
+		FontCacheGuard fontCacheGuard;
+
 		// window close action
 		slots.connect_functor(displayWindow.sig_window_close(), &Application::onWindowClose);
 
@@ -260,5 +270,8 @@ int Application::main(const std::vector<CL_String> &args)
 
 void Application::onWindowClose()
 {
+	// exit() does not unwind the stack, display window is still alive here
+	Gfx::FontCache::clear();
+
 	exit(0);
 }
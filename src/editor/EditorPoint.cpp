@@ -114,6 +114,7 @@ namespace Editor
 		m_track.addPoint(CL_Pointf(200.0f, 950.0f), DEFAULT_RADIUS, DEFAULT_SHIFT);
 
 		m_gfxLevel.getTrackTriangulator().triangulate(m_track);
+		m_raceLevel.rebuildChunks();
 	}
 
 	void EditorPoint::drawPoints(CL_GraphicContext &p_gc)
@@ -317,6 +318,8 @@ namespace Editor
 				}
 			}
 		}
+
+		m_raceLevel.rebuildChunks();
 	}
 
 	void EditorPoint::onDraw(CL_GraphicContext &p_gc)
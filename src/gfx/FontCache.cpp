@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FontCache.h"
+
+#include "common.h"
+
+namespace Gfx {
+
+FontCache::TFontMap *FontCache::m_fonts = NULL;
+
+FontCache::TFontMap &FontCache::getFonts()
+{
+	if (!m_fonts) {
+		m_fonts = new TFontMap();
+	}
+
+	return *m_fonts;
+}
+
+bool FontCache::Key::operator<(const Key &p_other) const
+{
+	if (m_size != p_other.m_size) {
+		return m_size < p_other.m_size;
+	}
+
+	if (m_weight != p_other.m_weight) {
+		return m_weight < p_other.m_weight;
+	}
+
+	if (m_freetype != p_other.m_freetype) {
+		return m_freetype < p_other.m_freetype;
+	}
+
+	return m_typeface < p_other.m_typeface;
+}
+
+FontCache::Entry &FontCache::find(
+		CL_GraphicContext &p_gc,
+		const CL_String &p_typeface,
+		int p_size, int p_weight, bool p_freetype
+)
+{
+	Key key;
+	key.m_typeface = p_typeface;
+	key.m_size = p_size;
+	key.m_weight = p_weight;
+	key.m_freetype = p_freetype;
+
+	TFontMap &fonts = getFonts();
+	TFontMap::iterator itor = fonts.find(key);
+
+	if (itor != fonts.end()) {
+		return itor->second;
+	}
+
+	CL_FontDescription desc;
+	desc.set_typeface_name(p_typeface);
+	desc.set_height(p_size);
+
+	if (p_weight != 0) {
+		desc.set_weight(p_weight);
+	}
+
+	Entry &entry = fonts[key];
+
+	if (p_freetype) {
+		entry.m_font = CL_Font_Freetype(p_gc, desc);
+	} else {
+		entry.m_font = CL_Font_System(p_gc, desc);
+	}
+
+	entry.m_metrics = entry.m_font.get_font_metrics(p_gc);
+
+	cl_log_event(LOG_DEBUG, "font loaded: %1 %2 (%3)", p_typeface, p_size, p_weight);
+
+	return entry;
+}
+
+CL_Font FontCache::get(
+		CL_GraphicContext &p_gc,
+		const CL_String &p_typeface,
+		int p_size, int p_weight, bool p_freetype
+)
+{
+	return find(p_gc, p_typeface, p_size, p_weight, p_freetype).m_font;
+}
+
+const CL_FontMetrics &FontCache::getMetrics(
+		CL_GraphicContext &p_gc,
+		const CL_String &p_typeface,
+		int p_size, int p_weight, bool p_freetype
+)
+{
+	return find(p_gc, p_typeface, p_size, p_weight, p_freetype).m_metrics;
+}
+
+void FontCache::clear()
+{
+	if (m_fonts) {
+		m_fonts->clear();
+	}
+}
+
+} // namespace
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <map>
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+
+namespace Gfx {
+
+/**
+ * Process-wide cache of fonts.
+ * <p>
+ * Font with the same typeface, size and weight is created only once and
+ * shared by everyone who asks for it, together with its glyph textures.
+ */
+class FontCache {
+
+	public:
+
+		/**
+		 * @param p_typeface Typeface name or font file path.
+		 * @param p_freetype Load <code>p_typeface</code> as file with
+		 * FreeType instead of asking the system.
+		 * @return Shared font.
+		 */
+		static CL_Font get(
+				CL_GraphicContext &p_gc,
+				const CL_String &p_typeface,
+				int p_size,
+				int p_weight = 0,
+				bool p_freetype = false
+		);
+
+		/** @return Metrics of font returned by get() with same parameters */
+		static const CL_FontMetrics &getMetrics(
+				CL_GraphicContext &p_gc,
+				const CL_String &p_typeface,
+				int p_size,
+				int p_weight = 0,
+				bool p_freetype = false
+		);
+
+		/**
+		 * Releases all fonts. Call it before the graphic context is gone.
+		 * Fonts that are not released are never destroyed.
+		 */
+		static void clear();
+
+	private:
+
+		struct Key {
+
+			CL_String m_typeface;
+
+			int m_size, m_weight;
+
+			bool m_freetype;
+
+			bool operator<(const Key &p_other) const;
+		};
+
+		struct Entry {
+
+			CL_Font m_font;
+
+			CL_FontMetrics m_metrics;
+		};
+
+		typedef std::map<Key, Entry> TFontMap;
+
+		/** Never deleted, so no font outlives the display in static destruction */
+		static TFontMap *m_fonts;
+
+		static TFontMap &getFonts();
+
+		static Entry &find(
+				CL_GraphicContext &p_gc,
+				const CL_String &p_typeface,
+				int p_size, int p_weight, bool p_freetype
+		);
+
+		FontCache() {}
+};
+
+} // namespace
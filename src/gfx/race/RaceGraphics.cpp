@@ -35,32 +35,38 @@
 #include "gfx/DebugLayer.h"
 #include "gfx/Stage.h"
 #include "gfx/race/level/Bound.h"
-#include "gfx/race/level/Car.h"
 #include "gfx/race/level/DecorationSprite.h"
 #include "gfx/race/level/Sandpit.h"
 #include "gfx/race/level/Smoke.h"
-#include "gfx/race/ui/SpeedMeter.h"
 #include "logic/race/Block.h"
+#include "logic/race/Car.h"
 #include "logic/race/level/Bound.h"
+#include "logic/race/level/BoundTree.h"
 #include "logic/race/Progress.h"
 #include "logic/race/RaceLogic.h"
 #include "logic/race/level/Checkpoint.h"
 
 namespace Gfx {
 
+/** Spatial index cell size of decorations and sandpits */
+static const float DRAWABLE_CELL_SIZE = Units::toScreen(50.0f);
+
 RaceGraphics::RaceGraphics(const Race::RaceLogic *p_logic) :
 		m_loaded(false),
+		m_levelUploaded(false),
 		m_viewport(),
 		m_logic(p_logic),
 		m_level(p_logic->getLevel(), m_viewport),
 		m_raceUI(p_logic, &m_viewport),
-		m_tyreStripes(p_logic->getLevel())
+		m_cars(),
+		m_tyreStripes(m_viewport),
+		m_snapshotFresh(false),
+		m_logicTime(0),
+		m_snapshotTime(0)
 {
-	// attach viewport to player's car
-	Game &game = Game::getInstance();
-
-	Player &player = game.getPlayer();
-	m_viewport.attachTo(&(player.getCar().getPosition()));
+	// viewport follows player's car as seen in the drawn snapshot
+	m_cameraTarget = Game::getInstance().getPlayer().getCar().getPosition();
+	m_viewport.attachTo(&m_cameraTarget);
 }
 
 RaceGraphics::~RaceGraphics()
@@ -79,13 +85,9 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 			CL_Colorf::green
 	);
 
-	if (m_logic->getLevel().isUsable()) {
+	if (uploadLevel(p_gc)) {
 
-		// load level graphics when level logic is loaded
-		// FIXME: Maybe I should wait for gamestate in separate scene?
-		if (!m_level.isLoaded()) {
-			m_level.load(p_gc);
-		}
+		applySnapshot();
 
 		// initialize player's viewport
 		m_viewport.prepareGC(p_gc);
@@ -100,6 +102,8 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 
 		// revert player's viewport
 		m_viewport.finalizeGC(p_gc);
+	} else if (!m_logic->hasLoadFailed()) {
+		drawLoading(p_gc);
 	}
 
 	// draw the user interface
@@ -114,6 +118,46 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 #endif // NDEBUG
 }
 
+bool RaceGraphics::uploadLevel(CL_GraphicContext &p_gc)
+{
+	if (m_levelUploaded) {
+		return true;
+	}
+
+	if (!m_logic->isReady()) {
+		return false;
+	}
+
+	// upload one resource per frame, so the frame rate will not drop
+	if (!m_level.isLoaded()) {
+		m_level.load(p_gc);
+		return false;
+	}
+
+	if (!m_cars.isLoaded()) {
+		m_cars.load(p_gc);
+		return false;
+	}
+
+	m_levelUploaded = true;
+	return true;
+}
+
+void RaceGraphics::drawLoading(CL_GraphicContext &p_gc)
+{
+	static const float BAR_WIDTH = 0.5f;
+	static const float BAR_HEIGHT = 20.0f;
+
+	const float w = Stage::getWidth() * BAR_WIDTH;
+	const float x = (Stage::getWidth() - w) / 2;
+	const float y = (Stage::getHeight() - BAR_HEIGHT) / 2;
+
+	const float progress = m_logic->getLoadProgress();
+
+	CL_Draw::fill(p_gc, x, y, x + w * progress, y + BAR_HEIGHT, CL_Colorf::white);
+	CL_Draw::box(p_gc, x, y, x + w, y + BAR_HEIGHT, CL_Colorf::white);
+}
+
 void RaceGraphics::load(CL_GraphicContext &p_gc)
 {
 	m_raceUI.load(p_gc);
@@ -147,6 +191,15 @@ void RaceGraphics::loadDecorations(CL_GraphicContext &p_gc)
 //
 //		}
 //	}
+
+	std::vector<CL_Rectf> bounds;
+	bounds.reserve(m_decorations.size());
+
+	foreach (const CL_SharedPtr<Gfx::DecorationSprite> &decoration, m_decorations) {
+		bounds.push_back(decoration->getBounds());
+	}
+
+	m_decorationIndex.build(bounds, DRAWABLE_CELL_SIZE);
 }
 
 void RaceGraphics::loadSandPits(CL_GraphicContext &p_gc)
@@ -163,6 +216,15 @@ void RaceGraphics::loadSandPits(CL_GraphicContext &p_gc)
 //		gfxSandpit->load(p_gc);
 //		m_sandpits.push_back(gfxSandpit);
 //	}
+
+	std::vector<CL_Rectf> bounds;
+	bounds.reserve(m_sandpits.size());
+
+	foreach (const CL_SharedPtr<Gfx::Sandpit> &sandpit, m_sandpits) {
+		bounds.push_back(sandpit->getBounds());
+	}
+
+	m_sandpitIndex.build(bounds, DRAWABLE_CELL_SIZE);
 }
 
 void RaceGraphics::loadTyreStripes(CL_GraphicContext &p_gc)
@@ -172,28 +234,43 @@ void RaceGraphics::loadTyreStripes(CL_GraphicContext &p_gc)
 
 void RaceGraphics::drawSandpits(CL_GraphicContext &p_gc)
 {
-	foreach (CL_SharedPtr<Gfx::Sandpit> &sandpit, m_sandpits) {
-		sandpit->draw(p_gc);
+	// only visible sandpits
+	m_sandpitIndex.query(m_viewport.getWorldClipRect(), &m_sandpitQuery);
+
+	foreach (int sandpitIdx, m_sandpitQuery) {
+		m_sandpits[sandpitIdx]->draw(p_gc);
+	}
+}
+
+void RaceGraphics::drawDecorations(CL_GraphicContext &p_gc)
+{
+	// only visible decorations
+	m_decorationIndex.query(m_viewport.getWorldClipRect(), &m_decorationQuery);
+
+	foreach (int decorationIdx, m_decorationQuery) {
+		m_decorations[decorationIdx]->draw(p_gc);
 	}
 }
 
 void RaceGraphics::drawSmokes(CL_GraphicContext &p_gc)
 {
 #if !defined(NO_SMOKES)
-	foreach(CL_SharedPtr<Gfx::Smoke> &smoke, m_smokes) {
-		if (!smoke->isLoaded()) {
-			smoke->load(p_gc);
-		}
-
-		smoke->draw(p_gc);
+	if (!m_smoke.isLoaded()) {
+		m_smoke.load(p_gc);
 	}
+
+	m_smoke.draw(p_gc);
 #endif // !NO_SMOKES
 }
 
 void RaceGraphics::drawUI(CL_GraphicContext &p_gc)
 {
-	Gfx::SpeedMeter &speedMeter = m_raceUI.getSpeedMeter();
-	speedMeter.setSpeed(Game::getInstance().getPlayer().getCar().getSpeedKMS());
+	// interface reads race data only from the drawn snapshot
+	if (m_levelUploaded) {
+		m_raceUI.setSnapshot(&m_snapshot);
+	} else {
+		m_raceUI.setSnapshot(NULL);
+	}
 
 	m_raceUI.draw(p_gc);
 }
@@ -207,24 +284,15 @@ void RaceGraphics::drawLevel(CL_GraphicContext &p_gc)
 {
 	m_level.draw(p_gc);
 
-//	const Race::Level &level = m_logic->getLevel();
-
 	drawBackBlocks(p_gc);
 
+	drawDecorations(p_gc);
+
 	drawSandpits(p_gc);
 
 	drawForeBlocks(p_gc);
 
-//	// draw bounds
-//	const size_t boundCount = level.getBoundCount();
-//	Gfx::Bound gfxBound;
-//
-//	for (size_t i = 0; i < boundCount; ++i) {
-//		const Race::Bound &bound = level.getBound(i);
-//		gfxBound.setSegment(bound.getSegment());
-//
-//		gfxBound.draw(p_gc);
-//	}
+	drawBounds(p_gc);
 
 #if !defined(NDEBUG) && defined(DRAW_CHECKPOINTS)
 
@@ -265,6 +333,24 @@ void RaceGraphics::drawLevel(CL_GraphicContext &p_gc)
 #endif // !NDEBUG && DRAW_CHECKPOINTS
 }
 
+void RaceGraphics::drawBounds(CL_GraphicContext &p_gc)
+{
+	const Race::BoundTree &bounds = m_logic->getLevel().getBoundTree();
+
+	// only visible bounds
+	bounds.query(m_viewport.getWorldClipRect(), &m_boundQuery);
+
+	const CL_Pen oldPen = p_gc.get_pen();
+	Gfx::Bound gfxBound;
+
+	foreach (int segIdx, m_boundQuery) {
+		gfxBound.setSegment(bounds.getSegment(segIdx));
+		gfxBound.draw(p_gc);
+	}
+
+	p_gc.set_pen(oldPen);
+}
+
 void RaceGraphics::drawBackBlocks(CL_GraphicContext &p_gc)
 {
 //	const Race::Level &level = m_logic->getLevel();
@@ -310,44 +396,22 @@ void RaceGraphics::drawForeBlocks(CL_GraphicContext &p_gc)
 
 void RaceGraphics::drawCars(CL_GraphicContext &p_gc)
 {
+	// all bodies at once
+	m_cars.draw(p_gc);
+
+#if defined(DRAW_CAR_VECTORS) && !defined(NDEBUG)
 	const Race::Level &level = m_logic->getLevel();
-	size_t carCount = level.getCarCount();
+	const int carCount = level.getCarCount();
 
-	for (size_t i = 0; i < carCount; ++i) {
+	for (int i = 0; i < carCount; ++i) {
 		const Race::Car &car = level.getCar(i);
-		drawCar(p_gc, car);
-	}
-}
-
-void RaceGraphics::drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car)
-{
-	TCarMapping::iterator itor = m_carMapping.find(&p_car);
-
-	CL_SharedPtr<Gfx::Car> gfxCar;
+		const CL_Pointf &pos = car.getPosition();
 
-	if (itor == m_carMapping.end()) {
-		gfxCar = CL_SharedPtr<Gfx::Car>(new Gfx::Car());
-		gfxCar->load(p_gc);
-
-		m_carMapping[&p_car] = gfxCar;
-	} else {
-		gfxCar = itor->second;
-	}
-
-	gfxCar->setPosition(p_car.getPosition());
-	gfxCar->setRotation(p_car.getCorpseAngle());
-
-	gfxCar->draw(p_gc);
-	
-	#if defined(DRAW_CAR_VECTORS) && !defined(NDEBUG)
-		const CL_Pointf &pos = p_car.getPosition();
 		p_gc.push_translate(pos.x, pos.y);
-		
-		CL_Draw::line(p_gc, 0, 0, p_car.m_moveVector.x/10, p_car.m_moveVector.y/10, CL_Colorf::red);
-		
+		CL_Draw::line(p_gc, 0, 0, car.m_moveVector.x/10, car.m_moveVector.y/10, CL_Colorf::red);
 		p_gc.pop_modelview();
-	#endif // DRAW_CAR_VECTORS && !NDEBUG
-	
+	}
+#endif // DRAW_CAR_VECTORS && !NDEBUG
 }
 
 void RaceGraphics::countFps()
@@ -367,12 +431,14 @@ void RaceGraphics::update(unsigned p_timeElapsed)
 {
 	G_ASSERT(m_loaded);
 
-	updateViewport(p_timeElapsed);
-	updateTyreStripes();
-	updateSmokes(p_timeElapsed);
-
 	m_raceUI.update(p_timeElapsed);
 
+	if (!m_levelUploaded) {
+		return;
+	}
+
+	captureSnapshot(p_timeElapsed);
+
 #if !defined(NDEBUG)
 	const CL_Pointf &carPos = Game::getInstance().getPlayer().getCar().getPosition();
 	Gfx::Stage::getDebugLayer()->putMessage("car x",  cl_format("%1", carPos.x));
@@ -390,13 +456,114 @@ void RaceGraphics::update(unsigned p_timeElapsed)
 #endif // !NDEBUG
 }
 
-void RaceGraphics::updateViewport(unsigned p_timeElapsed)
+void RaceGraphics::captureSnapshot(unsigned p_timeElapsed)
+{
+	m_logicTime += p_timeElapsed;
+
+	RaceSnapshot &snapshot = m_snapshot;
+
+	const Race::Level &level = m_logic->getLevel();
+	const int carCount = level.getCarCount();
+
+	// vector keeps its capacity between ticks
+	snapshot.m_cars.resize(carCount);
+
+	for (int i = 0; i < carCount; ++i) {
+		const Race::Car &car = level.getCar(i);
+		CarPose &pose = snapshot.m_cars[i];
+
+		pose.m_car = &car;
+		pose.m_position = car.getPosition();
+		pose.m_rotation = car.getCorpseAngle();
+		pose.m_drifting = car.isDrifting();
+		pose.m_choking = car.isChoking();
+		pose.m_name = m_logic->getPlayer(car).getName();
+	}
+
+	const Race::Car &playerCar = Game::getInstance().getPlayer().getCar();
+
+	snapshot.m_playerPosition = playerCar.getPosition();
+	snapshot.m_playerSpeed = playerCar.getSpeed();
+	snapshot.m_playerSpeedKMS = playerCar.getSpeedKMS();
+	snapshot.m_time = m_logicTime;
+
+	captureProgress(&snapshot);
+
+	m_snapshotFresh = true;
+}
+
+void RaceGraphics::captureProgress(RaceSnapshot *p_snapshot) const
+{
+	const Race::Progress &progress = m_logic->getProgress();
+	const int carCount = progress.getCarCount();
+
+	p_snapshot->m_ranking.resize(carCount);
+
+	for (int i = 0; i < carCount; ++i) {
+		const Race::Car &car = progress.getCarAtPosition(i + 1);
+		p_snapshot->m_ranking[i] = m_logic->getPlayer(car).getName();
+	}
+
+	p_snapshot->m_state = m_logic->getRaceState();
+	p_snapshot->m_startTime = m_logic->getRaceStartTime();
+	p_snapshot->m_lapCount = m_logic->getRaceLapCount();
+
+	const Race::Car &playerCar = Game::getInstance().getPlayer().getCar();
+	const int lap = progress.getLapNumber(playerCar);
+
+	p_snapshot->m_playerLap = lap;
+
+	// best of finished laps
+	unsigned best = 0;
+
+	for (int i = 1; i < lap; ++i) {
+		const unsigned time = progress.getLapTime(playerCar, i);
+
+		if (i == 1 || time < best) {
+			best = time;
+		}
+	}
+
+	p_snapshot->m_playerBestLapTime = best;
+
+	// display 0 time until race is started
+	if (lap != 0 && p_snapshot->m_state == Race::S_RUNNING) {
+		p_snapshot->m_playerLapTime = progress.getLapTime(playerCar, lap);
+	} else {
+		p_snapshot->m_playerLapTime = 0;
+	}
+}
+
+void RaceGraphics::applySnapshot()
+{
+	if (!m_snapshotFresh) {
+		return;
+	}
+
+	m_snapshotFresh = false;
+
+	const RaceSnapshot &snapshot = m_snapshot;
+
+	// logic time passed since previously drawn snapshot
+	const unsigned timeElapsed = snapshot.m_time - m_snapshotTime;
+	m_snapshotTime = snapshot.m_time;
+
+	m_cameraTarget = snapshot.m_playerPosition;
+
+	updateViewport(snapshot);
+	updateTyreStripes(snapshot);
+	updateSmokes(snapshot, timeElapsed);
+
+	m_cars.update(snapshot);
+}
+
+void RaceGraphics::updateViewport(const RaceSnapshot &p_snapshot)
 {
 	static const float MIN_SCALE = 0.5f;
 	static const float MAX_SCALE = 1.0f;
 	static const float MAX_SPEED = 10.0f;
 
-	float speed = Game::getInstance().getPlayer().getCar().getSpeed();
+	float speed = p_snapshot.m_playerSpeed;
 
 	if (speed > MAX_SPEED) {
 		speed = MAX_SPEED;
@@ -418,55 +585,40 @@ void RaceGraphics::updateViewport(unsigned p_timeElapsed)
 #endif
 }
 
-void RaceGraphics::updateTyreStripes()
+void RaceGraphics::updateTyreStripes(const RaceSnapshot &p_snapshot)
 {
-	m_tyreStripes.update();
+	m_tyreStripes.update(p_snapshot);
 }
 
-void RaceGraphics::updateSmokes(unsigned p_timeElapsed)
+void RaceGraphics::updateSmokes(const RaceSnapshot &p_snapshot, unsigned p_timeElapsed)
 {
-	// remove finished smokes and update the ongoing
-	TSmokeList::iterator itor = m_smokes.begin();
-
-	while (itor != m_smokes.end()) {
-		if ((*itor)->isFinished()) {
-			m_smokes.erase(itor++);
-		} else {
-			(*itor)->update(p_timeElapsed);
-			++itor;
-		}
-	}
+	// finished smokes are removed by update
+	m_smoke.update(p_timeElapsed);
 
 	static const unsigned SMOKE_PERIOD = 25;
 	static const int RAND_LIMIT = 20;
 
 	// if car is drifting then add new smokes
-	const int playerCount = m_logic->getPlayerCount();
+	foreach (const CarPose &pose, p_snapshot.m_cars) {
 
-	for (int i = 0; i < playerCount; ++i) {
-		const Race::Car &car = m_logic->getPlayer(i).getCar();
-
-		if (m_carSmokePeriod.find(&car) == m_carSmokePeriod.end()) {
-			m_carSmokePeriod[&car] = SMOKE_PERIOD;
+		if (m_carSmokePeriod.find(pose.m_car) == m_carSmokePeriod.end()) {
+			m_carSmokePeriod[pose.m_car] = SMOKE_PERIOD;
 		}
 
-		unsigned &timeFromLastSmoke = m_carSmokePeriod[&car];
+		unsigned &timeFromLastSmoke = m_carSmokePeriod[pose.m_car];
 
 		timeFromLastSmoke += p_timeElapsed;
 
 		if (
-				(car.isDrifting() || car.isChoking())
+				(pose.m_drifting || pose.m_choking)
 				&& timeFromLastSmoke >= SMOKE_PERIOD
 			) {
 
-			CL_Pointf smokePosition = car.getPosition();
+			CL_Pointf smokePosition = pose.m_position;
 			smokePosition.x += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 			smokePosition.y += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 
-			CL_SharedPtr<Gfx::Smoke> smoke(new Gfx::Smoke(smokePosition));
-			smoke->start();
-
-			m_smokes.push_back(smoke);
+			m_smoke.emit(smokePosition);
 
 			timeFromLastSmoke = 0;
 		}
@@ -28,14 +28,18 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
 
 #include <ClanLib/display.h>
 
 #include "gfx/Viewport.h"
+#include "gfx/race/level/CarBatch.h"
 #include "gfx/race/level/Level.h"
+#include "gfx/race/level/Smoke.h"
+#include "gfx/race/RaceSnapshot.h"
 #include "gfx/race/level/TyreStripes.h"
 #include "gfx/race/ui/RaceUI.h"
+#include "math/UniformGrid.h"
 
 namespace Race {
 	class Block;
@@ -45,11 +49,9 @@ namespace Race {
 
 namespace Gfx {
 
-class Car;
 class DecorationSprite;
 class GroundBlock;
 class Sandpit;
-class Smoke;
 
 class RaceGraphics {
 
@@ -65,6 +67,10 @@ class RaceGraphics {
 		void load(CL_GraphicContext &p_gc);
 
 
+		/**
+		 * Logic tick. Only copies race state to a snapshot, everything
+		 * drawn is advanced in draw() from the newest snapshot.
+		 */
 		void update(unsigned p_timeElapsed);
 
 
@@ -74,9 +80,15 @@ class RaceGraphics {
 
 		bool m_loaded;
 
+		/** Set when all level graphics are uploaded */
+		bool m_levelUploaded;
+
 		/** How player sees the scene */
 		Gfx::Viewport m_viewport;
 
+		/** Point followed by viewport, taken from snapshot */
+		CL_Pointf m_cameraTarget;
+
 		/** Logic with data for reading only */
 		const Race::RaceLogic *m_logic;
 
@@ -92,9 +104,8 @@ class RaceGraphics {
 		/** Last fps count time */
 		unsigned m_lastFpsRegisterTime;
 
-		/** Logic car to gfx car mapping */
-		typedef std::map<const Race::Car*, CL_SharedPtr<Gfx::Car> > TCarMapping;
-		TCarMapping m_carMapping;
+		/** Bodies of all cars */
+		CarBatch m_cars;
 
 		/** Car smoke periods */
 		typedef std::map<const Race::Car*, unsigned> TCarPeriodMap;
@@ -104,17 +115,37 @@ class RaceGraphics {
 		TyreStripes m_tyreStripes;
 
 		/** Car smoke clouds */
-		typedef std::list< CL_SharedPtr<Gfx::Smoke> > TSmokeList;
-		TSmokeList m_smokes;
+		Smoke m_smoke;
 
 		/** Decorations */
-		typedef std::list< CL_SharedPtr<Gfx::DecorationSprite> > TDecorationList;
+		typedef std::vector< CL_SharedPtr<Gfx::DecorationSprite> > TDecorationList;
 		TDecorationList m_decorations;
 
 		/** Sandpits */
-		typedef std::list< CL_SharedPtr<Gfx::Sandpit> > TSandpitList;
+		typedef std::vector< CL_SharedPtr<Gfx::Sandpit> > TSandpitList;
 		TSandpitList m_sandpits;
 
+		/** World bounds of decorations and sandpits */
+		Math::UniformGrid m_decorationIndex, m_sandpitIndex;
+
+		/** Visible decorations and sandpits query result */
+		std::vector<int> m_decorationQuery, m_sandpitQuery;
+
+		/** Visible bounds query result */
+		std::vector<int> m_boundQuery;
+
+		/** Race state copied by logic tick for rendering */
+		RaceSnapshot m_snapshot;
+
+		/** Set when snapshot was captured and not yet applied */
+		bool m_snapshotFresh;
+
+		/** Logic time counted by update() */
+		unsigned m_logicTime;
+
+		/** Time of the snapshot that is drawn */
+		unsigned m_snapshotTime;
+
 
 		// initialize routines
 
@@ -124,22 +155,43 @@ class RaceGraphics {
 
 		void loadTyreStripes(CL_GraphicContext &p_gc);
 
+		/**
+		 * Uploads level graphics when level logic is ready. Only one
+		 * resource is uploaded per call.
+		 *
+		 * @return true if race can be displayed.
+		 */
+		bool uploadLevel(CL_GraphicContext &p_gc);
+
 
 		// update routines
 
-		void updateViewport(unsigned p_timeElapsed);
+		/** Copies state of cars and race to the snapshot */
+		void captureSnapshot(unsigned p_timeElapsed);
+
+		/** Copies race position and lap data shown by interface */
+		void captureProgress(RaceSnapshot *p_snapshot) const;
+
+		/** Advances effects to the snapshot (if there is a new one) */
+		void applySnapshot();
+
+		void updateViewport(const RaceSnapshot &p_snapshot);
 
-		void updateSmokes(unsigned p_timeElapsed);
+		void updateSmokes(const RaceSnapshot &p_snapshot, unsigned p_timeElapsed);
 
-		void updateTyreStripes();
+		void updateTyreStripes(const RaceSnapshot &p_snapshot);
 
 
 		// drawing routines
 
 		void drawLevel(CL_GraphicContext &p_gc);
 
+		void drawLoading(CL_GraphicContext &p_gc);
+
 		void drawBackBlocks(CL_GraphicContext &p_gc);
 
+		void drawBounds(CL_GraphicContext &p_gc);
+
 		void drawForeBlocks(CL_GraphicContext &p_gc);
 
 		void drawTyreStripes(CL_GraphicContext &p_gc);
@@ -148,12 +200,12 @@ class RaceGraphics {
 
 		void drawCars(CL_GraphicContext &p_gc);
 
-		void drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car);
-
 		void drawSmokes(CL_GraphicContext &p_gc);
 
 		void drawSandpits(CL_GraphicContext &p_gc);
 
+		void drawDecorations(CL_GraphicContext &p_gc);
+
 
 		void countFps();
 
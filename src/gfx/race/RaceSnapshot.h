@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+#include "logic/race/RaceLogic.h"
+
+namespace Race {
+	class Car;
+}
+
+namespace Gfx {
+
+/** Car state needed to draw it */
+struct CarPose
+{
+	/** Car identity only, the renderer never reads through it */
+	const Race::Car *m_car;
+
+	CL_Pointf m_position;
+
+	CL_Angle m_rotation;
+
+	bool m_drifting, m_choking;
+
+	/** Name of the car owner */
+	CL_String m_name;
+
+
+	CarPose() :
+		m_car(NULL),
+		m_drifting(false),
+		m_choking(false)
+	{ /* empty */ }
+};
+
+/**
+ * Immutable copy of race state made by the logic tick. Rendering and
+ * race interface read cars and progress only from the snapshot.
+ */
+struct RaceSnapshot
+{
+	/** Cars in level order */
+	std::vector<CarPose> m_cars;
+
+	/** Player's car position */
+	CL_Pointf m_playerPosition;
+
+	/** Player's car speed in level units and in km/h */
+	float m_playerSpeed, m_playerSpeedKMS;
+
+	/** Player names ordered by race position (leader first) */
+	std::vector<CL_String> m_ranking;
+
+	/** Race state */
+	Race::RaceState m_state;
+
+	/** Race start time in ms from system boot (0 if not started) */
+	unsigned m_startTime;
+
+	/** Laps total */
+	int m_lapCount;
+
+	/** Player's current lap */
+	int m_playerLap;
+
+	/** Player's current and best lap time in ms (0 if none) */
+	unsigned m_playerLapTime, m_playerBestLapTime;
+
+	/** Logic time when snapshot was made */
+	unsigned m_time;
+
+
+	RaceSnapshot() :
+		m_playerSpeed(0.0f),
+		m_playerSpeedKMS(0.0f),
+		m_state(Race::S_STANDBY),
+		m_startTime(0),
+		m_lapCount(0),
+		m_playerLap(0),
+		m_playerLapTime(0),
+		m_playerBestLapTime(0),
+		m_time(0)
+	{ /* empty */ }
+};
+
+} // namespace
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CarBatch.h"
+
+#include <math.h>
+#include <vector>
+
+#include "common.h"
+#include "gfx/Stage.h"
+#include "gfx/race/RaceSnapshot.h"
+
+namespace Gfx {
+
+/** Vertices of one car quad (two triangles) */
+const int QUAD_VERTICES = 6;
+
+class CarBatchImpl
+{
+	public:
+
+		/** Car body sprite, only its texture and geometry are used */
+		CL_Sprite m_sprite;
+
+		CL_Texture m_texture;
+
+		/** Half size of the car quad */
+		float m_halfWidth, m_halfHeight;
+
+		/** Sprite texture coordinates */
+		CL_Vec2f m_texTopLeft, m_texBottomRight;
+
+		/** Rotation of the sprite image itself */
+		CL_Angle m_baseAngle;
+
+		/** Vertices to draw, six per car */
+		int m_vertexCount;
+
+		/** Quads of all cars (kept to not allocate every frame) */
+		std::vector<CL_Vec2f> m_positions, m_texCoords;
+
+		CL_SharedPtr<CL_PrimitivesArray> m_array;
+
+
+		CarBatchImpl() :
+			m_halfWidth(0.0f),
+			m_halfHeight(0.0f),
+			m_vertexCount(0)
+		{ /* empty */ }
+
+
+		/** Writes car quad to given slot */
+		void fillSlot(int p_slot, const CarPose &p_pose);
+};
+
+CarBatch::CarBatch() :
+	m_impl(new CarBatchImpl())
+{
+	// empty
+}
+
+CarBatch::~CarBatch()
+{
+	// empty
+}
+
+void CarBatch::load(CL_GraphicContext &p_gc)
+{
+	m_impl->m_sprite = CL_Sprite(p_gc, "race/car", Stage::getResourceManager());
+
+	// car sprite has one frame
+	const CL_Subtexture frame = m_impl->m_sprite.get_frame_texture(0);
+	const CL_Rect geometry = frame.get_geometry();
+
+	m_impl->m_texture = frame.get_texture();
+
+	const float texWidth = static_cast<float>(m_impl->m_texture.get_width());
+	const float texHeight = static_cast<float>(m_impl->m_texture.get_height());
+
+	m_impl->m_texTopLeft = CL_Vec2f(geometry.left / texWidth, geometry.top / texHeight);
+	m_impl->m_texBottomRight = CL_Vec2f(geometry.right / texWidth, geometry.bottom / texHeight);
+
+	// sprite resource scales and rotates the image
+	float scaleX, scaleY;
+	m_impl->m_sprite.get_scale(scaleX, scaleY);
+
+	m_impl->m_halfWidth = geometry.get_width() * scaleX / 2.0f;
+	m_impl->m_halfHeight = geometry.get_height() * scaleY / 2.0f;
+
+	m_impl->m_baseAngle = m_impl->m_sprite.get_base_angle();
+
+	m_impl->m_array = CL_SharedPtr<CL_PrimitivesArray>(new CL_PrimitivesArray(p_gc));
+	m_impl->m_array->set_attribute(1, CL_Colorf::white);
+
+	Drawable::load(p_gc);
+}
+
+void CarBatchImpl::fillSlot(int p_slot, const CarPose &p_pose)
+{
+	const CL_Pointf &pos = p_pose.m_position;
+	const float rad = (p_pose.m_rotation + m_baseAngle).to_radians();
+
+	const float c = cos(rad);
+	const float s = sin(rad);
+
+	// corners rotated around the car centre
+	const CL_Vec2f dx(m_halfWidth * c, m_halfWidth * s);
+	const CL_Vec2f dy(-m_halfHeight * s, m_halfHeight * c);
+
+	const CL_Vec2f center(pos.x, pos.y);
+
+	const CL_Vec2f topLeft = center - dx - dy;
+	const CL_Vec2f topRight = center + dx - dy;
+	const CL_Vec2f bottomLeft = center - dx + dy;
+	const CL_Vec2f bottomRight = center + dx + dy;
+
+	CL_Vec2f *v = &m_positions[p_slot * QUAD_VERTICES];
+
+	v[0] = topLeft;
+	v[1] = topRight;
+	v[2] = bottomLeft;
+	v[3] = topRight;
+	v[4] = bottomRight;
+	v[5] = bottomLeft;
+}
+
+void CarBatch::update(const RaceSnapshot &p_snapshot)
+{
+	const int carCount = static_cast<signed>(p_snapshot.m_cars.size());
+	const int vertexCount = carCount * QUAD_VERTICES;
+
+	// texture coordinates are the same for every slot
+	if (static_cast<signed>(m_impl->m_texCoords.size()) < vertexCount) {
+		const CL_Vec2f &t1 = m_impl->m_texTopLeft;
+		const CL_Vec2f &t2 = m_impl->m_texBottomRight;
+
+		m_impl->m_texCoords.clear();
+
+		for (int i = 0; i < carCount; ++i) {
+			m_impl->m_texCoords.push_back(t1);
+			m_impl->m_texCoords.push_back(CL_Vec2f(t2.x, t1.y));
+			m_impl->m_texCoords.push_back(CL_Vec2f(t1.x, t2.y));
+			m_impl->m_texCoords.push_back(CL_Vec2f(t2.x, t1.y));
+			m_impl->m_texCoords.push_back(t2);
+			m_impl->m_texCoords.push_back(CL_Vec2f(t1.x, t2.y));
+		}
+	}
+
+	m_impl->m_positions.resize(vertexCount);
+
+	for (int i = 0; i < carCount; ++i) {
+		m_impl->fillSlot(i, p_snapshot.m_cars[i]);
+	}
+
+	m_impl->m_vertexCount = vertexCount;
+}
+
+void CarBatch::draw(CL_GraphicContext &p_gc)
+{
+	G_ASSERT(isLoaded());
+
+	if (m_impl->m_vertexCount == 0) {
+		return;
+	}
+
+	// vectors could be reallocated since last frame
+	m_impl->m_array->set_attributes(0, &m_impl->m_positions[0]);
+	m_impl->m_array->set_attributes(2, &m_impl->m_texCoords[0]);
+
+	p_gc.set_texture(0, m_impl->m_texture);
+	p_gc.set_program_object(cl_program_single_texture);
+
+	p_gc.draw_primitives(cl_triangles, m_impl->m_vertexCount, *m_impl->m_array);
+
+	p_gc.reset_program_object();
+	p_gc.reset_texture(0);
+}
+
+} // namespace
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2009, Piotr Korzuszek
+ * Copyright (c) 2009-2010, Piotr Korzuszek
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -34,32 +34,34 @@
 
 namespace Gfx {
 
-class Car : public Gfx::Drawable {
+class CarBatchImpl;
+struct RaceSnapshot;
+
+/**
+ * Draws bodies of all cars on the level.
+ * <p>
+ * Car at snapshot index <i>i</i> takes quad slot <i>i</i> in one vertex
+ * array, so every car is drawn with a single textured draw call.
+ */
+class CarBatch : public Drawable {
 
 	public:
 
-		Car();
+		CarBatch();
+
+		virtual ~CarBatch();
 
-		virtual ~Car();
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
 		virtual void load(CL_GraphicContext &p_gc);
 
-
-		void setPosition(const CL_Pointf &p_position) { m_position = p_position; }
-
-		void setRotation(const CL_Angle &p_rotation) { m_rotation = p_rotation; }
+		/** Rebuilds car quads from poses of given snapshot */
+		void update(const RaceSnapshot &p_snapshot);
 
 	private:
 
-		CL_Sprite m_sprite;
-
-		CL_Pointf m_position;
-
-		CL_Angle m_rotation;
-
+		CL_SharedPtr<CarBatchImpl> m_impl;
 };
 
 } // namespace
-
@@ -41,6 +41,15 @@ DecorationSprite::~DecorationSprite()
 {
 }
 
+CL_Rectf DecorationSprite::getBounds() const
+{
+	return CL_Rectf(
+			m_position.x, m_position.y,
+			m_position.x + m_sprite.get_width(),
+			m_position.y + m_sprite.get_height()
+	);
+}
+
 void DecorationSprite::draw(CL_GraphicContext &p_gc)
 {
 	m_sprite.draw(p_gc, m_position.x, m_position.y);
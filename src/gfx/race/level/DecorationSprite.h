@@ -50,6 +50,9 @@ class DecorationSprite: public Drawable {
 
 		void setPosition(const CL_Pointf &p_position) { m_position = p_position; }
 
+		/** @return Area covered by the sprite (available after load) */
+		CL_Rectf getBounds() const;
+
 	private:
 
 		CL_String m_spriteName;
@@ -28,49 +28,185 @@
 
 #include "Level.h"
 
+#include <algorithm>
+#include <map>
 #include <vector>
 
+#include "common/Units.h"
 #include "gfx/Viewport.h"
+#include "logic/race/level/ChunkGrid.h"
 #include "logic/race/level/Object.h"
 #include "logic/race/level/Level.h"
 #include "logic/race/level/Track.h"
 #include "logic/race/level/TrackTriangulator.h"
 #include "logic/race/level/TrackSegment.h"
-#include "math/Integer.h"
+#include "math/UniformGrid.h"
 
 namespace Gfx
 {
 
+/** Welded triangle mesh of one chunk in one level of detail */
+struct ChunkLod
+{
+	/** Unique vertices of the mesh, in video memory */
+	CL_VertexArrayBuffer m_vertices;
+
+	CL_SharedPtr<CL_PrimitivesArray> m_array;
+
+	/** Three vertex indices per triangle */
+	std::vector<unsigned> m_indices;
+
+	int m_vertexCount;
+
+	bool m_built;
+
+
+	ChunkLod() :
+		m_vertexCount(0),
+		m_built(false)
+	{ /* empty */ }
+};
+
+/** Render data of one level chunk */
+struct ChunkMesh
+{
+	/** Meshes are built when needed and kept until chunk is evicted */
+	ChunkLod m_lods[Race::TrackSegment::LOD_COUNT];
+
+	/** Memory used by built meshes (in bytes) */
+	int m_size;
+
+	/** Frame when chunk was needed for the last time */
+	unsigned m_lastUsed;
+
+	bool m_resident;
+
+
+	ChunkMesh() :
+		m_size(0),
+		m_lastUsed(0),
+		m_resident(false)
+	{ /* empty */ }
+};
+
+/** Orders points so equal positions can be welded */
+struct PointLess
+{
+	bool operator()(const CL_Pointf &p_a, const CL_Pointf &p_b) const
+	{
+		return p_a.x < p_b.x || (p_a.x == p_b.x && p_a.y < p_b.y);
+	}
+};
+
 class LevelImpl
 {
 	public:
 
+		/** Memory budget of resident chunk meshes (in bytes) */
+		static const int MAX_RESIDENT_SIZE = 8 * 1024 * 1024;
+
+		/** Chunks that are not visible yet, but will be soon, are prepared */
+		static const int MAX_PRELOADS_PER_FRAME = 1;
+
+
 		const Race::Level m_levelLogic;
 
 		const Viewport &m_viewport;
 
 		const Race::TrackTriangulator &m_triangulator;
 
+		/** Outlines of all object prototypes (line strips) */
+		std::vector<CL_Vec2f> m_objectVertices;
+
+		/** Begin and count of each prototype outline */
+		std::vector<std::pair<int, int> > m_objectMeshes;
+
+		/** Prototype outline index of each object */
+		std::vector<int> m_objectMeshIndices;
+
+		/** World bounds of objects */
+		Math::UniformGrid m_objectIndex;
+
+		/** Visible objects (kept to not allocate every frame) */
+		std::vector<int> m_visibleObjects;
+
+		/** Outlines of visible objects batched into line list */
+		std::vector<CL_Vec2f> m_objectLines;
+
+		CL_SharedPtr<CL_PrimitivesArray> m_objectArray;
+
+		/** Render data of each level chunk */
+		std::vector<ChunkMesh> m_chunkMeshes;
+
+		/** Chunks that have render data */
+		std::vector<int> m_residentChunks;
+
+		/** Memory used by all resident chunks (in bytes) */
+		int m_residentSize;
+
+		/** Visible and soon visible chunks (kept to not allocate every frame) */
+		std::vector<int> m_visibleChunks, m_preloadChunks;
+
+		/** Frame counter for chunk eviction */
+		unsigned m_frame;
+
+		/** Chunk grid revision that render data was made for */
+		unsigned m_chunkRevision;
+
+		/** Triangulation revision that render data was made for */
+		unsigned m_trackRevision;
+
+		/** Vertex welding map (kept to not allocate for every chunk) */
+		std::map<CL_Pointf, unsigned, PointLess> m_weldMap;
+
+		/** Welded vertices of the chunk being built */
+		std::vector<CL_Vec2f> m_weldVertices;
+
 		LevelImpl(const Race::Level &p_levelLogic, const Viewport &p_viewport) :
 				m_levelLogic(p_levelLogic),
 				m_viewport(p_viewport),
-				m_triangulator(p_levelLogic.getTrackTriangulator())
+				m_triangulator(p_levelLogic.getTrackTriangulator()),
+				m_residentSize(0),
+				m_frame(0),
+				m_chunkRevision(0),
+				m_trackRevision(0)
 		{
 			// empty
 		}
 
 
+		/** Drops render data of all chunks */
+		void resetChunks();
+
+		/** Makes visible chunks resident and evicts the unused ones */
+		void updateChunks(CL_GraphicContext &p_gc);
+
+		/**
+		 * Builds welded mesh of chunk segments and gaps between them
+		 * for given level of detail and uploads it to video memory.
+		 */
+		void uploadChunk(CL_GraphicContext &p_gc, int p_chunk, int p_lod);
+
+		/** @return Index of welded vertex at given position */
+		unsigned weld(const CL_Pointf &p_point);
+
+		void evictChunks();
+
 		void drawTriangles(CL_GraphicContext &p_gc);
 
-		void drawTriangle(
-				CL_GraphicContext &p_gc,
-				const CL_Pointf& p_a, const CL_Pointf& p_b, const CL_Pointf& p_c
-		);
+		/** @return The least detailed mesh that looks good in current scale */
+		int selectLod() const;
 
 		void drawStartLine(CL_GraphicContext &p_gc);
 
 		void drawObjects(CL_GraphicContext &p_gc);
 
+		/**
+		 * Builds one outline for every object prototype and spatial
+		 * index of object bounds.
+		 */
+		void buildObjectMeshes(CL_GraphicContext &p_gc);
+
 };
 
 Level::Level(const Race::Level &p_levelLogic, const Viewport &p_viewport) :
@@ -86,66 +222,277 @@ Level::~Level()
 
 void Level::draw(CL_GraphicContext &p_gc)
 {
+	m_impl->updateChunks(p_gc);
 	m_impl->drawTriangles(p_gc);
 	m_impl->drawStartLine(p_gc);
 	m_impl->drawObjects(p_gc);
 }
 
-void LevelImpl::drawTriangles(CL_GraphicContext &p_gc)
+void LevelImpl::updateChunks(CL_GraphicContext &p_gc)
 {
-	const Race::Track &track = m_levelLogic.getTrack();
-	const int trackPointCount = track.getPointCount();
+	// how far ahead of the viewport chunks are prepared
+	static const float PRELOAD_MARGIN = Units::toScreen(25.0f);
+
+	const Race::ChunkGrid &chunks = m_levelLogic.getChunks();
+	const CL_Rectf &clip = m_viewport.getWorldClipRect();
+	const int lod = selectLod();
+
+	// level was partitioned or triangulated again
+	if (
+			chunks.getRevision() != m_chunkRevision
+			|| m_triangulator.getRevision() != m_trackRevision
+	) {
+		resetChunks();
+	}
+
+	++m_frame;
+
+	// visible chunks are needed right now
+	chunks.query(clip, &m_visibleChunks);
+
+	foreach (int chunkIdx, m_visibleChunks) {
+		ChunkMesh &mesh = m_chunkMeshes[chunkIdx];
+
+		if (!mesh.m_lods[lod].m_built) {
+			uploadChunk(p_gc, chunkIdx, lod);
+		}
+
+		mesh.m_lastUsed = m_frame;
+	}
+
+	// chunks around the viewport are prepared few at a time
+	const CL_Rectf preload(
+			clip.left - PRELOAD_MARGIN, clip.top - PRELOAD_MARGIN,
+			clip.right + PRELOAD_MARGIN, clip.bottom + PRELOAD_MARGIN
+	);
+
+	chunks.query(preload, &m_preloadChunks);
+
+	int preloads = 0;
+
+	foreach (int chunkIdx, m_preloadChunks) {
+		ChunkMesh &mesh = m_chunkMeshes[chunkIdx];
+
+		if (!mesh.m_lods[lod].m_built && preloads < MAX_PRELOADS_PER_FRAME) {
+			uploadChunk(p_gc, chunkIdx, lod);
+			++preloads;
+		}
+
+		if (mesh.m_resident) {
+			mesh.m_lastUsed = m_frame;
+		}
+	}
+
+	evictChunks();
+}
+
+void LevelImpl::resetChunks()
+{
+	const Race::ChunkGrid &chunks = m_levelLogic.getChunks();
+
+	m_chunkMeshes.assign(chunks.getChunkCount(), ChunkMesh());
+	m_residentChunks.clear();
+	m_residentSize = 0;
+
+	m_chunkRevision = chunks.getRevision();
+	m_trackRevision = m_triangulator.getRevision();
+}
+
+unsigned LevelImpl::weld(const CL_Pointf &p_point)
+{
+	const unsigned next = static_cast<unsigned>(m_weldVertices.size());
+
+	std::pair<std::map<CL_Pointf, unsigned, PointLess>::iterator, bool> res =
+			m_weldMap.insert(std::make_pair(p_point, next));
+
+	if (res.second) {
+		m_weldVertices.push_back(CL_Vec2f(p_point.x, p_point.y));
+	}
+
+	return res.first->second;
+}
 
-	const CL_Rectf &viewportBounds = m_viewport.getWorldClipRect();
+void LevelImpl::uploadChunk(CL_GraphicContext &p_gc, int p_chunk, int p_lod)
+{
+	const Race::ChunkGrid &chunks = m_levelLogic.getChunks();
+	const int trackPointCount = m_levelLogic.getTrack().getPointCount();
+
+	ChunkMesh &mesh = m_chunkMeshes[p_chunk];
+	ChunkLod &lodMesh = mesh.m_lods[p_lod];
+
+	G_ASSERT(!lodMesh.m_built);
+
+	if (!mesh.m_resident) {
+		m_residentChunks.push_back(p_chunk);
+		mesh.m_resident = true;
+	}
+
+	m_weldMap.clear();
+	m_weldVertices.clear();
 
-	for (int i = 0; i < trackPointCount; ++i) {
-		const Race::TrackSegment &seg = m_triangulator.getSegment(i);
+	std::vector<unsigned> &indices = lodMesh.m_indices;
+	indices.clear();
 
-		// run only if this segment is visible
-		if (viewportBounds.is_overlapped(seg.getBounds())) {
-			const std::vector<CL_Pointf> &points = seg.getTrianglePoints();
+	const int *segments = chunks.getSegments(p_chunk);
+	const int segCount = chunks.getSegmentCount(p_chunk);
 
-			const int triPointCount = static_cast<signed>(points.size());
-			G_ASSERT(triPointCount % 3 == 0);
+	for (int i = 0; i < segCount; ++i) {
+		const int segIdx = segments[i];
+		const Race::TrackSegment &seg = m_triangulator.getSegment(segIdx);
 
-			for (int j = 0; j < triPointCount;) {
-				const CL_Pointf &p1 = points[j++];
-				const CL_Pointf &p2 = points[j++];
-				const CL_Pointf &p3 = points[j++];
+		const CL_Pointf *points = seg.getTrianglePoints(p_lod);
+		const int triPointCount = seg.getTrianglePointCount(p_lod);
 
-				drawTriangle(p_gc, p1, p2, p3);
+		G_ASSERT(triPointCount % 3 == 0);
+
+		for (int j = 0; j < triPointCount; ++j) {
+			indices.push_back(weld(points[j]));
+		}
+
+		// fill the gap to the next segment
+		const int nextIdx = segIdx + 1 < trackPointCount ? segIdx + 1 : 0;
+		const Race::TrackSegment &nextSeg = m_triangulator.getSegment(nextIdx);
+
+		if (triPointCount < 2 || nextSeg.getTrianglePointCount(p_lod) < 2) {
+			continue;
+		}
+
+		const unsigned prevLeft = weld(points[triPointCount - 1]);
+		const unsigned prevRight = weld(points[triPointCount - 2]);
+
+		const unsigned nextLeft = weld(nextSeg.getTrianglePoints(p_lod)[0]);
+		const unsigned nextRight = weld(nextSeg.getTrianglePoints(p_lod)[1]);
+
+		indices.push_back(prevLeft);
+		indices.push_back(prevRight);
+		indices.push_back(nextRight);
+
+		indices.push_back(prevLeft);
+		indices.push_back(nextRight);
+		indices.push_back(nextLeft);
+	}
+
+	lodMesh.m_vertexCount = static_cast<signed>(m_weldVertices.size());
+	lodMesh.m_built = true;
+
+	if (!indices.empty()) {
+		// static data, uploaded once and drawn many times
+		lodMesh.m_vertices = CL_VertexArrayBuffer(
+				p_gc, &m_weldVertices[0],
+				lodMesh.m_vertexCount * sizeof(CL_Vec2f),
+				cl_usage_static_draw
+		);
+
+		lodMesh.m_array = CL_SharedPtr<CL_PrimitivesArray>(new CL_PrimitivesArray(p_gc));
+		lodMesh.m_array->set_attributes(0, lodMesh.m_vertices, 2, cl_type_float, 0);
+		lodMesh.m_array->set_attribute(1, CL_Colorf::gray);
+	}
+
+	const int size =
+			lodMesh.m_vertexCount * static_cast<signed>(sizeof(CL_Vec2f))
+			+ static_cast<signed>(indices.size() * sizeof(unsigned));
+
+	mesh.m_size += size;
+	m_residentSize += size;
+}
+
+void LevelImpl::evictChunks()
+{
+	while (m_residentSize > MAX_RESIDENT_SIZE) {
+
+		// least recently used chunk that is not needed in this frame
+		int oldest = -1;
+
+		const int residentCount = static_cast<signed>(m_residentChunks.size());
+
+		for (int i = 0; i < residentCount; ++i) {
+			const ChunkMesh &mesh = m_chunkMeshes[m_residentChunks[i]];
+
+			if (
+					mesh.m_lastUsed != m_frame
+					&& (oldest == -1 || mesh.m_lastUsed < m_chunkMeshes[m_residentChunks[oldest]].m_lastUsed)
+			) {
+				oldest = i;
 			}
+		}
 
+		if (oldest == -1) {
+			// everything is visible, budget is too small
+			break;
 		}
 
-		// fill the gaps between two segments
-		// FIXME: check when to not draw this
-		const CL_Pointf &prevLeft = m_triangulator.getLastLeftPoint(i);
-		const CL_Pointf &prevRight = m_triangulator.getLastRightPoint(i);
+		ChunkMesh &mesh = m_chunkMeshes[m_residentChunks[oldest]];
 
-		const int nextIdx = i + 1 < trackPointCount ? i + 1 : 0;
-		const CL_Pointf &nextLeft = m_triangulator.getFirstLeftPoint(nextIdx);
-		const CL_Pointf &nextRight = m_triangulator.getFirstRightPoint(nextIdx);
+		m_residentSize -= mesh.m_size;
 
-		drawTriangle(p_gc, prevLeft, prevRight, nextRight);
-		drawTriangle(p_gc, prevLeft, nextRight, nextLeft);
+		// releases video memory of all levels of detail
+		mesh = ChunkMesh();
+
+		m_residentChunks[oldest] = m_residentChunks.back();
+		m_residentChunks.pop_back();
 	}
 }
 
-void LevelImpl::drawTriangle(
-		CL_GraphicContext &p_gc,
-		const CL_Pointf& p_a, const CL_Pointf& p_b, const CL_Pointf& p_c
-)
+void LevelImpl::drawTriangles(CL_GraphicContext &p_gc)
 {
-	CL_Draw::triangle(p_gc, p_a, p_b, p_c, CL_Colorf::gray);
+	const int lod = selectLod();
+
+	p_gc.set_program_object(cl_program_color_only);
+
+	foreach (int chunkIdx, m_visibleChunks) {
+		ChunkLod &lodMesh = m_chunkMeshes[chunkIdx].m_lods[lod];
+		const int count = static_cast<signed>(lodMesh.m_indices.size());
+
+		if (count > 0) {
+			p_gc.set_primitives_array(*lodMesh.m_array);
+			p_gc.draw_primitives_elements(cl_triangles, count, &lodMesh.m_indices[0]);
+			p_gc.reset_primitives_array();
+		}
+	}
+
+	p_gc.reset_program_object();
 
 #if !defined(NDEBUG) && defined(DRAW_WIREFRAME)
-	CL_Draw::line(p_gc, p_a, p_b, CL_Colorf::purple);
-	CL_Draw::line(p_gc, p_b, p_c, CL_Colorf::purple);
-	CL_Draw::line(p_gc, p_a, p_c, CL_Colorf::purple);
+	const Race::ChunkGrid &chunks = m_levelLogic.getChunks();
+
+	foreach (int chunkIdx, m_visibleChunks) {
+		const int *segments = chunks.getSegments(chunkIdx);
+		const int segCount = chunks.getSegmentCount(chunkIdx);
+
+		for (int i = 0; i < segCount; ++i) {
+			const Race::TrackSegment &seg = m_triangulator.getSegment(segments[i]);
+
+			const CL_Pointf *points = seg.getTrianglePoints(lod);
+			const int count = seg.getTrianglePointCount(lod);
+
+			for (int j = 0; j < count; j += 3) {
+				CL_Draw::line(p_gc, points[j], points[j + 1], CL_Colorf::purple);
+				CL_Draw::line(p_gc, points[j + 1], points[j + 2], CL_Colorf::purple);
+				CL_Draw::line(p_gc, points[j], points[j + 2], CL_Colorf::purple);
+			}
+		}
+	}
 #endif
 }
 
+int LevelImpl::selectLod() const
+{
+	// maximal visible curve error in pixels
+	static const float MAX_SCREEN_ERROR = 1.0f;
+
+	const float scale = m_viewport.getScale();
+	int lod = 0;
+
+	while (
+			lod + 1 < Race::TrackSegment::LOD_COUNT
+			&& Race::TrackTriangulator::getLodTolerance(lod + 1) * scale <= MAX_SCREEN_ERROR
+	) {
+		++lod;
+	}
+
+	return lod;
+}
+
 void LevelImpl::drawStartLine(CL_GraphicContext &p_gc)
 {
 	const Race::Track &track = m_levelLogic.getTrack();
@@ -156,10 +503,13 @@ void LevelImpl::drawStartLine(CL_GraphicContext &p_gc)
 	const CL_Pointf &a = m_triangulator.getFirstLeftPoint(0);
 	const CL_Pointf &b = m_triangulator.getFirstRightPoint(0);
 
-	// draw only if visible on screen
+	// draw only if visible on screen (ends can be both off screen)
 	const CL_Rectf &clip = m_viewport.getWorldClipRect();
 
-	if (clip.contains(a) || clip.contains(b)) {
+	if (
+			std::max(a.x, b.x) >= clip.left && std::min(a.x, b.x) <= clip.right
+			&& std::max(a.y, b.y) >= clip.top && std::min(a.y, b.y) <= clip.bottom
+	) {
 		CL_Pen oldPen = p_gc.get_pen();
 
 		CL_Pen pen;
@@ -174,34 +524,95 @@ void LevelImpl::drawStartLine(CL_GraphicContext &p_gc)
 
 void LevelImpl::drawObjects(CL_GraphicContext &p_gc)
 {
+	m_objectIndex.query(m_viewport.getWorldClipRect(), &m_visibleObjects);
+
+	// outlines of all visible instances go to one draw call
+	m_objectLines.clear();
+
+	foreach (int objIdx, m_visibleObjects) {
+		const CL_Vec2f &pos = m_levelLogic.getObject(objIdx).getPosition();
+		const std::pair<int, int> &mesh = m_objectMeshes[m_objectMeshIndices[objIdx]];
+
+		const CL_Vec2f *outline = &m_objectVertices[mesh.first];
+
+		// outline is closed, the last point connects to the first one
+		for (int i = 0; i < mesh.second; ++i) {
+			const int prev = (i == 0 ? mesh.second : i) - 1;
+
+			m_objectLines.push_back(outline[prev] + pos);
+			m_objectLines.push_back(outline[i] + pos);
+		}
+	}
+
+	if (m_objectLines.empty()) {
+		return;
+	}
+
 	CL_Pen oldPen = p_gc.get_pen();
 
 	CL_Pen pen;
 	pen.set_line_width(3);
 	p_gc.set_pen(pen);
+
+	// vector could be reallocated since last frame
+	m_objectArray->set_attributes(0, &m_objectLines[0]);
+
+	p_gc.set_program_object(cl_program_color_only);
+	p_gc.draw_primitives(cl_lines, static_cast<signed>(m_objectLines.size()), *m_objectArray);
+	p_gc.reset_program_object();
+
+	p_gc.set_pen(oldPen);
+}
+
+void LevelImpl::buildObjectMeshes(CL_GraphicContext &p_gc)
+{
 	const int objCount = m_levelLogic.getObjectCount();
 
+	m_objectVertices.clear();
+	m_objectMeshes.clear();
+	m_objectMeshIndices.resize(objCount);
+
+	// instances of one prototype are next to each other
 	for (int i = 0; i < objCount; ++i) {
-		const Race::Object &obj = m_levelLogic.getObject(i);
-		const int ptCount = obj.getPointCount();
+		const Race::ObjectPrototype &proto = m_levelLogic.getObject(i).getPrototype();
 
-		if (ptCount > 1) {
-			for (int j = 0; j < ptCount; ++j) {
-				const CL_Pointf &prev = obj.getPoint(
-						Math::Integer::clamp(j - 1, 0, ptCount - 1)
-				);
-				const CL_Pointf &curr = obj.getPoint(j);
+		if (
+				i == 0
+				|| !(m_levelLogic.getObject(i - 1).getPrototype() == proto)
+		) {
+			const int begin = static_cast<signed>(m_objectVertices.size());
+			const int ptCount = proto.getPointCount();
 
-				CL_Draw::line(p_gc, prev, curr, CL_Colorf::white);
+			for (int j = 0; j < ptCount; ++j) {
+				m_objectVertices.push_back(proto.getPoint(j));
 			}
+
+			m_objectMeshes.push_back(std::make_pair(begin, ptCount));
 		}
+
+		m_objectMeshIndices[i] = static_cast<signed>(m_objectMeshes.size()) - 1;
 	}
 
-	p_gc.set_pen(oldPen);
+	// objects are small, cells of few meters are enough
+	static const float OBJECT_CELL_SIZE = Units::toScreen(20.0f);
+
+	std::vector<CL_Rectf> bounds(objCount);
+
+	for (int i = 0; i < objCount; ++i) {
+		bounds[i] = m_levelLogic.getObject(i).getBounds();
+	}
+
+	m_objectIndex.build(bounds, OBJECT_CELL_SIZE);
+
+	m_objectArray = CL_SharedPtr<CL_PrimitivesArray>(new CL_PrimitivesArray(p_gc));
+	m_objectArray->set_attribute(1, CL_Colorf::white);
 }
 
 void Level::load(CL_GraphicContext &p_gc)
 {
+	// chunks are uploaded when they are needed
+	m_impl->resetChunks();
+	m_impl->buildObjectMeshes(p_gc);
 	Drawable::load(p_gc);
 }
 
@@ -52,6 +52,17 @@ void Sandpit::setPosition(const CL_Pointf &p_position)
 	m_position = p_position;
 }
 
+CL_Rectf Sandpit::getBounds() const
+{
+	assert(m_built);
+
+	return CL_Rectf(
+			m_position.x, m_position.y,
+			m_position.x + m_pixelData->get_width(),
+			m_position.y + m_pixelData->get_height()
+	);
+}
+
 void Sandpit::draw(CL_GraphicContext &p_gc)
 {
 	assert(m_built);
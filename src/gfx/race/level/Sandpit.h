@@ -54,6 +54,9 @@ class Sandpit : public Gfx::Drawable {
 
 		void setPosition(const CL_Pointf &p_position);
 
+		/** @return Area covered by sandpit texture (available after load) */
+		CL_Rectf getBounds() const;
+
 
 	private:
 
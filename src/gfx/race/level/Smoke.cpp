@@ -37,14 +37,20 @@
 
 namespace Gfx {
 
-const int SMOKE_SPRITES_COUNT = 3;
-
-CL_Sprite Smoke::m_smokeSprites[SMOKE_SPRITES_COUNT];
-
-Smoke::Smoke(const CL_Pointf &p_position) :
-		m_position(p_position)
+/** How long one smoke cloud lives */
+const unsigned SMOKE_LIFETIME = 6000;
+
+Smoke::Smoke() :
+		m_count(0),
+		m_x(MAX_PARTICLES),
+		m_y(MAX_PARTICLES),
+		m_age(MAX_PARTICLES),
+		m_sprite(MAX_PARTICLES)
 {
-	m_spriteIdx = rand() % SMOKE_SPRITES_COUNT;
+	// six vertices per quad
+	m_positions.reserve(MAX_PARTICLES * 6);
+	m_texCoords.reserve(MAX_PARTICLES * 6);
+	m_colors.reserve(MAX_PARTICLES * 6);
 }
 
 Smoke::~Smoke()
@@ -52,57 +58,167 @@ Smoke::~Smoke()
 	// empty
 }
 
-void Smoke::start()
+void Smoke::emit(const CL_Pointf &p_position)
 {
-	Animation::start();
+	if (m_count == MAX_PARTICLES) {
+		return;
+	}
 
-	m_alpha.animate(0.1f, 0.3f, 250, Math::Easing::NONE, 0);
-	m_alpha.animate(0.3f, 0.0f, 5500, Math::Easing::NONE, 500);
+	m_x[m_count] = p_position.x;
+	m_y[m_count] = p_position.y;
+	m_age[m_count] = 0;
+	m_sprite[m_count] = static_cast<unsigned char>(rand() % SPRITE_COUNT);
 
-	m_size.animate(0.1f, 0.5f, 6000, Math::Easing::REGULAR_OUT);
+	++m_count;
+}
+
+void Smoke::kill(int p_idx)
+{
+	--m_count;
+
+	m_x[p_idx] = m_x[m_count];
+	m_y[p_idx] = m_y[m_count];
+	m_age[p_idx] = m_age[m_count];
+	m_sprite[p_idx] = m_sprite[m_count];
 }
 
 void Smoke::update(unsigned p_timeElapsed)
 {
-	Animation::update(p_timeElapsed);
+	int i = 0;
+
+	while (i < m_count) {
+		m_age[i] += p_timeElapsed;
+
+		if (m_age[i] >= SMOKE_LIFETIME) {
+			// the last particle moves here, check it in next step
+			kill(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+void Smoke::clear()
+{
+	m_count = 0;
+}
+
+/** Fades in quickly, holds and fades out until the end of life */
+static float smokeAlpha(unsigned p_age)
+{
+	static const unsigned FADE_IN_END = 250;
+	static const unsigned FADE_OUT_START = 500;
+
+	if (p_age < FADE_IN_END) {
+		return Math::Easing::NONE.ease(0.1f, 0.3f, p_age / static_cast<float>(FADE_IN_END));
+	}
+
+	if (p_age < FADE_OUT_START) {
+		return 0.3f;
+	}
 
-	m_alpha.update(p_timeElapsed);
-	m_size.update(p_timeElapsed);
+	return Math::Easing::NONE.ease(
+			0.3f, 0.0f,
+			(p_age - FADE_OUT_START) / static_cast<float>(SMOKE_LIFETIME - FADE_OUT_START)
+	);
+}
+
+/** Grows quickly at first, then slower */
+static float smokeSize(unsigned p_age)
+{
+	return Math::Easing::REGULAR_OUT.ease(0.1f, 0.5f, p_age / static_cast<float>(SMOKE_LIFETIME));
 }
 
 void Smoke::draw(CL_GraphicContext &p_gc)
 {
-	G_ASSERT(!m_smokeSprites[0].is_null());
+	G_ASSERT(!m_sprites[0].is_null());
+
+	if (m_count == 0) {
+		return;
+	}
+
+	if (m_array.is_null()) {
+		m_array = CL_SharedPtr<CL_PrimitivesArray>(new CL_PrimitivesArray(p_gc));
+	}
+
+	p_gc.set_program_object(cl_program_single_texture);
+
+	for (int s = 0; s < SPRITE_COUNT; ++s) {
+
+		// smoke sprites have one frame
+		const CL_Subtexture frame = m_sprites[s].get_frame_texture(0);
+		const CL_Texture texture = frame.get_texture();
+		const CL_Rect geometry = frame.get_geometry();
+
+		const float texWidth = static_cast<float>(texture.get_width());
+		const float texHeight = static_cast<float>(texture.get_height());
 
-	static const unsigned ANIMATION_END = 6000;
+		const CL_Vec2f t1(geometry.left / texWidth, geometry.top / texHeight);
+		const CL_Vec2f t2(geometry.right / texWidth, geometry.bottom / texHeight);
 
-	const unsigned now = getTimeFromStart();
+		m_positions.clear();
+		m_texCoords.clear();
+		m_colors.clear();
 
-	if (now < ANIMATION_END) {
+		for (int i = 0; i < m_count; ++i) {
+			if (m_sprite[i] != s) {
+				continue;
+			}
 
-		m_smokeSprites[m_spriteIdx].set_alpha(m_alpha.get());
-		m_smokeSprites[m_spriteIdx].set_scale(m_size.get(), m_size.get());
+			const float size = smokeSize(m_age[i]);
+			const float halfW = geometry.get_width() * size / 2.0f;
+			const float halfH = geometry.get_height() * size / 2.0f;
 
-		m_smokeSprites[m_spriteIdx].draw(p_gc, m_position.x, m_position.y);
-	} else {
-		setFinished(true);
+			const CL_Vec2f p1(m_x[i] - halfW, m_y[i] - halfH);
+			const CL_Vec2f p2(m_x[i] + halfW, m_y[i] + halfH);
+
+			m_positions.push_back(p1);
+			m_positions.push_back(CL_Vec2f(p2.x, p1.y));
+			m_positions.push_back(CL_Vec2f(p1.x, p2.y));
+			m_positions.push_back(CL_Vec2f(p2.x, p1.y));
+			m_positions.push_back(p2);
+			m_positions.push_back(CL_Vec2f(p1.x, p2.y));
+
+			m_texCoords.push_back(t1);
+			m_texCoords.push_back(CL_Vec2f(t2.x, t1.y));
+			m_texCoords.push_back(CL_Vec2f(t1.x, t2.y));
+			m_texCoords.push_back(CL_Vec2f(t2.x, t1.y));
+			m_texCoords.push_back(t2);
+			m_texCoords.push_back(CL_Vec2f(t1.x, t2.y));
+
+			m_colors.insert(m_colors.end(), 6, CL_Colorf(1.0f, 1.0f, 1.0f, smokeAlpha(m_age[i])));
+		}
+
+		if (m_positions.empty()) {
+			continue;
+		}
+
+		// vectors keep their capacity, but set pointers anyway
+		m_array->set_attributes(0, &m_positions[0]);
+		m_array->set_attributes(1, &m_colors[0]);
+		m_array->set_attributes(2, &m_texCoords[0]);
+
+		p_gc.set_texture(0, texture);
+		p_gc.draw_primitives(cl_triangles, static_cast<signed>(m_positions.size()), *m_array);
 	}
 
+	p_gc.reset_texture(0);
+	p_gc.reset_program_object();
 }
 
 void Smoke::load(CL_GraphicContext &p_gc)
 {
-	if (m_smokeSprites[0].is_null()) {
-		for (int i = 0; i <= SMOKE_SPRITES_COUNT - 1; ++i) {
-			m_smokeSprites[i] =
-					CL_Sprite(
-							p_gc,
-							cl_format("race/smoke%1", i + 1),
-							Stage::getResourceManager()
-					);
-		}
+	for (int i = 0; i < SPRITE_COUNT; ++i) {
+		m_sprites[i] =
+				CL_Sprite(
+						p_gc,
+						cl_format("race/smoke%1", i + 1),
+						Stage::getResourceManager()
+				);
 	}
 
+	Drawable::load(p_gc);
 }
 
 }
+
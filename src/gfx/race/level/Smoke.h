@@ -28,17 +28,29 @@
 
 #pragma once
 
-#include "gfx/Animation.h"
+#include <vector>
 
-#include "math/Float.h"
+#include "gfx/Drawable.h"
 
 namespace Gfx {
 
-class Smoke: public Gfx::Animation {
+/**
+ * Smoke clouds of all cars.
+ * <p>
+ * Particles live in a fixed size pool stored as structure of arrays.
+ * Alpha and size of a particle are computed from its age, so updating
+ * it is just advancing the age. All particles that use the same sprite
+ * are drawn with one call.
+ */
+class Smoke: public Gfx::Drawable {
 
 	public:
 
-		Smoke(const CL_Pointf &p_position);
+		/** Maximal number of living particles */
+		static const int MAX_PARTICLES = 1024;
+
+
+		Smoke();
 
 		virtual ~Smoke();
 
@@ -46,26 +58,46 @@ class Smoke: public Gfx::Animation {
 
 		virtual void load(CL_GraphicContext &p_gc);
 
-		virtual void start();
 
-		virtual void update(unsigned p_timeElapsed);
+		/** Starts new smoke cloud. Ignored when the pool is full. */
+		void emit(const CL_Pointf &p_position);
+
+		void update(unsigned p_timeElapsed);
+
+		void clear();
+
+
+		int getParticleCount() const { return m_count; }
 
 	private:
 
+		static const int SPRITE_COUNT = 3;
+
 		// smoke sprites
-		static CL_Sprite m_smokeSprites[];
+		CL_Sprite m_sprites[SPRITE_COUNT];
+
+		/** Living particles are kept at the front of arrays */
+		int m_count;
+
+		/** Particle positions */
+		std::vector<float> m_x, m_y;
+
+		/** Time from particle start */
+		std::vector<unsigned> m_age;
+
+		/** Sprite of each particle */
+		std::vector<unsigned char> m_sprite;
+
+		/** Quads of one sprite (kept to not allocate every frame) */
+		std::vector<CL_Vec2f> m_positions, m_texCoords;
 
-		/** Index of this smoke sprite */
-		int m_spriteIdx;
+		std::vector<CL_Colorf> m_colors;
 
-		/** The position */
-		CL_Pointf m_position;
+		CL_SharedPtr<CL_PrimitivesArray> m_array;
 
-		/** Smoke alpha animation float value */
-		Math::Float m_alpha;
 
-		/** Smoke size animation float value */
-		Math::Float m_size;
+		/** Removes particle by moving the last one in its place */
+		void kill(int p_idx);
 };
 
 }
@@ -28,22 +28,35 @@
 
 #include "TyreStripes.h"
 
+#include <algorithm>
 #include <map>
-#include <list>
+#include <math.h>
+#include <set>
+#include <string.h>
+#include <vector>
 
 #include "common.h"
-#include "logic/race/Car.h"
-#include "logic/race/level/Level.h"
+#include "gfx/Viewport.h"
+#include "gfx/race/RaceSnapshot.h"
 #include "math/Float.h"
 
 namespace Gfx {
 
-const int IMMUTABLE_STRIPE_LIMIT = 256;
+/** Tyres leaving stripes on every car */
+const int WHEEL_COUNT = 4;
+
+/** Side of decal tile (world space pixels) */
+const int TILE_SIZE = 256;
+
+/** Memory limit of decal tiles (both pixel buffers and textures) */
+const int MAX_TILE_MEMORY = 64 * 1024 * 1024;
+
+const int MAX_TILE_COUNT = MAX_TILE_MEMORY / (TILE_SIZE * TILE_SIZE * 4 * 2);
+
+/** Half of stripe width */
+const float STRIPE_RADIUS = 1.5f;
 
 const CL_Colorf STRIPE_COLOR(0.0f, 0.0f, 0.0f, 0.15f);
-const CL_Vec4f STRIPE_COLOR_VEC(
-		STRIPE_COLOR.r, STRIPE_COLOR.g, STRIPE_COLOR.b, STRIPE_COLOR.a
-);
 
 class Stripe {
 
@@ -52,14 +65,10 @@ class Stripe {
 		/** Stipe from -> to points */
 		CL_Pointf m_from, m_to;
 
-		/** Owner to continue last stripe */
-		const Race::Car *m_owner;
+		Stripe() {}
 
-		/** If this stripe is still mutable?  */
-		bool m_mutable;
-
-		Stripe(const CL_Pointf &p_from, const CL_Pointf &p_to, const Race::Car *p_owner) :
-			m_from(p_from), m_to(p_to), m_owner(p_owner), m_mutable(true) {}
+		Stripe(const CL_Pointf &p_from, const CL_Pointf &p_to) :
+			m_from(p_from), m_to(p_to) {}
 
 
 		float length() const { return m_from.distance(m_to); }
@@ -70,79 +79,45 @@ class Stripe {
 
 };
 
-// array of primitives for quicker drawing
-class StripeArr
+/** Square of world that keeps rasterized tyre marks */
+struct DecalTile
 {
-	private:
-
-		/** Verticle array */
-		CL_Vec2f *const m_verticles;
+	/** Marks coverage in alpha channel */
+	CL_PixelBuffer m_pixels;
 
-		/** Color array */
-		CL_Vec4f *const m_colors;
+	/** Created at first draw */
+	CL_Texture m_texture;
 
-		/** Compiled state */
-		bool m_compiled;
+	/** Pixels changed since last upload */
+	CL_Rect m_dirty;
 
-		/** Primitives array */
-		CL_PrimitivesArray *m_priArr;
+	bool m_hasDirty;
 
-		/** m_size * 2 */
-		const int m_size2;
+	/** Frame when tile was drawn or changed for the last time */
+	unsigned m_lastUsed;
 
-		void compile(CL_GraphicContext &p_gc) {
-			G_ASSERT(!m_compiled);
 
-			m_priArr = new CL_PrimitivesArray(p_gc);
-			m_priArr->set_attributes(0, m_verticles);
-			m_priArr->set_attributes(1, m_colors);
-
-			m_compiled = true;
-		}
-
-	public:
-
-		/** Array size */
-		const int m_size;
-
-		StripeArr(int p_size) :
-			m_verticles(new CL_Vec2f[p_size * 2]),
-			m_colors(new CL_Vec4f[p_size * 2]),
-			m_size(p_size),
-			m_size2(p_size * 2),
-			m_compiled(false),
-			m_priArr(NULL)
-		{ /* empty */ }
-
-		~StripeArr() {
-			if (m_priArr) {
-				delete m_priArr;
-			}
-			delete[] m_colors;
-			delete[] m_verticles;
-		}
-
-		void add(int p_idx, const Stripe &p_stripe) {
-			G_ASSERT(!m_compiled);
-			G_ASSERT(p_idx >= 0 && p_idx < m_size);
-
-			const int idx2 = p_idx * 2;
+	DecalTile() :
+		m_hasDirty(false),
+		m_lastUsed(0)
+	{ /* empty */ }
+};
 
-			m_verticles[idx2] = p_stripe.m_from;
-			m_verticles[idx2 + 1] = p_stripe.m_to;
+/** Stripe state of one drifting car */
+struct CarTrail
+{
+	/** Car position in previous update */
+	CL_Pointf m_lastDriftPoint;
 
-			m_colors[idx2] = STRIPE_COLOR_VEC;
-			m_colors[idx2 + 1] = STRIPE_COLOR_VEC;
-		}
+	/** Index of the last stripe of each wheel in stripe pool (or -1) */
+	int m_tails[WHEEL_COUNT];
 
-		void draw(CL_GraphicContext &p_gc) {
-			if (!m_compiled) {
-				compile(p_gc);
-			}
 
-			p_gc.set_program_object(cl_program_color_only);
-			p_gc.draw_primitives(cl_lines, m_size2, *m_priArr);
+	CarTrail() {
+		for (int i = 0; i < WHEEL_COUNT; ++i) {
+			m_tails[i] = -1;
 		}
+	}
 };
 
 
@@ -150,42 +125,56 @@ class TyreStripesImpl
 {
 	public:
 
-		typedef std::list<Stripe> TStripeList;
-		typedef std::deque<StripeArr*> TStripeArrList;
-		typedef std::map<const Race::Car*, CL_Pointf> TDriftPointMap;
+		typedef std::map<const Race::Car*, CarTrail> TCarTrailMap;
+		typedef std::map<std::pair<int, int>, DecalTile> TTileMap;
+
+		const Viewport &m_viewport;
+
+		/** Mutable stripes. Slots are reused, see m_freeStripes. */
+		std::vector<Stripe> m_stripePool;
+
+		/** Unused slots of m_stripePool */
+		std::vector<int> m_freeStripes;
 
-		/** Level at what stripes are drawn */
-		Race::Level m_level;
+		/** Tiles with marks, indexed by column and row */
+		TTileMap m_tiles;
 
-		/** Stripes container. First stripe is the youngest one. */
-		TStripeList m_stripes;
+		/** Frame counter for tile eviction */
+		unsigned m_frame;
 
-		/** Stripe arrays containter */
-		TStripeArrList m_stripeArrays;
+		/** Drifting cars */
+		TCarTrailMap m_trails;
 
-		/** Immutable stripes count (for optimalization) */
-		int m_immutableStripeCnt;
+		/** Mutable stripes batched for drawing */
+		std::vector<CL_Vec2f> m_lineVertices;
 
-		/** Last drift point map */
-		TDriftPointMap m_lastDriftMap;
+		CL_SharedPtr<CL_PrimitivesArray> m_lineArray;
 
 
-		TyreStripesImpl(const Race::Level &p_level) :
-			m_level(p_level),
-			m_immutableStripeCnt(0)
+		TyreStripesImpl(const Viewport &p_viewport) :
+			m_viewport(p_viewport),
+			m_frame(0)
 		{ /* empty */ }
 
 		~TyreStripesImpl() {
 			clear();
 		}
 
+		/**
+		 * Continues last stripe of the wheel if it ends at
+		 * <code>p_from</code>, otherwise seals it and starts a new one.
+		 */
 		void add(
 				const CL_Pointf &p_from,
 				const CL_Pointf &p_to,
-				const Race::Car *p_owner
+				int *p_tail
 		);
 
-		void add4WheelStripe(const Race::Car &p_car, const CL_Pointf &p_from);
+		void add4WheelStripe(
+				const CarPose &p_pose,
+				const CL_Pointf &p_from,
+				CarTrail *p_trail
+		);
 
 
 		void clear();
@@ -197,13 +186,29 @@ class TyreStripesImpl
 		);
 
 
-		/** Splits immutable sprites from mutable */
-		void splitImmutable();
+		/** Rasterizes stripe into tiles and releases its pool slot */
+		void seal(int p_stripe);
+
+		/** Seals last stripes of all wheels */
+		void sealAll(CarTrail *p_trail);
+
+		/** @return Tile at given column and row, created if missing */
+		DecalTile &getTile(int p_col, int p_row);
+
+		/** Drops the least recently used tile */
+		void evictTile();
+
+		/** Blends stripe into pixels of all tiles it touches */
+		void rasterize(const Stripe &p_stripe);
+
+		void drawTiles(CL_GraphicContext &p_gc);
+
+		void drawMutable(CL_GraphicContext &p_gc);
 
 };
 
-TyreStripes::TyreStripes(const Race::Level &p_level) :
-	m_impl(new TyreStripesImpl(p_level))
+TyreStripes::TyreStripes(const Viewport &p_viewport) :
+	m_impl(new TyreStripesImpl(p_viewport))
 {
 	// empty
 }
@@ -216,71 +221,54 @@ TyreStripes::~TyreStripes()
 void TyreStripesImpl::add(
 		const CL_Pointf &p_from,
 		const CL_Pointf &p_to,
-		const Race::Car *p_owner
+		int *p_tail
 )
 {
 	static const unsigned STRIPE_LENGTH_LIMIT = 30;
-	// how many last stripes that belongs to this car should I check?
-	static const int BACK_SEARCH_LIMIT = 4;
 	// point equals check precission
 	static const float EQUAL_CHECK_PRECISSION = 3.0f;
 
-	// search for four last stripes of this car and check if I can merge
-	// this stripe to the last one
-	bool merged = false;
-	int foundCount = 0;
-
-	// last found stripe
-	Stripe *lastFound = NULL;
-
-	for (
-			TStripeList::iterator itor = m_stripes.begin();
-			itor != m_stripes.end();
-			++itor
-	) {
-		Stripe &s = *itor;
+	if (*p_tail != -1) {
+		Stripe &s = m_stripePool[*p_tail];
 
-		if (s.m_owner == p_owner) {
-
-			++foundCount;
-
-			// must end on the same point and length must be below limit
-			if (
-					equals(s.m_to, p_from, EQUAL_CHECK_PRECISSION)
-					&& s.length() < STRIPE_LENGTH_LIMIT
-				) {
-				G_ASSERT(s.m_mutable);
-
-				// remove old stripe
-				Stripe copy = s;
-				m_stripes.erase(itor);
+		// must end on the same point and length must be below limit
+		if (
+				equals(s.m_to, p_from, EQUAL_CHECK_PRECISSION)
+				&& s.length() < STRIPE_LENGTH_LIMIT
+		) {
+			s.m_to = p_to;
+			return;
+		}
 
-				// and construct new one
-				m_stripes.push_front(Stripe(copy.m_from, p_to, p_owner));
-				merged = true;
+		seal(*p_tail);
+	}
 
-				break;
-			}
+	// when not merged, then create a new stripe
+	if (!m_freeStripes.empty()) {
+		*p_tail = m_freeStripes.back();
+		m_freeStripes.pop_back();
 
-			if (foundCount == BACK_SEARCH_LIMIT) {
-				lastFound = &s;
-				break;
-			}
-		}
+		m_stripePool[*p_tail] = Stripe(p_from, p_to);
+	} else {
+		*p_tail = static_cast<signed>(m_stripePool.size());
+		m_stripePool.push_back(Stripe(p_from, p_to));
 	}
+}
 
-	if (!merged) {
-		// when not merged, then create a new stripe
-		m_stripes.push_front(Stripe(p_from, p_to, p_owner));
+void TyreStripesImpl::seal(int p_stripe)
+{
+	rasterize(m_stripePool[p_stripe]);
+	m_freeStripes.push_back(p_stripe);
+}
 
-		// set the last found as immutable
-		if (lastFound) {
-			lastFound->m_mutable = false;
-			m_immutableStripeCnt++;
+void TyreStripesImpl::sealAll(CarTrail *p_trail)
+{
+	for (int i = 0; i < WHEEL_COUNT; ++i) {
+		if (p_trail->m_tails[i] != -1) {
+			seal(p_trail->m_tails[i]);
+			p_trail->m_tails[i] = -1;
 		}
-
 	}
-
 }
 
 bool TyreStripesImpl::equals(
@@ -299,64 +287,67 @@ void TyreStripes::clear()
 
 void TyreStripesImpl::clear()
 {
-	m_stripes.clear();
-	m_lastDriftMap.clear();
-
-
-	foreach (StripeArr *sarr, m_stripeArrays) {
-		delete sarr;
-	}
-
-	m_stripeArrays.clear();
+	m_stripePool.clear();
+	m_freeStripes.clear();
+	m_trails.clear();
+	m_tiles.clear();
 }
 
-void TyreStripes::update()
+void TyreStripes::update(const RaceSnapshot &p_snapshot)
 {
-	const int carCount = m_impl->m_level.getCarCount();
-	TyreStripesImpl::TDriftPointMap::iterator itor;
+	TyreStripesImpl::TCarTrailMap::iterator itor;
+	std::set<const Race::Car*> present;
 
-	for (int i = 0; i < carCount; ++i) {
-		const Race::Car &car = m_impl->m_level.getCar(i);
-		itor = m_impl->m_lastDriftMap.find(&car);
+	foreach (const CarPose &pose, p_snapshot.m_cars) {
+		present.insert(pose.m_car);
+		itor = m_impl->m_trails.find(pose.m_car);
 
-		if (car.isDrifting()) {
+		if (pose.m_drifting) {
 			// add drift point if has last drift point
-			if (itor != m_impl->m_lastDriftMap.end()) {
-				//m_impl->add(itor->second, car.getPosition(), &car);
-				m_impl->add4WheelStripe(car, itor->second);
+			if (itor != m_impl->m_trails.end()) {
+				m_impl->add4WheelStripe(pose, itor->second.m_lastDriftPoint, &itor->second);
+			} else {
+				itor = m_impl->m_trails.insert(std::make_pair(pose.m_car, CarTrail())).first;
 			}
 
 			// remember this point
-			m_impl->m_lastDriftMap[&car] = car.getPosition();
+			itor->second.m_lastDriftPoint = pose.m_position;
 		} else {
-			// remove last drift point if not drifting
-			if (itor != m_impl->m_lastDriftMap.end()) {
-				m_impl->m_lastDriftMap.erase(itor);
+			// stripes of the car will not continue
+			if (itor != m_impl->m_trails.end()) {
+				m_impl->sealAll(&itor->second);
+				m_impl->m_trails.erase(itor);
 			}
 		}
 	}
 
-	// check immutable stripes count for optimalization
-	if (m_impl->m_immutableStripeCnt >= IMMUTABLE_STRIPE_LIMIT) {
-		cl_log_event(LOG_DEBUG, "split stripes: %1, %2", m_impl->m_stripes.size(), m_impl->m_stripeArrays.size());
-		m_impl->splitImmutable();
+	// car left the race, its address can be reused by a new car
+	itor = m_impl->m_trails.begin();
+
+	while (itor != m_impl->m_trails.end()) {
+		if (present.find(itor->first) == present.end()) {
+			m_impl->sealAll(&itor->second);
+			m_impl->m_trails.erase(itor++);
+		} else {
+			++itor;
+		}
 	}
 }
 
 void TyreStripesImpl::add4WheelStripe(
-		const Race::Car &p_car,
-		const CL_Pointf &p_from
+		const CarPose &p_pose,
+		const CL_Pointf &p_from,
+		CarTrail *p_trail
 )
 {
-	static const int WHEEL_COUNT = 4;
 	static const float TYRE_RADIUS = 20.0f; // tire distance from car center
 	static const float DEG_90_RAD = CL_PI / 2;
 	static const float DEG_45_RAD = DEG_90_RAD / 2;
 
-	const CL_Pointf carPos = p_car.getPosition();
+	const CL_Pointf carPos = p_pose.m_position;
 	const CL_Vec2f posDelta = carPos - p_from;
 
-	CL_Angle angle = p_car.getCorpseAngle();
+	CL_Angle angle = p_pose.m_rotation;
 
 	CL_Vec2f v;
 	float rad;
@@ -377,70 +368,225 @@ void TyreStripesImpl::add4WheelStripe(
 		tyrePosB = carPos + v;
 		tyrePosA = tyrePosB - posDelta;
 
-		add(tyrePosA, tyrePosB, &p_car);
+		add(tyrePosA, tyrePosB, &p_trail->m_tails[i]);
 	}
 }
 
-void TyreStripesImpl::splitImmutable()
+DecalTile &TyreStripesImpl::getTile(int p_col, int p_row)
 {
-	static const unsigned ARRAYS_LIMIT = 128;
-
-	// I need to skip first immutable stripes in order to take back
-	// the oldest ones
-	int skipCount = m_immutableStripeCnt - IMMUTABLE_STRIPE_LIMIT;
-	m_immutableStripeCnt -= IMMUTABLE_STRIPE_LIMIT;
-
-	StripeArr *arr = new StripeArr(IMMUTABLE_STRIPE_LIMIT);
-	int idx = 0;
-
-	for (
-			TStripeList::iterator itor = m_stripes.begin();
-			itor != m_stripes.end();
-	) {
-		Stripe &s = *itor;
-		if (!s.m_mutable) {
-
-			// skip first stripes if necessary
-			if (skipCount == 0) {
-				arr->add(idx++, s);
-				m_stripes.erase(itor++);
+	const std::pair<int, int> key(p_col, p_row);
+	TTileMap::iterator itor = m_tiles.find(key);
+
+	if (itor != m_tiles.end()) {
+		return itor->second;
+	}
+
+	if (static_cast<signed>(m_tiles.size()) >= MAX_TILE_COUNT) {
+		evictTile();
+	}
+
+	DecalTile &tile = m_tiles[key];
+
+	tile.m_pixels = CL_PixelBuffer(TILE_SIZE, TILE_SIZE, cl_rgba8);
+	memset(tile.m_pixels.get_data(), 0, tile.m_pixels.get_pitch() * TILE_SIZE);
+
+	return tile;
+}
+
+void TyreStripesImpl::evictTile()
+{
+	TTileMap::iterator oldest = m_tiles.begin();
+
+	for (TTileMap::iterator itor = m_tiles.begin(); itor != m_tiles.end(); ++itor) {
+		if (itor->second.m_lastUsed < oldest->second.m_lastUsed) {
+			oldest = itor;
+		}
+	}
+
+	cl_log_event(
+			LOG_DEBUG, "evict decal tile %1, %2",
+			oldest->first.first, oldest->first.second
+	);
+
+	m_tiles.erase(oldest);
+}
+
+void TyreStripesImpl::rasterize(const Stripe &p_stripe)
+{
+	static const unsigned char ALPHA =
+			static_cast<unsigned char>(STRIPE_COLOR.a * 255.0f);
+
+	const CL_Pointf &a = p_stripe.m_from;
+	const CL_Vec2f ab = p_stripe.m_to - p_stripe.m_from;
+	const float abLen2 = ab.x * ab.x + ab.y * ab.y;
+
+	const float left = std::min(a.x, p_stripe.m_to.x) - STRIPE_RADIUS;
+	const float right = std::max(a.x, p_stripe.m_to.x) + STRIPE_RADIUS;
+	const float top = std::min(a.y, p_stripe.m_to.y) - STRIPE_RADIUS;
+	const float bottom = std::max(a.y, p_stripe.m_to.y) + STRIPE_RADIUS;
+
+	// world pixels covered by the stripe
+	const int x0 = static_cast<int>(floorf(left));
+	const int x1 = static_cast<int>(floorf(right));
+	const int y0 = static_cast<int>(floorf(top));
+	const int y1 = static_cast<int>(floorf(bottom));
+
+	const int col0 = static_cast<int>(floorf(static_cast<float>(x0) / TILE_SIZE));
+	const int col1 = static_cast<int>(floorf(static_cast<float>(x1) / TILE_SIZE));
+	const int row0 = static_cast<int>(floorf(static_cast<float>(y0) / TILE_SIZE));
+	const int row1 = static_cast<int>(floorf(static_cast<float>(y1) / TILE_SIZE));
+
+	for (int row = row0; row <= row1; ++row) {
+		for (int col = col0; col <= col1; ++col) {
+			DecalTile &tile = getTile(col, row);
+			tile.m_lastUsed = m_frame;
+
+			const int tileX = col * TILE_SIZE;
+			const int tileY = row * TILE_SIZE;
+
+			// covered pixels in tile space
+			const CL_Rect rect(
+					std::max(x0 - tileX, 0), std::max(y0 - tileY, 0),
+					std::min(x1 - tileX, TILE_SIZE - 1) + 1,
+					std::min(y1 - tileY, TILE_SIZE - 1) + 1
+			);
+
+			unsigned char *data = static_cast<unsigned char*>(tile.m_pixels.get_data());
+			const int pitch = tile.m_pixels.get_pitch();
+
+			for (int y = rect.top; y < rect.bottom; ++y) {
+				for (int x = rect.left; x < rect.right; ++x) {
+
+					// distance from pixel centre to the stripe
+					const CL_Vec2f ap(tileX + x + 0.5f - a.x, tileY + y + 0.5f - a.y);
+
+					float t = abLen2 > 0.0f ? (ap.x * ab.x + ap.y * ab.y) / abLen2 : 0.0f;
+					t = std::max(0.0f, std::min(t, 1.0f));
+
+					const float dx = ap.x - ab.x * t;
+					const float dy = ap.y - ab.y * t;
+
+					if (dx * dx + dy * dy > STRIPE_RADIUS * STRIPE_RADIUS) {
+						continue;
+					}
+
+					// black over black, only coverage is accumulated
+					unsigned char &alpha = data[y * pitch + x * 4 + 3];
+					alpha = static_cast<unsigned char>(ALPHA + alpha * (255 - ALPHA) / 255);
+				}
+			}
+
+			if (tile.m_hasDirty) {
+				tile.m_dirty.bounding_rect(rect);
 			} else {
-				skipCount--;
-				itor++;
+				tile.m_dirty = rect;
+				tile.m_hasDirty = true;
 			}
-		} else {
-			itor++;
 		}
 	}
+}
 
-	m_stripeArrays.push_back(arr);
+void TyreStripes::draw(CL_GraphicContext &p_gc)
+{
+	++m_impl->m_frame;
+
+	m_impl->drawTiles(p_gc);
+	m_impl->drawMutable(p_gc);
+}
 
-	if (m_stripeArrays.size() > ARRAYS_LIMIT) {
-		delete m_stripeArrays.front();
-		m_stripeArrays.pop_front();
+void TyreStripesImpl::drawTiles(CL_GraphicContext &p_gc)
+{
+	if (m_tiles.empty()) {
+		return;
+	}
+
+	const CL_Rectf &clip = m_viewport.getWorldClipRect();
+
+	const int col0 = static_cast<int>(floorf(clip.left / TILE_SIZE));
+	const int col1 = static_cast<int>(floorf(clip.right / TILE_SIZE));
+	const int row0 = static_cast<int>(floorf(clip.top / TILE_SIZE));
+	const int row1 = static_cast<int>(floorf(clip.bottom / TILE_SIZE));
+
+	for (int row = row0; row <= row1; ++row) {
+		for (int col = col0; col <= col1; ++col) {
+			TTileMap::iterator itor = m_tiles.find(std::make_pair(col, row));
+
+			if (itor == m_tiles.end()) {
+				continue;
+			}
+
+			DecalTile &tile = itor->second;
+			tile.m_lastUsed = m_frame;
+
+			// upload only what has changed
+			if (tile.m_texture.is_null()) {
+				tile.m_texture = CL_Texture(p_gc, TILE_SIZE, TILE_SIZE, cl_rgba8);
+				tile.m_texture.set_image(tile.m_pixels);
+				tile.m_hasDirty = false;
+			} else if (tile.m_hasDirty) {
+				tile.m_texture.set_subimage(
+						tile.m_dirty.left, tile.m_dirty.top,
+						tile.m_pixels, tile.m_dirty
+				);
+				tile.m_hasDirty = false;
+			}
+
+			const CL_Rectf drawRect(
+					static_cast<float>(col * TILE_SIZE),
+					static_cast<float>(row * TILE_SIZE),
+					static_cast<float>((col + 1) * TILE_SIZE),
+					static_cast<float>((row + 1) * TILE_SIZE)
+			);
+
+			p_gc.set_texture(0, tile.m_texture);
+			CL_Draw::texture(p_gc, drawRect, CL_Colorf::white);
+		}
 	}
+
+	p_gc.reset_texture(0);
 }
 
-void TyreStripes::draw(CL_GraphicContext &p_gc)
+void TyreStripesImpl::drawMutable(CL_GraphicContext &p_gc)
 {
+	// mutable stripes go to one draw call
+	m_lineVertices.clear();
+
+	foreach (const TCarTrailMap::value_type &entry, m_trails) {
+		for (int i = 0; i < WHEEL_COUNT; ++i) {
+			const int tail = entry.second.m_tails[i];
+
+			if (tail != -1) {
+				const Stripe &stripe = m_stripePool[tail];
+
+				m_lineVertices.push_back(stripe.getFromPoint());
+				m_lineVertices.push_back(stripe.getToPoint());
+			}
+		}
+	}
+
+	if (m_lineVertices.empty()) {
+		return;
+	}
+
+	if (m_lineArray.is_null()) {
+		m_lineArray = CL_SharedPtr<CL_PrimitivesArray>(new CL_PrimitivesArray(p_gc));
+		m_lineArray->set_attribute(1, STRIPE_COLOR);
+	}
+
 	CL_Pen oldPen = p_gc.get_pen();
 
 	CL_Pen newPen;
-	newPen.set_line_width(3);
+	newPen.set_line_width(static_cast<int>(STRIPE_RADIUS * 2.0f));
 	p_gc.set_pen(newPen);
 
-	// draw arrays
-	foreach (StripeArr *sarr, m_impl->m_stripeArrays) {
-		sarr->draw(p_gc);
-	}
+	// vector could be reallocated since last frame
+	m_lineArray->set_attributes(0, &m_lineVertices[0]);
 
-	foreach (const Stripe &stripe, m_impl->m_stripes) {
-		const CL_Pointf &from = stripe.getFromPoint();
-		const CL_Pointf &to = stripe.getToPoint();
+	p_gc.set_program_object(cl_program_color_only);
+	p_gc.draw_primitives(cl_lines, static_cast<signed>(m_lineVertices.size()), *m_lineArray);
+	p_gc.reset_program_object();
 
-		CL_Draw::line(p_gc, from, to, STRIPE_COLOR);
-	}
+	p_gc.set_pen(oldPen);
 }
 
 } // namespace
-
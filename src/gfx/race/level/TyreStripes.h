@@ -32,20 +32,24 @@
 
 #include "gfx/Drawable.h"
 
-namespace Race {
-	class Level;
-}
-
 namespace Gfx {
 
-class Car;
 class TyreStripesImpl;
-
+class Viewport;
+struct RaceSnapshot;
+
+/**
+ * Tyre marks left by drifting cars.
+ * <p>
+ * Finished marks are rasterized into world-space texture tiles that
+ * are allocated on demand. Only tiles visible in the viewport are drawn
+ * and the least recently used ones are dropped when there are too many.
+ */
 class TyreStripes : public Drawable {
 
 	public:
 
-		TyreStripes(const Race::Level &p_level);
+		TyreStripes(const Viewport &p_viewport);
 
 		virtual ~TyreStripes();
 
@@ -54,7 +58,8 @@ class TyreStripes : public Drawable {
 
 		void clear();
 
-		void update();
+		/** Extends marks of cars drifting in given snapshot */
+		void update(const RaceSnapshot &p_snapshot);
 
 	private:
 
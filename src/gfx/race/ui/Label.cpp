@@ -30,6 +30,8 @@
 
 #include <assert.h>
 
+#include "gfx/FontCache.h"
+
 namespace Gfx {
 
 const int Label::AP_LEFT   = 1;
@@ -54,16 +56,14 @@ Label::Label(
 		m_font(p_font),
 		m_size(p_size),
 		m_color(p_color),
-		m_clFont(NULL)
+		m_sizeValid(false)
 {
 		// empty
 }
 
 Label::~Label()
 {
-	if (m_clFont) {
-		delete m_clFont;
-	}
+	// empty
 }
 
 void Label::draw(CL_GraphicContext &p_gc)
@@ -78,7 +78,7 @@ void Label::draw(CL_GraphicContext &p_gc)
 	const float x = m_pos.x - ax;
 	const float y = m_pos.y - ay - m_fontMetrics.get_descent();
 
-	m_clFont->draw_text(p_gc, x, y, m_text, m_color);
+	m_clFont.draw_text(p_gc, x, y, m_text, m_color);
 
 #if !defined(NDEBUG) && defined(DRAW_LABEL_BOUNDS)
 	// draw label frame debug code
@@ -99,24 +99,20 @@ void Label::load(CL_GraphicContext &p_gc)
 {
 	Drawable::load(p_gc);
 
-	CL_FontDescription desc;
-	desc.set_height(m_size);
+	static const int BOLD_WEIGHT = 100000;
 
+	// labels with the same font share it
 	if (m_font == F_REGULAR || m_font == F_BOLD) {
-		desc.set_typeface_name("tahoma");
-
-		if (m_font == F_BOLD) {
-			desc.set_weight(100000);
-		}
+		const int weight = m_font == F_BOLD ? BOLD_WEIGHT : 0;
 
-		m_clFont = new CL_Font_System(p_gc, desc);
+		m_clFont = FontCache::get(p_gc, "tahoma", m_size, weight);
+		m_fontMetrics = FontCache::getMetrics(p_gc, "tahoma", m_size, weight);
 	} else {
-		desc.set_typeface_name("resources/pixel.ttf");
-		m_clFont = new CL_Font_Freetype(p_gc, desc);
+		m_clFont = FontCache::get(p_gc, "resources/pixel.ttf", m_size, 0, true);
+		m_fontMetrics = FontCache::getMetrics(p_gc, "resources/pixel.ttf", m_size, 0, true);
 	}
 
-	// remember metrics
-	m_fontMetrics = m_clFont->get_font_metrics(p_gc);
+	m_sizeValid = false;
 }
 
 void Label::setColor(const CL_Colorf &p_color)
@@ -131,7 +127,11 @@ void Label::setPosition(const CL_Pointf &p_pos)
 
 void Label::setText(const CL_String &p_text)
 {
-	m_text = p_text;
+	// labels are often set to the same text every frame
+	if (p_text != m_text) {
+		m_text = p_text;
+		m_sizeValid = false;
+	}
 }
 
 float Label::height()
@@ -151,7 +151,13 @@ float Label::width()
 CL_Size Label::size(CL_GraphicContext &p_gc)
 {
 	assert(isLoaded());
-	return m_clFont->get_text_size(p_gc, m_text);
+
+	if (!m_sizeValid) {
+		m_textSize = m_clFont.get_text_size(p_gc, m_text);
+		m_sizeValid = true;
+	}
+
+	return m_textSize;
 }
 
 void Label::setAttachPoint(int p_attachPoint)
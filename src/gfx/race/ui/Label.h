@@ -98,10 +98,16 @@ class Label: public Gfx::Drawable {
 
 		CL_Colorf m_color;
 
-		CL_Font *m_clFont;
+		/** Shared font from FontCache */
+		CL_Font m_clFont;
 
 		CL_FontMetrics m_fontMetrics;
 
+		/** Size of m_text, valid if m_sizeValid */
+		CL_Size m_textSize;
+
+		bool m_sizeValid;
+
 		void calculateAttachPoint(float p_w, float p_h, float &p_x, float &p_y);
 };
 
@@ -28,10 +28,7 @@
 
 #include "PlayerList.h"
 
-#include "common/Player.h"
 #include "gfx/race/ui/Label.h"
-#include "logic/race/Car.h"
-#include "logic/race/RaceLogic.h"
 
 
 namespace Gfx {
@@ -40,7 +37,8 @@ class PlayerListImpl
 {
 	public:
 
-		const Race::RaceLogic *m_logic;
+		/** Player names ordered by race position or NULL */
+		const std::vector<CL_String> *m_ranking;
 
 		CL_Pointf m_position;
 
@@ -49,16 +47,14 @@ class PlayerListImpl
 		int m_labelHeight;
 
 
-		PlayerListImpl(const Race::RaceLogic *p_logic) :
-			m_logic(p_logic),
+		PlayerListImpl() :
+			m_ranking(NULL),
 			m_label(CL_Pointf(), "", Label::F_BOLD, 16)
 		{ /* empty */ }
-
-		const CL_String &ownerName(const Race::Car &p_car);
 };
 
-PlayerList::PlayerList(const Race::RaceLogic *p_logic) :
-	m_impl(new PlayerListImpl(p_logic))
+PlayerList::PlayerList() :
+	m_impl(new PlayerListImpl())
 {
 	// empty
 }
@@ -73,21 +69,27 @@ void PlayerList::setPosition(const CL_Pointf &p_pos)
 	m_impl->m_position = p_pos;
 }
 
+void PlayerList::setRanking(const std::vector<CL_String> *p_ranking)
+{
+	m_impl->m_ranking = p_ranking;
+}
+
 
 void PlayerList::draw(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_impl->m_logic->getLevel();
-	const int carCount = level.getCarCount();
+	if (!m_impl->m_ranking) {
+		return;
+	}
+
+	const int carCount = static_cast<signed>(m_impl->m_ranking->size());
 
 	float h = 0.0f;
 
 	p_gc.mult_translate(m_impl->m_position.x, m_impl->m_position.y);
 
 	for (int i = 0; i < carCount; ++i) {
-		const Race::Car &car = level.getCar(i);
-
 		m_impl->m_label.setPosition(CL_Pointf(0, h));
-		m_impl->m_label.setText(cl_format("%1. %2", i + 1, m_impl->m_logic->getPlayer(car).getName())); // FIXME: not optimal
+		m_impl->m_label.setText(cl_format("%1. %2", i + 1, (*m_impl->m_ranking)[i]));
 
 		m_impl->m_label.draw(p_gc);
 
@@ -107,19 +109,4 @@ void PlayerList::load(CL_GraphicContext &p_gc)
 	Drawable::load(p_gc);
 }
 
-const CL_String &PlayerListImpl::ownerName(const Race::Car &p_car)
-{
-	const int playerCount = m_logic->getPlayerCount();
-
-	for (int i = 0; i < playerCount; ++i) {
-		const Player &player = m_logic->getPlayer(i);
-
-		if (&player.getCar() == &p_car) {
-			return player.getName();
-		}
-	}
-
-	G_ASSERT(0 && "owner not found");
-}
-
 } // namespace
@@ -28,14 +28,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include <ClanLib/core.h>
 
 #include "gfx/Drawable.h"
 
-namespace Race {
-	class RaceLogic;
-}
-
 namespace Gfx {
 
 class PlayerListImpl;
@@ -44,13 +42,19 @@ class PlayerList : public Gfx::Drawable {
 
 	public:
 
-		PlayerList(const Race::RaceLogic *p_logic);
+		PlayerList();
 
 		virtual ~PlayerList();
 
 
 		void setPosition(const CL_Pointf &p_pos);
 
+		/**
+		 * Sets player names ordered by race position. The list must
+		 * stay valid until the next call.
+		 */
+		void setRanking(const std::vector<CL_String> *p_ranking);
+
 
 		virtual void draw(CL_GraphicContext &p_gc);;
 
@@ -30,17 +30,15 @@
 
 #include <map>
 
-#include "common/Game.h"
 #include "gfx/Stage.h"
 #include "gfx/Viewport.h"
+#include "gfx/race/RaceSnapshot.h"
 #include "gfx/race/ui/Label.h"
 #include "gfx/race/ui/PlayerList.h"
 #include "gfx/race/ui/ScoreTable.h"
 #include "gfx/race/ui/SpeedMeter.h"
 #include "gfx/scenes/RaceScene.h"
-#include "logic/race/Car.h"
 #include "logic/race/RaceLogic.h"
-#include "logic/race/Progress.h"
 #include "math/Time.h"
 
 namespace Gfx {
@@ -95,6 +93,9 @@ class RaceUIImpl
 		// Viewport pointer
 		const Gfx::Viewport *m_viewport;
 
+		// Displayed race data or NULL
+		const RaceSnapshot *m_snapshot;
+
 
 		// slots container
 		CL_SlotContainer m_slots;
@@ -104,7 +105,6 @@ class RaceUIImpl
 				const Race::RaceLogic *p_logic,
 				const Gfx::Viewport *p_viewport
 		) :
-			m_playerList(p_logic),
 			m_scoreTable(p_logic),
 			m_globMsgLabel(CL_Pointf(Stage::getWidth() / 2, Stage::getHeight() / 3), "", Label::F_BOLD, 36),
 			m_voteLabel(CL_Pointf(100, 20), "", Label::F_BOLD, 20),
@@ -115,7 +115,8 @@ class RaceUIImpl
 			m_carLabel(CL_Pointf(), "", Label::F_REGULAR, 14),
 			m_countdownLabel(CL_Pointf(0.0f, 0.0f), "", Label::F_BOLD, 75),
 			m_logic(p_logic),
-			m_viewport(p_viewport)
+			m_viewport(p_viewport),
+			m_snapshot(NULL)
 		{
 			m_globMsgLabel.setAttachPoint(Label::AP_CENTER | Label::AP_BOTTOM);
 			m_playerList.setPosition(CL_Pointf(Stage::getWidth() - 200, 100));
@@ -150,6 +151,8 @@ class RaceUIImpl
 
 		void drawGlobalMessage(CL_GraphicContext &p_gc);
 
+		void drawLoadError(CL_GraphicContext &p_gc);
+
 		void drawScoreTable(CL_GraphicContext &p_gc);
 
 
@@ -175,6 +178,14 @@ void RaceUI::update(unsigned p_timeElapsed)
 
 void RaceUI::draw(CL_GraphicContext &p_gc)
 {
+	if (!m_impl->m_snapshot) {
+		// level and progress belongs to the loader now
+		m_impl->drawLoadError(p_gc);
+		m_impl->drawVote(p_gc);
+		m_impl->drawMessageBoard(p_gc);
+		return;
+	}
+
 	m_impl->drawMeters(p_gc);
 	m_impl->drawVote(p_gc);
 	m_impl->drawMessageBoard(p_gc);
@@ -187,9 +198,15 @@ void RaceUI::draw(CL_GraphicContext &p_gc)
 	m_impl->drawScoreTable(p_gc);
 }
 
+void RaceUI::setSnapshot(const RaceSnapshot *p_snapshot)
+{
+	m_impl->m_snapshot = p_snapshot;
+}
+
 void RaceUIImpl::drawMeters(CL_GraphicContext &p_gc)
 {
 	// draw speed control
+	m_speedMeter.setSpeed(m_snapshot->m_playerSpeedKMS);
 	m_speedMeter.draw(p_gc);
 }
 
@@ -278,10 +295,8 @@ void RaceUIImpl::drawMessageBoard(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawLapLabel(CL_GraphicContext &p_gc)
 {
-	const int lapsTotal = m_logic->getRaceLapCount();
-	int lapsCurrent = m_logic->getProgress().getLapNumber(
-			Game::getInstance().getPlayer().getCar()
-	);
+	const int lapsTotal = m_snapshot->m_lapCount;
+	int lapsCurrent = m_snapshot->m_playerLap;
 
 //	if (lapsCurrent > lapsTotal) {
 //		lapsCurrent = lapsTotal;
@@ -297,37 +312,12 @@ void RaceUIImpl::drawLapTimes(CL_GraphicContext &p_gc)
 	static const int RIGHT_MARGIN = 100;
 	static const int Y_DELTA = 16;
 
-	const Race::Car &car = Game::getInstance().getPlayer().getCar();
-	const Race::Progress &pr = m_logic->getProgress();
-	const int lap = pr.getLapNumber(car);
-
-	if (lap == 0) {
+	if (m_snapshot->m_playerLap == 0) {
 		return;
 	}
 
-	// find best lap
-	unsigned best = 0, nbest = 0;
-
-	for (int i = 1; i < lap; ++i) {
-		if (i == 1) {
-			best = pr.getLapTime(car, i);
-		} else {
-			nbest = pr.getLapTime(car, i);
-			if (nbest < best) {
-				best = nbest;
-			}
-		}
-	}
-
-	// get current lap time
-	unsigned curr;
-
-	// display 0 time until race is started
-	if (m_logic->getRaceState() == Race::S_RUNNING) {
-		curr = pr.getLapTime(car, lap);
-	} else {
-		curr = 0;
-	}
+	const unsigned best = m_snapshot->m_playerBestLapTime;
+	const unsigned curr = m_snapshot->m_playerLapTime;
 
 	// display times
 	const int x = Stage::getWidth() - RIGHT_MARGIN;
@@ -373,20 +363,16 @@ void RaceUIImpl::drawLapTimes(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawCarLabels(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	const int carCount = level.getCarCount();
-
 	CL_Pointf pos;
 
-	for (int i = 0; i < carCount; ++i) {
+	foreach (const CarPose &pose, m_snapshot->m_cars) {
 
-		const Race::Car &car = level.getCar(i);
-		pos = m_viewport->toScreen(car.getPosition());
+		pos = m_viewport->toScreen(pose.m_position);
 
 		pos.y += 20;
 
 		m_carLabel.setPosition(pos);
-		m_carLabel.setText(m_logic->getPlayer(car).getName()); // FIXME: not optimal
+		m_carLabel.setText(pose.m_name);
 
 		m_carLabel.draw(p_gc);
 	}
@@ -394,12 +380,13 @@ void RaceUIImpl::drawCarLabels(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawPlayerList(CL_GraphicContext &p_gc)
 {
+	m_playerList.setRanking(&m_snapshot->m_ranking);
 	m_playerList.draw(p_gc);
 }
 
 void RaceUIImpl::drawCountdown(CL_GraphicContext &p_gc)
 {
-	const unsigned startTime = m_logic->getRaceStartTime();
+	const unsigned startTime = m_snapshot->m_startTime;
 
 	if (startTime == 0) { // not started nor pending
 		return;
@@ -475,15 +462,23 @@ void RaceUIImpl::drawCountdownBg(CL_GraphicContext &p_gc)
 
 void RaceUIImpl::drawGlobalMessage(CL_GraphicContext &p_gc)
 {
-	if (m_logic->getRaceState() == Race::S_FINISHED_SINGLE) {
+	if (m_snapshot->m_state == Race::S_FINISHED_SINGLE) {
 		m_globMsgLabel.setText(_("Race finished. Waiting for other players..."));
 		m_globMsgLabel.draw(p_gc);
 	}
 }
 
+void RaceUIImpl::drawLoadError(CL_GraphicContext &p_gc)
+{
+	if (m_logic->hasLoadFailed()) {
+		m_globMsgLabel.setText(_("Cannot load level"));
+		m_globMsgLabel.draw(p_gc);
+	}
+}
+
 void RaceUIImpl::drawScoreTable(CL_GraphicContext &p_gc)
 {
-	if (m_logic->getRaceState() == Race::S_FINISHED_ALL) {
+	if (m_snapshot->m_state == Race::S_FINISHED_ALL) {
 		m_scoreTable.draw(p_gc);
 	}
 }
@@ -43,6 +43,7 @@ namespace Race {
 namespace Gfx {
 
 class RaceUIImpl;
+struct RaceSnapshot;
 class ScoreTable;
 class SpeedMeter;
 class Viewport;
@@ -63,6 +64,12 @@ class RaceUI: public Gfx::Drawable {
 
 		void update(unsigned p_timeElapsed);
 
+		/**
+		 * Sets race data to display. It must stay valid until the next
+		 * call. NULL means that race cannot be displayed yet.
+		 */
+		void setSnapshot(const RaceSnapshot *p_snapshot);
+
 
 		ScoreTable &getScoreTable();
 
@@ -26,6 +26,8 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include <ClanLib/core.h>
 
 #include "Car.h"
@@ -36,6 +38,7 @@
 #include "gfx/DebugLayer.h"
 #include "logic/race/level/Level.h"
 #include "logic/race/level/Bound.h"
+#include "logic/race/resistance/ResistanceGrid.h"
 #include "math/Float.h"
 
 namespace Race {
@@ -61,6 +64,26 @@ class CarImpl
 		/** Iteration counter */
 		unsigned m_iterCnt;
 
+		/** Ground resistance of level where car is placed or NULL */
+		const RaceResistance::ResistanceGrid *m_resistance;
+
+		// start line of level where car is placed
+
+		/** Middle point of start line */
+		CL_Pointf m_startLineOrigin;
+
+		/** Race direction across start line */
+		CL_Vec2f m_startLineForward;
+
+		/** Half of start line length (0 if not set) */
+		float m_startLineHalfWidth;
+
+		/** Forward crossings counter */
+		unsigned m_startLineCrossCnt;
+
+		/** Last forward crossing moment in iterations */
+		float m_startLineCrossTime;
+
 		// current vehicle state
 
 		/** Central position on map */
@@ -111,14 +134,15 @@ class CarImpl
 		/** Wheels turn. -1.0 is max left, 1.0 is max right */
 		float m_phyWheelsTurn;
 
-		/** Body outline for collision check */
-		CL_CollisionOutline m_phyCollisionOutline;
-
 
 		CarImpl(const Car *p_base) :
 			m_base(p_base),
 			m_timeFromLastUpdate(0),
 			m_iterCnt(0),
+			m_resistance(NULL),
+			m_startLineHalfWidth(0.0f),
+			m_startLineCrossCnt(0),
+			m_startLineCrossTime(0.0f),
 			m_position(300.0f, 300.0f),
 			m_rotation(0, cl_degrees),
 			m_speed(0.0f),
@@ -136,6 +160,9 @@ class CarImpl
 
 		void update1_60();
 
+		/** Records start line crossing done by the last movement */
+		void checkStartLine(const CL_Pointf &p_prevPos);
+
 		// helpers
 
 		void alignRotation(CL_Angle &p_what, const CL_Angle &p_to, float p_stepRad);
@@ -153,22 +180,7 @@ METH_SIGNAL_1(Car, inputChanged, const Car&)
 Car::Car() :
 	m_impl(new CarImpl(this))
 {
-	// build car contour for collision check
-	CL_Contour contour;
-
-	const int halfWidth = CAR_WIDTH / 2;
-	const int halfHeight = CAR_HEIGHT / 2;
-	contour.get_points().push_back(CL_Pointf(-halfWidth, halfHeight));
-	contour.get_points().push_back(CL_Pointf(halfWidth, halfHeight));
-	contour.get_points().push_back(CL_Pointf(halfWidth, -halfHeight));
-	contour.get_points().push_back(CL_Pointf(-halfWidth, -halfHeight));
-
-	m_impl->m_phyCollisionOutline.get_contours().push_back(contour);
-
-	m_impl->m_phyCollisionOutline.set_inside_test(true);
-
-	m_impl->m_phyCollisionOutline.calculate_radius();
-	m_impl->m_phyCollisionOutline.calculate_smallest_enclosing_discs();
+	// empty
 }
 
 Car::~Car()
@@ -180,11 +192,9 @@ void Car::update(unsigned p_timeElapsed)
 {
 	m_impl->m_timeFromLastUpdate += p_timeElapsed;
 
-	static const unsigned breakPoint = 1000 / 60;
-
-	while (m_impl->m_timeFromLastUpdate >= breakPoint) {
+	while (m_impl->m_timeFromLastUpdate >= ITERATION_TIME) {
 		m_impl->update1_60();
-		m_impl->m_timeFromLastUpdate -= breakPoint;
+		m_impl->m_timeFromLastUpdate -= ITERATION_TIME;
 	}
 }
 
@@ -226,6 +236,36 @@ void CarImpl::alignRotation(CL_Angle &p_what, const CL_Angle &p_to, float p_step
 	}
 }
 
+void CarImpl::checkStartLine(const CL_Pointf &p_prevPos)
+{
+	if (m_startLineHalfWidth <= 0.0f) {
+		return;
+	}
+
+	// signed distances from the line, negative before it
+	const float before = m_startLineForward.dot(p_prevPos - m_startLineOrigin);
+	const float after = m_startLineForward.dot(m_position - m_startLineOrigin);
+
+	// only forward crossings finish the lap
+	if (before >= 0.0f || after < 0.0f) {
+		return;
+	}
+
+	const float frac = before / (before - after);
+	const CL_Vec2f crossPos = p_prevPos + (m_position - p_prevPos) * frac;
+
+	// plane is crossed also when track passes by elsewhere
+	const CL_Vec2f side(-m_startLineForward.y, m_startLineForward.x);
+
+	if (fabs(side.dot(crossPos - m_startLineOrigin)) > m_startLineHalfWidth) {
+		return;
+	}
+
+	// iteration counter is increased after the movement
+	m_startLineCrossTime = m_iterCnt + frac;
+	++m_startLineCrossCnt;
+}
+
 void CarImpl::update1_60() {
 	
 	static const float BRAKE_POWER = 0.1f;
@@ -347,6 +387,11 @@ void CarImpl::update1_60() {
 	// car cannot travel too quickly
 	m_speed -= m_speed * AIR_RESITANCE;
 
+	// ground resistance
+	if (m_resistance && !m_resistance->isEmpty()) {
+		m_speed -= m_speed * m_resistance->sample(m_position);
+	}
+
 	// calculate next move vector
 	const float m_rotationRad = m_phyMoveRot.to_radians();
 
@@ -357,9 +402,13 @@ void CarImpl::update1_60() {
 	m_phyMoveVec *= m_speed;
 
 	// apply movement (invert y)
+	const CL_Pointf prevPos = m_position;
+
 	m_position.x += m_phyMoveVec.x;
 	m_position.y += m_phyMoveVec.y;
 
+	checkStartLine(prevPos);
+
 	// set speed delta
 	m_phySpeedDelta = m_speed - prevSpeed;
 
@@ -378,26 +427,72 @@ void CarImpl::update1_60() {
 	DebugLayer *dbgl = Gfx::Stage::getDebugLayer();
 
 	dbgl->putMessage("speed", cl_format("%1", m_speed));
-//	if (!m_level) {
-//		const float resistance = m_level->getResistance(m_position.x, m_position.y);
-//		dbgl->putMessage("resist", cl_format("%1", resistance));
-//	}
+	if (m_resistance && !m_resistance->isEmpty()) {
+		const float resistance = m_resistance->sample(m_position);
+		dbgl->putMessage("resist", cl_format("%1", resistance));
+	}
 #endif // NDEBUG
 #endif // CLIENT
 }
 
-CL_CollisionOutline Car::getCollisionOutline() const
+void Car::getCorners(CL_Pointf p_corners[4]) const
 {
-	CL_CollisionOutline outline(m_impl->m_phyCollisionOutline);
+	static const float HALF_WIDTH = CAR_WIDTH / 2;
+	static const float HALF_HEIGHT = CAR_HEIGHT / 2;
+
+	// body axes
+	const float rad = m_impl->m_rotation.to_radians() + CL_PI / 2.0f;
+	const CL_Vec2f u(cos(rad) * HALF_WIDTH, sin(rad) * HALF_WIDTH);
+	const CL_Vec2f v(-sin(rad) * HALF_HEIGHT, cos(rad) * HALF_HEIGHT);
 
-	// transform the outline
-	CL_Angle angle(90, cl_degrees);
-	angle += m_impl->m_rotation;
+	const CL_Pointf &pos = m_impl->m_position;
 
-	outline.set_angle(angle);
-	outline.set_translation(m_impl->m_position.x, m_impl->m_position.y);
+	p_corners[0] = pos - u + v;
+	p_corners[1] = pos + u + v;
+	p_corners[2] = pos + u - v;
+	p_corners[3] = pos - u - v;
+}
+
+CL_Rectf Car::getBounds() const
+{
+	static const float RADIUS = sqrtf(
+			CAR_WIDTH * CAR_WIDTH + CAR_HEIGHT * CAR_HEIGHT
+	) / 2.0f;
 
-	return outline;
+	const CL_Pointf &pos = m_impl->m_position;
+	return CL_Rectf(pos.x - RADIUS, pos.y - RADIUS, pos.x + RADIUS, pos.y + RADIUS);
+}
+
+bool Car::collides(const CL_LineSegment2f &p_seg) const
+{
+	static const float HALF_WIDTH = CAR_WIDTH / 2;
+	static const float HALF_HEIGHT = CAR_HEIGHT / 2;
+
+	// body axes, same as in getCorners()
+	const float rad = m_impl->m_rotation.to_radians() + CL_PI / 2.0f;
+	const CL_Vec2f u(cos(rad), sin(rad));
+	const CL_Vec2f v(-u.y, u.x);
+
+	const CL_Vec2f p = p_seg.p - m_impl->m_position;
+	const CL_Vec2f q = p_seg.q - m_impl->m_position;
+
+	// separating axis test: two body axes and segment normal
+	const float pu = p.dot(u), qu = q.dot(u);
+
+	if (std::min(pu, qu) > HALF_WIDTH || std::max(pu, qu) < -HALF_WIDTH) {
+		return false;
+	}
+
+	const float pv = p.dot(v), qv = q.dot(v);
+
+	if (std::min(pv, qv) > HALF_HEIGHT || std::max(pv, qv) < -HALF_HEIGHT) {
+		return false;
+	}
+
+	const CL_Vec2f n(q.y - p.y, p.x - q.x);
+	const float radius = HALF_WIDTH * fabs(u.dot(n)) + HALF_HEIGHT * fabs(v.dot(n));
+
+	return fabs(p.dot(n)) <= radius;
 }
 
 void Car::applyCollision(const CL_LineSegment2f &p_seg)
@@ -580,6 +675,21 @@ bool Car::isLocked() const
 	return m_impl->m_inputLocked;
 }
 
+unsigned Car::getIterationCount() const
+{
+	return m_impl->m_iterCnt;
+}
+
+unsigned Car::getStartLineCrossCount() const
+{
+	return m_impl->m_startLineCrossCnt;
+}
+
+float Car::getStartLineCrossTime() const
+{
+	return m_impl->m_startLineCrossTime;
+}
+
 const CL_Pointf& Car::getPosition() const
 {
 	return m_impl->m_position;
@@ -691,6 +801,18 @@ void Car::setMovement(const CL_Vec2f &p_movement)
 	m_impl->m_phyMoveVec = p_movement;
 }
 
+void Car::setResistance(const RaceResistance::ResistanceGrid *p_resistance)
+{
+	m_impl->m_resistance = p_resistance;
+}
+
+void Car::setStartLine(const CL_Pointf &p_origin, const CL_Vec2f &p_forward, float p_halfWidth)
+{
+	m_impl->m_startLineOrigin = p_origin;
+	m_impl->m_startLineForward = p_forward;
+	m_impl->m_startLineHalfWidth = p_halfWidth;
+}
+
 const CL_Angle &Car::getCorpseAngle() const
 {
 	return m_impl->m_rotation;
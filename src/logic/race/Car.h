@@ -45,6 +45,10 @@ namespace Gfx {
 	class RaceGraphics;
 }
 
+namespace RaceResistance {
+	class ResistanceGrid;
+}
+
 namespace Race {
 
 class CarImpl;
@@ -58,6 +62,10 @@ class Car : boost::noncopyable
 
 	public:
 
+		/** Length of one physics iteration in milliseconds */
+		static const unsigned ITERATION_TIME = 1000 / 60;
+
+
 		Car();
 
 		virtual ~Car();
@@ -71,6 +79,23 @@ class Car : boost::noncopyable
 
 		bool isLocked() const;
 
+		/**
+		 * Physics iterations are counted only when car is not
+		 * locked, so this value measures simulated race time.
+		 *
+		 * @return Number of physics iterations done so far.
+		 */
+		unsigned getIterationCount() const;
+
+		/** @return Number of forward start line crossings */
+		unsigned getStartLineCrossCount() const;
+
+		/**
+		 * @return Moment of the last forward start line crossing
+		 * in iterations, with the fraction of the physics step.
+		 */
+		float getStartLineCrossTime() const;
+
 		/** @return corpse angle starting from positive X axis CW */
 		virtual const CL_Angle &getCorpseAngle() const;
 
@@ -119,14 +144,34 @@ class Car : boost::noncopyable
 
 		void setPosition(const CL_Pointf &p_position);
 
+		/**
+		 * Sets the start line of the level where car is placed.
+		 * Zero <code>p_halfWidth</code> disables crossing detection.
+		 *
+		 * @param p_origin Middle point of the line.
+		 * @param p_forward Normalized race direction across the line.
+		 * @param p_halfWidth Half of the line length.
+		 */
+		void setStartLine(const CL_Pointf &p_origin, const CL_Vec2f &p_forward, float p_halfWidth);
+
 
 		// other operations
 
 		/** Clones all given car attributes to this one */
 		void clone(const Car &p_car);
 
-		/** @return Current outline based on car position and rotation */
-		CL_CollisionOutline getCollisionOutline() const;
+		/**
+		 * Writes car body corners based on current position and rotation.
+		 *
+		 * @param p_corners Storage for four corners (convex polygon).
+		 */
+		void getCorners(CL_Pointf p_corners[4]) const;
+
+		/** @return Axis aligned rectangle that contains car body */
+		CL_Rectf getBounds() const;
+
+		/** @return true if car body touches given segment */
+		bool collides(const CL_LineSegment2f &p_seg) const;
 
 		void applyCollision(const CL_LineSegment2f &p_seg);
 
@@ -158,6 +203,9 @@ class Car : boost::noncopyable
 		CL_SharedPtr<CarImpl> m_impl;
 
 
+		/** Sets ground resistance of the level where car is placed */
+		void setResistance(const RaceResistance::ResistanceGrid *p_resistance);
+
 		friend class Race::Level;
 		friend class Net::RemoteCar;
 
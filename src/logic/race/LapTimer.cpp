@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LapTimer.h"
+
+#include <math.h>
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+#include "common/Units.h"
+
+namespace Race {
+
+/** Maximal distance between crossing and lap end */
+static const float CROSSING_WINDOW = Units::toScreen(10.0f);
+
+LapTimer::LapTimer(float p_trackLength) :
+	m_trackLength(p_trackLength),
+	m_lapNum(1),
+	m_lastEstimated(false),
+	m_crossLap(0),
+	m_crossTime(0.0f)
+{
+	G_ASSERT(p_trackLength > 0.0f);
+}
+
+LapTimer::~LapTimer()
+{
+	// empty
+}
+
+void LapTimer::reset()
+{
+	m_lapNum = 1;
+	m_times.clear();
+	m_lastEstimated = false;
+	m_crossLap = 0;
+}
+
+void LapTimer::addCrossing(float p_distance, float p_time)
+{
+	// lap which ends nearest to the crossing
+	const int lap = static_cast<int>(floor(p_distance / m_trackLength + 0.5f));
+
+	if (lap < 1 || fabs(p_distance - lap * m_trackLength) > CROSSING_WINDOW) {
+		return;
+	}
+
+	if (lap < m_lapNum) {
+		// distance has finished the lap first
+		if (lap == m_lapNum - 1 && m_lastEstimated) {
+			m_times.back() = p_time;
+			m_lastEstimated = false;
+		}
+
+		return;
+	}
+
+	m_crossLap = lap;
+	m_crossTime = p_time;
+}
+
+void LapTimer::update(float p_distance, float p_time)
+{
+	while (p_distance >= m_lapNum * m_trackLength) {
+		if (m_crossLap == m_lapNum) {
+			m_times.push_back(m_crossTime);
+			m_lastEstimated = false;
+		} else {
+			m_times.push_back(p_time);
+			m_lastEstimated = true;
+		}
+
+		++m_lapNum;
+	}
+}
+
+float LapTimer::getFinishTime(int p_lap) const
+{
+	G_ASSERT(p_lap >= 1 && p_lap < m_lapNum && "lap not finished yet");
+	return m_times[p_lap - 1];
+}
+
+} // namespace
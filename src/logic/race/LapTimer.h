@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace Race {
+
+/**
+ * Counts laps of one car and keeps moments when they were finished.
+ * <p>
+ * Lap is finished when driven distance reaches full track lengths, but
+ * its moment comes from the start line crossing recorded by car
+ * physics. When car crosses the line at an angle, the crossing can be
+ * noticed one update before or after the distance change, so both
+ * orders are matched here.
+ */
+class LapTimer
+{
+	public:
+
+		/** @param p_trackLength Distance driven in one lap */
+		explicit LapTimer(float p_trackLength);
+
+		virtual ~LapTimer();
+
+
+		/** Starts again from the first lap */
+		void reset();
+
+		/**
+		 * Registers forward start line crossing. Crossings that are not
+		 * close to the end of a lap (like at race start) are ignored.
+		 *
+		 * @param p_distance Distance driven when crossing was noticed.
+		 * @param p_time Crossing moment.
+		 */
+		void addCrossing(float p_distance, float p_time);
+
+		/**
+		 * Finishes laps driven up to <code>p_distance</code>. If there
+		 * is no crossing for a lap yet, <code>p_time</code> is used
+		 * until the crossing comes.
+		 */
+		void update(float p_distance, float p_time);
+
+
+		/** @return Current lap number (1 before first lap is finished) */
+		int getLapNumber() const { return m_lapNum; }
+
+		/** @return Finish moment of already finished lap */
+		float getFinishTime(int p_lap) const;
+
+	private:
+
+		/** Distance of one lap */
+		const float m_trackLength;
+
+		/** Current lap */
+		int m_lapNum;
+
+		/** Finish moments of laps */
+		std::vector<float> m_times;
+
+		/** Set when the last finish moment waits for its crossing */
+		bool m_lastEstimated;
+
+		/** Lap that will be finished by stored crossing (0 if none) */
+		int m_crossLap;
+
+		/** Stored crossing moment */
+		float m_crossTime;
+};
+
+} // namespace
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LevelLoader.h"
+
+#include <exception>
+
+#include "logic/race/Progress.h"
+#include "logic/race/level/Level.h"
+
+namespace Race
+{
+
+class LevelLoaderImpl : public CL_Runnable
+{
+	public:
+
+		// signals
+		SIG_IMPL(LevelLoader, progressChanged);
+		SIG_IMPL(LevelLoader, finished);
+
+
+		/** Level to load */
+		Level *m_level;
+
+		/** Progress to initialize */
+		Progress *m_progress;
+
+		/** Level file name */
+		CL_String m_filename;
+
+		/** Worker thread */
+		CL_Thread m_thread;
+
+		/** Set when thread was started and not joined yet */
+		bool m_threadStarted;
+
+		/** Set when started and finished signal was not delivered yet */
+		bool m_running;
+
+		/** Last progress value that was signalled */
+		float m_signalledProgress;
+
+		// state shared with the worker
+
+		/** Guards the shared state */
+		mutable CL_Mutex m_mutex;
+
+		/** Current progress */
+		float m_loadProgress;
+
+		/** Set by the worker when its job is done */
+		bool m_done;
+
+		/** Loading result */
+		bool m_succeeded;
+
+		/** Set when the owner does not want the result anymore */
+		bool m_cancelled;
+
+
+		LevelLoaderImpl() :
+			m_level(NULL),
+			m_progress(NULL),
+			m_threadStarted(false),
+			m_running(false),
+			m_signalledProgress(0.0f),
+			m_loadProgress(0.0f),
+			m_done(false),
+			m_succeeded(false),
+			m_cancelled(false)
+		{ /* empty */ }
+
+
+		virtual void run();
+
+		void join();
+
+		void setProgress(float p_progress);
+
+		/** Receives level progress, called by the worker */
+		void onLevelProgress(float p_progress);
+
+		void setDone(bool p_succeeded);
+
+		bool isCancelled() const;
+
+		/** Stops the worker at the next stage when cancel was requested */
+		void checkCancelled() const;
+};
+
+SIG_CPP(LevelLoader, progressChanged);
+SIG_CPP(LevelLoader, finished);
+
+LevelLoader::LevelLoader() :
+	m_impl(new LevelLoaderImpl())
+{
+	// empty
+}
+
+LevelLoader::~LevelLoader()
+{
+	cancel();
+}
+
+void LevelLoader::start(Level *p_level, Progress *p_progress, const CL_String &p_filename)
+{
+	G_ASSERT(p_level && p_progress);
+	G_ASSERT(!m_impl->m_threadStarted && "loader is already running");
+
+	m_impl->m_level = p_level;
+	m_impl->m_progress = p_progress;
+	m_impl->m_filename = p_filename;
+
+	m_impl->m_loadProgress = 0.0f;
+	m_impl->m_signalledProgress = 0.0f;
+	m_impl->m_done = false;
+	m_impl->m_succeeded = false;
+	m_impl->m_cancelled = false;
+
+	m_impl->m_running = true;
+	m_impl->m_threadStarted = true;
+
+	m_impl->m_thread.start(m_impl.get());
+}
+
+// part of work done after level is loaded
+static const float LEVEL_LOADED_PROGRESS = 0.8f;
+
+void LevelLoaderImpl::run()
+{
+	bool succeeded = true;
+
+	m_level->func_loadProgress().set(this, &LevelLoaderImpl::onLevelProgress);
+
+	try {
+		if (!m_level->isUsable()) {
+			succeeded = m_level->load(m_filename);
+		} else {
+			// track could be changed since it was loaded
+			m_level->rebuildTrackData();
+		}
+
+		checkCancelled();
+
+		if (succeeded) {
+			m_progress->initialize();
+		}
+
+	} catch (CL_Exception &e) {
+		if (isCancelled()) {
+			cl_log_event(LOG_DEBUG, "loading of level '%1' cancelled", m_filename);
+		} else {
+			cl_log_event(LOG_ERROR, "cannot load level '%1': %2", m_filename, e.message);
+		}
+
+		succeeded = false;
+	} catch (std::exception &e) {
+		cl_log_event(LOG_ERROR, "cannot load level '%1': %2", m_filename, e.what());
+		succeeded = false;
+	}
+
+	// loader can be destroyed before the level
+	m_level->func_loadProgress().clear();
+
+	if (succeeded) {
+		setProgress(1.0f);
+	}
+
+	setDone(succeeded);
+}
+
+void LevelLoaderImpl::setProgress(float p_progress)
+{
+	CL_MutexSection lock(&m_mutex);
+	m_loadProgress = p_progress;
+}
+
+void LevelLoaderImpl::onLevelProgress(float p_progress)
+{
+	// level reports progress between its stages
+	checkCancelled();
+
+	setProgress(p_progress * LEVEL_LOADED_PROGRESS);
+}
+
+void LevelLoaderImpl::setDone(bool p_succeeded)
+{
+	CL_MutexSection lock(&m_mutex);
+
+	m_succeeded = p_succeeded;
+	m_done = true;
+}
+
+bool LevelLoaderImpl::isCancelled() const
+{
+	CL_MutexSection lock(&m_mutex);
+	return m_cancelled;
+}
+
+void LevelLoaderImpl::checkCancelled() const
+{
+	if (isCancelled()) {
+		throw CL_Exception("loading cancelled");
+	}
+}
+
+void LevelLoaderImpl::join()
+{
+	if (m_threadStarted) {
+		m_thread.join();
+		m_threadStarted = false;
+	}
+}
+
+void LevelLoader::update()
+{
+	if (!m_impl->m_running) {
+		return;
+	}
+
+	float progress;
+	bool done, succeeded;
+
+	{
+		CL_MutexSection lock(&m_impl->m_mutex);
+
+		progress = m_impl->m_loadProgress;
+		done = m_impl->m_done;
+		succeeded = m_impl->m_succeeded;
+	}
+
+	if (progress != m_impl->m_signalledProgress) {
+		m_impl->m_signalledProgress = progress;
+		m_impl->INVOKE_1(progressChanged, progress);
+	}
+
+	if (done) {
+		m_impl->join();
+		m_impl->m_running = false;
+
+		m_impl->INVOKE_1(finished, succeeded);
+	}
+}
+
+void LevelLoader::wait()
+{
+	m_impl->join();
+	m_impl->m_running = false;
+}
+
+void LevelLoader::cancel()
+{
+	{
+		CL_MutexSection lock(&m_impl->m_mutex);
+		m_impl->m_cancelled = true;
+	}
+
+	wait();
+}
+
+float LevelLoader::getProgress() const
+{
+	CL_MutexSection lock(&m_impl->m_mutex);
+	return m_impl->m_loadProgress;
+}
+
+bool LevelLoader::isRunning() const
+{
+	return m_impl->m_running;
+}
+
+} // namespace
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+
+namespace Race
+{
+
+class Level;
+class Progress;
+class LevelLoaderImpl;
+
+/**
+ * Loads level and initializes race progress on a background thread.
+ * <p>
+ * While loading is in progress the level and progress objects belongs
+ * to the worker and must not be touched. Signals are delivered from
+ * update() so their handlers are always run by the thread that started
+ * the loader.
+ */
+class LevelLoader
+{
+
+	/** Invoked with the loading progress from 0.0 to 1.0 */
+	SIG_H_1(progressChanged, float);
+
+	/** Invoked once when loading is done. Argument tells if it succeeded. */
+	SIG_H_1(finished, bool);
+
+	public:
+
+		LevelLoader();
+
+		virtual ~LevelLoader();
+
+
+		/** @return Loading progress from 0.0 to 1.0 */
+		float getProgress() const;
+
+		/** @return true when worker is started and finished signal is not yet sent */
+		bool isRunning() const;
+
+		/**
+		 * Starts loading on a background thread. If level is usable
+		 * already, then only its resistance and the progress object
+		 * will be rebuilt.
+		 */
+		void start(Level *p_level, Progress *p_progress, const CL_String &p_filename);
+
+		/** Delivers the signals. Call it periodically when loader is running. */
+		void update();
+
+		/** Blocks until the worker is done. No signals are delivered. */
+		void wait();
+
+		/**
+		 * Asks the worker to stop at the next loading stage and blocks
+		 * until it does. The level is left unusable and no signals are
+		 * delivered.
+		 */
+		void cancel();
+
+	private:
+
+		CL_SharedPtr<LevelLoaderImpl> m_impl;
+};
+
+} // namespace
@@ -60,13 +60,20 @@ void OfflineRaceLogic::initialize()
 
 	if (m_levelOwner) {
 		level.initialize();
-		level.load(m_levelName);
 	}
 
-	// init progress object
-	Progress &prog = getProgress();
-	prog.initialize();
-	prog.resetClock();
+	// not owned level is loaded already, so only progress will be loaded
+	loadLevel(m_levelName);
+}
+
+void OfflineRaceLogic::onLevelLoaded(bool p_succeeded)
+{
+	if (!p_succeeded) {
+		return;
+	}
+
+	Level &level = getLevel();
+	getProgress().resetClock();
 
 	Game &game = Game::getInstance();
 	Player &player = game.getPlayer();
@@ -85,6 +92,8 @@ void OfflineRaceLogic::initialize()
 
 void OfflineRaceLogic::destroy()
 {
+	cancelLevel();
+
 	getProgress().destroy();
 
 	if (m_levelOwner) {
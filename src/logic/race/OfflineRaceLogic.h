@@ -56,6 +56,10 @@ class OfflineRaceLogic: public Race::RaceLogic {
 
 		virtual void destroy();
 
+	protected:
+
+		virtual void onLevelLoaded(bool p_succeeded);
+
 	private:
 
 		CL_String m_levelName;
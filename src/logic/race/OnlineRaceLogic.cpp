@@ -31,6 +31,7 @@
 #include <assert.h>
 
 #include "Car.h"
+#include "common/Collections.h"
 #include "common/Game.h"
 #include "logic/race/Progress.h"
 #include "network/packets/GameState.h"
@@ -46,6 +47,7 @@ OnlineRaceLogic::OnlineRaceLogic(const CL_String &p_host, int p_port) :
 	m_port(p_port),
 	m_client(&Game::getInstance().getNetworkConnection()),
 	m_localPlayer(Game::getInstance().getPlayer()),
+	m_pendingRaceStart(false),
 	m_voteRunning(false)
 {
 	G_ASSERT(p_port > 0 && p_port <= 0xFFFF);
@@ -94,6 +96,7 @@ void OnlineRaceLogic::destroy()
 {
 	if (m_initialized) {
 		m_client->disconnect();
+		cancelLevel();
 
 		// remove cars from level
 		const int playerCount = getPlayerCount();
@@ -141,29 +144,46 @@ void OnlineRaceLogic::onGoodbye(GoodbyeReason p_reason, const CL_String &p_messa
 
 void OnlineRaceLogic::onPlayerJoined(const CL_String &p_name)
 {
+	if (!isReady()) {
+		// players can be added when level is loaded
+		m_pendingJoins.push_back(p_name);
+		return;
+	}
+
 	// check player existence
 
 	if (!hasPlayer(p_name)) {
-		// create new player
-
-		m_remotePlayers.push_back(
-				CL_SharedPtr<RemotePlayer>(new RemotePlayer(p_name))
-		);
-
-		RemotePlayer &player = *m_remotePlayers.back();
-		addPlayer(&player);
-
-		// add his car to the level
-		getLevel().addCar(&player.getCar());
-
+		addRemotePlayer(p_name);
 		display(cl_format(_("Player %1 joined"), p_name));
 	} else {
 		cl_log_event(LOG_ERROR, "Player named '%1' already in list", p_name);
 	}
 }
 
+void OnlineRaceLogic::addRemotePlayer(const CL_String &p_name)
+{
+	m_remotePlayers.push_back(
+			CL_SharedPtr<RemotePlayer>(new RemotePlayer(p_name))
+	);
+
+	RemotePlayer &player = *m_remotePlayers.back();
+	addPlayer(&player);
+
+	// add his car to the level
+	getLevel().addCar(&player.getCar());
+}
+
 void OnlineRaceLogic::onPlayerLeaved(const CL_String &p_name)
 {
+	if (!isReady()) {
+		// forget about player that was not added yet
+		if (!Collections::remove(m_pendingJoins, p_name)) {
+			m_pendingLeaves.push_back(p_name);
+		}
+
+		return;
+	}
+
 	// get the player
 	Player &player = getPlayer(p_name);
 
@@ -191,51 +211,73 @@ void OnlineRaceLogic::onPlayerLeaved(const CL_String &p_name)
 
 void OnlineRaceLogic::onGameState(const Net::GameState &p_gameState)
 {
-	// load level
-	const CL_String &levelName = p_gameState.getLevel();
+	// players will be added when level is loaded
+	m_gameState = p_gameState;
+
+	// load level in background, so network events are still handled
 	getLevel().initialize();
-	getLevel().load(levelName);
+	loadLevel(m_gameState.getLevel());
+}
+
+void OnlineRaceLogic::onLevelLoaded(bool p_succeeded)
+{
+	if (!p_succeeded) {
+		return;
+	}
 
-	// initialize progress object
-	getProgress().initialize();
 	getProgress().resetClock();
 
-	// add rest of players
-	const unsigned playerCount = p_gameState.getPlayerCount();
+	// add players from game state
+	const unsigned playerCount = m_gameState.getPlayerCount();
 
 	Player *player;
 	Car *car;
 
 	for (unsigned i = 0; i < playerCount; ++i) {
-		const CL_String &playerName = p_gameState.getPlayerName(i);
+		const CL_String &playerName = m_gameState.getPlayerName(i);
+
+		if (Collections::remove(m_pendingLeaves, playerName)) {
+			// leaved when level was loading
+			continue;
+		}
 
 		if (playerName == m_localPlayer.getName()) {
 			// this is local player, so it exists now
 			player = &m_localPlayer;
+			addPlayer(player);
+			getLevel().addCar(&player->getCar());
 		} else {
 			// this is remote player
-			m_remotePlayers.push_back(
-					CL_SharedPtr<RemotePlayer>(new RemotePlayer(playerName))
-			);
-
+			addRemotePlayer(playerName);
 			player = m_remotePlayers.back();
 		}
 
-		// put player to player list
-		addPlayer(player);
-
-		// prepare car and put it to level
+		// prepare car
 		car = &player->getCar();
-		car->deserialize(p_gameState.getCarState(i).getSerializedData());
+		car->deserialize(m_gameState.getCarState(i).getSerializedData());
+	}
 
-		getLevel().addCar(&player->getCar());
+	// and players that joined in the meantime
+	foreach (const CL_String &name, m_pendingJoins) {
+		onPlayerJoined(name);
 	}
 
+	m_pendingJoins.clear();
+	m_pendingLeaves.clear();
 
+	if (m_pendingRaceStart) {
+		m_pendingRaceStart = false;
+		onRaceStart(m_pendingStartPos, m_pendingStartRot);
+	}
 }
 
 void OnlineRaceLogic::onCarState(const Net::CarState &p_carState)
 {
+	if (!isReady()) {
+		// cars are not on the level yet
+		return;
+	}
+
 	const CL_String &playerName = p_carState.getName();
 
 	if (hasPlayer(playerName)) {
@@ -251,6 +293,15 @@ void OnlineRaceLogic::onRaceStart(
 		const CL_Angle &p_carRotation
 )
 {
+	if (!isReady()) {
+		// start it when level is loaded
+		m_pendingRaceStart = true;
+		m_pendingStartPos = p_carPosition;
+		m_pendingStartRot = p_carRotation;
+
+		return;
+	}
+
 	cl_log_event(LOG_RACE, "race is starting");
 
 	Car &car = Game::getInstance().getPlayer().getCar();
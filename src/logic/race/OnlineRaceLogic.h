@@ -34,10 +34,10 @@
 #include "common/RemotePlayer.h"
 #include "RaceLogic.h"
 #include "network/client/Client.h"
+#include "network/packets/GameState.h"
 
 namespace Net {
 	class CarState;
-	class GameState;
 }
 
 namespace Race {
@@ -79,6 +79,9 @@ class OnlineRaceLogic: public Race::RaceLogic {
 
 		virtual void update(unsigned p_timeElapsed);
 
+	protected:
+
+		virtual void onLevelLoaded(bool p_succeeded);
 
 	private:
 
@@ -107,6 +110,27 @@ class OnlineRaceLogic: public Race::RaceLogic {
 		CL_SlotContainer m_slots;
 
 
+		// level loading
+
+		/** Game state to apply when level is loaded */
+		Net::GameState m_gameState;
+
+		/** Players that joined when level was loading */
+		std::vector<CL_String> m_pendingJoins;
+
+		/** Players from game state that leaved when level was loading */
+		std::vector<CL_String> m_pendingLeaves;
+
+		/** Set when race start was received when level was loading */
+		bool m_pendingRaceStart;
+
+		/** Start position of pending race */
+		CL_Pointf m_pendingStartPos;
+
+		/** Start rotation of pending race */
+		CL_Angle m_pendingStartRot;
+
+
 		// vote system
 
 		bool m_voteRunning;
@@ -120,6 +144,11 @@ class OnlineRaceLogic: public Race::RaceLogic {
 		unsigned m_voteTimeout;
 
 
+		// helpers
+
+		void addRemotePlayer(const CL_String &p_name);
+
+
 		// signal handlers
 
 		void onConnected();
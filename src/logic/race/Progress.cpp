@@ -28,10 +28,13 @@
 
 #include "Progress.h"
 
+#include <algorithm>
 #include <map>
 
 #include "common.h"
 #include "logic/race/Car.h"
+#include "logic/race/LapTimer.h"
+#include "logic/race/level/Centreline.h"
 #include "logic/race/level/Checkpoint.h"
 #include "logic/race/level/Level.h"
 #include "logic/race/level/Track.h"
@@ -44,25 +47,59 @@ namespace Race
 class ProgressInfo
 {
 	public:
-		ProgressInfo(const Checkpoint &p_cp) :
-			m_lapNum(1),
-			m_cp(p_cp)
+		ProgressInfo(const Car *p_car, const Checkpoint &p_cp, int p_rank, float p_trackLength) :
+			m_car(p_car),
+			m_laps(p_trackLength),
+			m_cp(p_cp),
+			m_segIdx(-1),
+			m_param(0.0f),
+			m_distance(0.0f),
+			m_wrongWay(false),
+			m_startIter(p_car->getIterationCount()),
+			m_crossCount(p_car->getStartLineCrossCount()),
+			m_rank(p_rank)
 		{ /* empty */ }
 
 		void reset(const Checkpoint &p_cp) {
-			m_lapNum = 1;
+			m_laps.reset();
 			m_cp = p_cp;
-			m_times.clear();
+			m_segIdx = -1;
+			m_param = 0.0f;
+			m_distance = 0.0f;
+			m_wrongWay = false;
+			m_startIter = m_car->getIterationCount();
+			m_crossCount = m_car->getStartLineCrossCount();
 		}
 
-		// current lap
-		int m_lapNum;
+		// tracked car
+		const Car *m_car;
 
-		// farthest accepted checkpoint on track
+		// laps and their finish moments in iterations
+		LapTimer m_laps;
+
+		// last checkpoint passed
 		Checkpoint m_cp;
 
-		// lap times
-		std::vector<unsigned> m_times;
+		// centreline segment from last update (-1 if not located yet)
+		int m_segIdx;
+
+		// position on centreline (distance from start line)
+		float m_param;
+
+		// distance driven from start line (negative before crossing it)
+		float m_distance;
+
+		// true if car moves backwards
+		bool m_wrongWay;
+
+		// iteration count when race has started
+		unsigned m_startIter;
+
+		// start line crossings counted by the car until last update
+		unsigned m_crossCount;
+
+		// index in race ranking (0 is leader)
+		int m_rank;
 };
 
 class ProgressImpl
@@ -73,25 +110,27 @@ class ProgressImpl
 		typedef std::pair<const Car*, ProgressInfo*> TCarProgressPair;
 
 		typedef std::vector<Checkpoint> TCheckpointList;
-		typedef std::vector<int> TCheckpointDistances;
+		typedef std::vector<float> TCheckpointParams;
+		typedef std::vector<ProgressInfo*> TRankingList;
 
 
 		/** Cars to progress mapping */
 		TCarProgressMap m_cars;
 
+		/** Cars ordered by race position (leader first) */
+		TRankingList m_ranking;
+
 		/** All checkpoints ordered from first to last */
 		TCheckpointList m_chkpts;
 
 		/**
-		 * Checkpoint distances. 0 is distance between 0 and 1, last between
-		 * last checkpoint and 0. Distances held in world units.
+		 * Checkpoint positions on track centreline. Distances from
+		 * start line in world units.
 		 */
-		TCheckpointDistances m_dists;
+		TCheckpointParams m_cpParams;
 
 		const Level &m_level;
 
-		unsigned m_clock;
-
 		/** Initialized flag */
 		bool m_initd;
 
@@ -100,8 +139,7 @@ class ProgressImpl
 
 		ProgressImpl(const Level &p_level) :
 			m_level(p_level),
-			m_initd(false),
-			m_clock(0)
+			m_initd(false)
 		{ /* empty */ }
 
 		~ProgressImpl()
@@ -110,20 +148,24 @@ class ProgressImpl
 		}
 
 
-		const Checkpoint &closestCheckpoint(const CL_Pointf &p_pos) const;
-
-		void destroy();
+		/**
+		 * @return Index of last checkpoint placed before
+		 * <code>p_param</code>. Search starts from <code>p_hintIdx</code>.
+		 */
+		int checkpointAt(float p_param, int p_hintIdx) const;
 
-		float distPow(const CL_Pointf &p_a, const CL_Pointf &p_b) const
+		const Centreline &centreline() const
 		{
-			const float a = p_b.x - p_a.x;
-			const float b = p_b.y - p_a.y;
-			return a * a + b * b;
+			return m_level.getTrackTriangulator().getCentreline();
 		}
 
-		int distance(const Checkpoint &p_from, const Checkpoint &p_to) const;
+		void destroy();
 
-		bool startLinePassed(const Car *p_car);
+		/** Projects car on centreline and updates its progress */
+		void updateCar(ProgressInfo &p_info);
+
+		/** Restores ranking order after distances has changed */
+		void updateRanking();
 };
 
 Progress::Progress(const Level &p_level) :
@@ -140,7 +182,17 @@ Progress::~Progress()
 void Progress::addCar(const Car &p_car)
 {
 	G_ASSERT(m_impl->m_initd);
-	m_impl->m_cars[&p_car] = new ProgressInfo(m_impl->m_chkpts[0]);
+	G_ASSERT(m_impl->m_cars.find(&p_car) == m_impl->m_cars.end());
+
+	const int rank = static_cast<signed>(m_impl->m_ranking.size());
+
+	ProgressInfo *info = new ProgressInfo(
+			&p_car, m_impl->m_chkpts[0], rank,
+			m_impl->centreline().getLength()
+	);
+
+	m_impl->m_cars[&p_car] = info;
+	m_impl->m_ranking.push_back(info);
 }
 
 void Progress::reset(const Car &p_car)
@@ -153,12 +205,21 @@ void Progress::reset(const Car &p_car)
 	G_ASSERT(itor != m_impl->m_cars.end());
 
 	itor->second->reset(m_impl->m_chkpts[0]);
+	m_impl->updateRanking();
 }
 
 void Progress::resetClock()
 {
 	G_ASSERT(m_impl->m_initd);
-	m_impl->m_clock = CL_System::get_time();
+
+	ProgressImpl::TCarProgressPair pair;
+
+	foreach (pair, m_impl->m_cars) {
+		ProgressInfo &info = *pair.second;
+
+		info.m_startIter = info.m_car->getIterationCount();
+		info.m_crossCount = info.m_car->getStartLineCrossCount();
+	}
 }
 
 void Progress::initialize()
@@ -168,6 +229,7 @@ void Progress::initialize()
 	}
 
 	G_ASSERT(m_impl->m_level.isUsable() && "level is not usable");
+	G_ASSERT(!m_impl->centreline().isEmpty() && "track not triangulated");
 
 	// minimal checkpoint distance
 	static const int MIN_DISTANCE = 50;
@@ -179,45 +241,43 @@ void Progress::initialize()
 	const int segCount = track.getPointCount();
 
 	int chkPtIdx = 0;
-	CL_Pointf prevPos;
-	float dist;
+	CL_Pointf prevPos, prevMid;
+	bool first = true;
+
+	// centreline goes through the same mid points
+	float param = 0.0f;
 
 	for (int i = 0; i < segCount; ++i) {
 		const TrackSegment &seg = triang.getSegment(i);
 
 		// from mid points of track
-		const std::vector<CL_Pointf> &midPts = seg.getMidPoints();
-		const int midCount = midPts.size();
+		const CL_Pointf *midPts = seg.getMidPoints();
+		const int midCount = seg.getMidPointCount();
 
 		for (int j = 0; j < midCount; ++j) {
 
-			if (chkPtIdx != 0) {
-
-				dist = prevPos.distance(midPts[j]);
+			if (!first) {
+				param += prevMid.distance(midPts[j]);
+			} else {
+				first = false;
+			}
 
-				// skip point if distance is to low
-				if (dist < MIN_DISTANCE) {
-					continue;
-				}
+			prevMid = midPts[j];
 
-				// save the distance
-				m_impl->m_dists.push_back(static_cast<int>(ceil(dist)));
+			// skip point if distance is to low
+			if (chkPtIdx != 0 && prevPos.distance(midPts[j]) < MIN_DISTANCE) {
+				continue;
 			}
 
 			m_impl->m_chkpts.push_back(Checkpoint(chkPtIdx++, midPts[j]));
+			m_impl->m_cpParams.push_back(param);
+
 			prevPos = m_impl->m_chkpts.back().getPosition();
 		}
 	}
 
 	G_ASSERT(m_impl->m_chkpts.size() > 0 && "no checkpoints loaded");
 
-	// insert distance betwwen first and last
-	dist = m_impl->m_chkpts.back().getPosition().distance(
-			m_impl->m_chkpts.front().getPosition()
-	);
-
-	m_impl->m_dists.push_back(dist);
-
 	// mark initialized
 	m_impl->m_initd = true;
 
@@ -240,8 +300,9 @@ void ProgressImpl::destroy()
 	}
 
 	m_chkpts.clear();
-	m_dists.clear();
+	m_cpParams.clear();
 	m_cars.clear();
+	m_ranking.clear();
 
 	m_initd = false;
 }
@@ -255,116 +316,133 @@ void Progress::removeCar(const Car &p_car)
 
 	G_ASSERT(itor != m_impl->m_cars.end());
 
+	// remove from ranking and move cars behind one place up
+	const int rank = itor->second->m_rank;
+	ProgressImpl::TRankingList &ranking = m_impl->m_ranking;
+
+	ranking.erase(ranking.begin() + rank);
+
+	const int carCount = static_cast<signed>(ranking.size());
+	for (int i = rank; i < carCount; ++i) {
+		ranking[i]->m_rank = i;
+	}
+
 	delete itor->second;
 	m_impl->m_cars.erase(itor);
 }
 
 void Progress::update()
 {
-	static const int FAR_LIMIT = 400;
-
-	// localize closest checkpoint for each car
 	ProgressImpl::TCarProgressPair pair;
 
 	foreach (pair, m_impl->m_cars) {
-		const Checkpoint &nextCp =
-				m_impl->closestCheckpoint(pair.first->getPosition());
-
-		ProgressInfo &info = *m_impl->m_cars[pair.first];
-
-		if (nextCp.getIndex() == info.m_cp.getIndex() + 1) {
-			// accept if this is next checkpoint
-			info.m_cp = nextCp;
-		} else {
-			// if this is much further then accept only if its position
-			// is close enough
-			if (m_impl->distance(info.m_cp, nextCp) <= FAR_LIMIT) {
-
-				if (nextCp.getIndex() < info.m_cp.getIndex()) {
-					// this can be a new lap
-					// check only if start line is passed
-					if (m_impl->startLinePassed(pair.first)) {
-						++info.m_lapNum;
-						info.m_times.push_back(CL_System::get_time());
-						info.m_cp = nextCp;
-					}
-
-					// no checkpoint assignment here
-
-				} else {
-					info.m_cp = nextCp;
-				}
-			}
-		}
-
+		m_impl->updateCar(*pair.second);
 	}
+
+	m_impl->updateRanking();
 }
 
-const Checkpoint &ProgressImpl::closestCheckpoint(const CL_Pointf &p_pos) const
+void ProgressImpl::updateCar(ProgressInfo &p_info)
 {
-	G_ASSERT(m_chkpts.size() > 0);
+	// minimal movement along the track to change wrong way state
+	static const float WRONG_WAY_DELTA = 0.5f;
 
-	float dist, ndist;
-	const Checkpoint *tcp;
-	bool first = true;
+	const Centreline &line = centreline();
+	const float length = line.getLength();
 
-	foreach (const Checkpoint &cp, m_chkpts) {
+	const bool located = p_info.m_segIdx != -1;
+	const float param =
+			line.project(p_info.m_car->getPosition(), &p_info.m_segIdx);
 
-		ndist = distPow(cp.getPosition(), p_pos);
+	if (located) {
+		float delta = param - p_info.m_param;
 
-		if (!first) {
-			if (ndist < dist) {
-				dist = ndist;
-				tcp = &cp;
-			}
-		} else {
-			dist = ndist;
-			tcp = &cp;
-			first = false;
+		// start line crossed (forward or backward)
+		if (delta < -length / 2) {
+			delta += length;
+		} else if (delta > length / 2) {
+			delta -= length;
+		}
+
+		p_info.m_distance += delta;
+
+		if (delta <= -WRONG_WAY_DELTA) {
+			p_info.m_wrongWay = true;
+		} else if (delta >= WRONG_WAY_DELTA) {
+			p_info.m_wrongWay = false;
 		}
+
+	} else {
+		// cars are placed behind the start line
+		p_info.m_distance = param > length / 2 ? param - length : param;
 	}
 
-	return *tcp;
+	p_info.m_param = param;
+
+	// car records the exact crossing moment within its physics step
+	const unsigned crossCount = p_info.m_car->getStartLineCrossCount();
+
+	if (crossCount != p_info.m_crossCount) {
+		p_info.m_laps.addCrossing(
+				p_info.m_distance,
+				p_info.m_car->getStartLineCrossTime()
+		);
+
+		p_info.m_crossCount = crossCount;
+	}
+
+	// lap is finished when driven distance reaches full track length
+	p_info.m_laps.update(
+			p_info.m_distance,
+			static_cast<float>(p_info.m_car->getIterationCount())
+	);
+
+	p_info.m_cp = m_chkpts[checkpointAt(param, p_info.m_cp.getIndex())];
 }
 
-int ProgressImpl::distance(
-		const Checkpoint &p_from,
-		const Checkpoint &p_to
-) const
+int ProgressImpl::checkpointAt(float p_param, int p_hintIdx) const
 {
-	const int fromIdx = p_from.getIndex();
-	const int toIdx = p_to.getIndex();
+	const int count = static_cast<signed>(m_cpParams.size());
 
-	int sum = 0;
-	const int distsCount = m_dists.size();
+	// walking is slow only when crossing the start line
+	if (fabs(p_param - m_cpParams[p_hintIdx]) > centreline().getLength() / 2) {
+		TCheckpointParams::const_iterator itor =
+				std::upper_bound(m_cpParams.begin(), m_cpParams.end(), p_param);
 
-	for (int i = fromIdx; i != toIdx;) {
+		return static_cast<signed>(itor - m_cpParams.begin()) - 1;
+	}
 
-		sum += m_dists[i];
+	int idx = p_hintIdx;
 
-		if (i + 1 < distsCount) {
-			++i;
-		} else {
-			i = 0;
-		}
+	while (idx + 1 < count && m_cpParams[idx + 1] <= p_param) {
+		++idx;
+	}
+
+	while (idx > 0 && m_cpParams[idx] > p_param) {
+		--idx;
 	}
 
-	return sum;
+	return idx;
 }
 
-bool ProgressImpl::startLinePassed(const Car *p_car)
+void ProgressImpl::updateRanking()
 {
-	const Race::TrackTriangulator &tri = m_level.getTrackTriangulator();
-	const CL_Pointf &r = tri.getFirstRightPoint(0);
-	const CL_Pointf &l = tri.getFirstLeftPoint(0);
-
-	const CL_LineSegment2f sline(r, l);
+	// Insertion sort. Cars change places rarely, so between two updates
+	// the ranking is almost sorted and only few adjacent swaps are needed.
+	const int carCount = static_cast<signed>(m_ranking.size());
+
+	for (int i = 1; i < carCount; ++i) {
+		ProgressInfo *info = m_ranking[i];
+
+		int j = i;
+		while (j > 0 && m_ranking[j - 1]->m_distance < info->m_distance) {
+			m_ranking[j] = m_ranking[j - 1];
+			m_ranking[j]->m_rank = j;
+			--j;
+		}
 
-	if (sline.point_right_of_line(p_car->getPosition()) >= 0.0f) {
-		return true;
-	} else {
-		// TODO: do more accurate check
-		return false;
+		m_ranking[j] = info;
+		info->m_rank = j;
 	}
 }
 
@@ -379,7 +457,7 @@ int Progress::getLapNumber(const Car &p_car) const
 
 	G_ASSERT(itor != m_impl->m_cars.end());
 
-	return itor->second->m_lapNum;
+	return itor->second->m_laps.getLapNumber();
 }
 
 int Progress::getLapTime(const Car &p_car, int p_lap) const
@@ -398,23 +476,25 @@ int Progress::getLapTime(const Car &p_car, int p_lap) const
 	const ProgressInfo &info = *itor->second;
 
 	// get lap time
-	G_ASSERT(info.m_lapNum >= p_lap && "lap not reached yet");
+	const int lapNum = info.m_laps.getLapNumber();
+	G_ASSERT(lapNum >= p_lap && "lap not reached yet");
 
-	unsigned from, to;
+	float from, to;
 
-	if (p_lap != info.m_lapNum) {
-		to = info.m_times[p_lap - 1];
+	if (p_lap != lapNum) {
+		to = info.m_laps.getFinishTime(p_lap);
 	} else {
-		to = CL_System::get_time();
+		to = static_cast<float>(info.m_car->getIterationCount());
 	}
 
 	if (p_lap != 1) {
-		from = info.m_times[p_lap - 2];
+		from = info.m_laps.getFinishTime(p_lap - 1);
 	} else {
-		from = m_impl->m_clock;
+		from = static_cast<float>(info.m_startIter);
 	}
 
-	return static_cast<signed>(to - from);
+	// iterations to milliseconds
+	return static_cast<signed>(floor((to - from) * Car::ITERATION_TIME + 0.5f));
 }
 
 const Checkpoint &Progress::getCheckpoint(const Car &p_car) const
@@ -438,6 +518,61 @@ const Checkpoint &Progress::getCheckpoint(int p_idx) const
 	return m_impl->m_chkpts[p_idx];
 }
 
+float Progress::getLapDistance(const Car &p_car) const
+{
+	G_ASSERT(m_impl->m_initd);
+
+	ProgressImpl::TCarProgressMap::const_iterator itor =
+			m_impl->m_cars.find(&p_car);
+
+	G_ASSERT(itor != m_impl->m_cars.end());
+
+	return itor->second->m_param;
+}
+
+float Progress::getTrackLength() const
+{
+	G_ASSERT(m_impl->m_initd);
+	return m_impl->centreline().getLength();
+}
+
+bool Progress::isWrongWay(const Car &p_car) const
+{
+	G_ASSERT(m_impl->m_initd);
+
+	ProgressImpl::TCarProgressMap::const_iterator itor =
+			m_impl->m_cars.find(&p_car);
+
+	G_ASSERT(itor != m_impl->m_cars.end());
+
+	return itor->second->m_wrongWay;
+}
+
+int Progress::getRacePosition(const Car &p_car) const
+{
+	G_ASSERT(m_impl->m_initd);
+
+	ProgressImpl::TCarProgressMap::const_iterator itor =
+			m_impl->m_cars.find(&p_car);
+
+	G_ASSERT(itor != m_impl->m_cars.end());
+
+	return itor->second->m_rank + 1;
+}
+
+const Car &Progress::getCarAtPosition(int p_pos) const
+{
+	G_ASSERT(m_impl->m_initd);
+	G_ASSERT(p_pos >= 1 && p_pos <= getCarCount());
+
+	return *m_impl->m_ranking[p_pos - 1]->m_car;
+}
+
+int Progress::getCarCount() const
+{
+	return static_cast<signed>(m_impl->m_ranking.size());
+}
+
 int Progress::getCheckpointCount() const
 {
 	G_ASSERT(m_impl->m_initd);
@@ -53,28 +53,61 @@ class Progress
 
 		void destroy();
 
+		/**
+		 * @param p_pos Race position starting from 1.
+		 * @return Car that is currently on <code>p_pos</code> place.
+		 */
+		const Car &getCarAtPosition(int p_pos) const;
+
+		/** @return Number of cars in progress tracking */
+		int getCarCount() const;
+
 		const Checkpoint &getCheckpoint(const Car &p_car) const;
 
 		const Checkpoint &getCheckpoint(int p_idx) const;
 
 		int getCheckpointCount() const;
 
+		/**
+		 * Provides exact position of car on the track.
+		 *
+		 * @return Distance from start line along the track centreline.
+		 */
+		float getLapDistance(const Car &p_car) const;
+
 		int getLapNumber(const Car &p_car) const;
 
 		/**
 		 * Provides lap time in milliseconds. If lap isn't
 		 * finished yet, then ongoing time is returned.
+		 * Time is measured in car physics iterations, so it
+		 * doesn't depend on frame rate.
 		 *
 		 * @return lap time in milliseconds
 		 */
 		int getLapTime(const Car &p_car, int p_lap) const;
 
+		/**
+		 * Provides current race position based on lap number and
+		 * distance driven along the track.
+		 *
+		 * @return race position starting from 1
+		 */
+		int getRacePosition(const Car &p_car) const;
+
+		/** @return Length of one lap in world units */
+		float getTrackLength() const;
+
 		void initialize();
 
+		/** @return true if car is driving in wrong direction */
+		bool isWrongWay(const Car &p_car) const;
+
 		void removeCar(const Car &p_car);
 
 		void reset(const Car &p_car);
 
+		/** Marks race start at current iteration count of each car */
 		void resetClock();
 
 		void update();
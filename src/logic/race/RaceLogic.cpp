@@ -31,7 +31,10 @@
 #include "common/Collections.h"
 #include "common/Game.h"
 #include "common/Player.h"
+#include "logic/race/LevelLoader.h"
 #include "logic/race/Progress.h"
+#include "logic/race/level/BoundTree.h"
+#include "logic/race/level/ChunkGrid.h"
 #include "logic/race/level/Object.h"
 
 namespace Race {
@@ -46,6 +49,7 @@ class RaceLogicImpl
 
 		// signals
 		SIG_IMPL(RaceLogic, stateChanged);
+		SIG_IMPL(RaceLogic, loadProgressChanged);
 
 
 		/** The level */
@@ -82,6 +86,27 @@ class RaceLogicImpl
 		/** Message board to display game messages */
 		MessageBoard m_messageBoard;
 
+		/** Set when level and progress are loaded */
+		bool m_ready;
+
+		/** Set when level loading has failed */
+		bool m_loadFailed;
+
+		/** Bound query result, kept to not allocate every frame */
+		std::vector<int> m_boundQuery;
+
+		/** Chunk query result, kept to not allocate every frame */
+		std::vector<int> m_chunkQuery;
+
+		/** Slots container */
+		CL_SlotContainer m_slots;
+
+		/**
+		 * Background level loader. Declared last, so it is destroyed
+		 * (and joined) before the level and progress.
+		 */
+		LevelLoader m_loader;
+
 
 
 		RaceLogicImpl(const Race::Level &p_level) :
@@ -90,7 +115,9 @@ class RaceLogicImpl
 			m_raceStartTimeMs(0),
 			m_raceFinishTimeMs(0),
 			m_lapCount(0),
-			m_state(S_STANDBY)
+			m_state(S_STANDBY),
+			m_ready(false),
+			m_loadFailed(false)
 		{ /* empty */ }
 
 
@@ -102,6 +129,8 @@ class RaceLogicImpl
 
 		void updateCollisions();
 
+		void updateBoundCollisions();
+
 		void updateCarPhysics(unsigned p_timeElapsed);
 
 		void updatePlayersProgress();
@@ -110,16 +139,23 @@ class RaceLogicImpl
 };
 
 SIG_CPP(RaceLogic, stateChanged);
+SIG_CPP(RaceLogic, loadProgressChanged);
 
 RaceLogic::RaceLogic() :
 	m_impl(new RaceLogicImpl(Race::Level()))
 {
+	m_impl->m_slots.connect(m_impl->m_loader.sig_finished(), this, &RaceLogic::onLoaderFinished);
+	m_impl->m_slots.connect(m_impl->m_loader.sig_progressChanged(), this, &RaceLogic::onLoaderProgress);
+
 	display(_("Game loaded"));
 }
 
 RaceLogic::RaceLogic(const Race::Level &p_level) :
 	m_impl(new RaceLogicImpl(p_level))
 {
+	m_impl->m_slots.connect(m_impl->m_loader.sig_finished(), this, &RaceLogic::onLoaderFinished);
+	m_impl->m_slots.connect(m_impl->m_loader.sig_progressChanged(), this, &RaceLogic::onLoaderProgress);
+
 	display(_("Game loaded"));
 }
 
@@ -130,7 +166,14 @@ RaceLogic::~RaceLogic()
 
 void RaceLogic::update(unsigned p_timeElapsed)
 {
+	if (!m_impl->m_ready) {
+		// nothing to simulate until level is here
+		m_impl->m_loader.update();
+		return;
+	}
+
 	m_impl->updateState();
+	m_impl->updateBoundCollisions();
 	m_impl->updateCollisions();
 	m_impl->updateCarPhysics(p_timeElapsed);
 	m_impl->updatePlayersProgress();
@@ -148,45 +191,56 @@ void RaceLogicImpl::updateState()
 
 void RaceLogicImpl::updateCollisions()
 {
-	const int objCount = m_level.getObjectCount();
+	static const int MAX_CONTACTS = 16;
+
+	const ChunkGrid &chunks = m_level.getChunks();
 	const int carCount = m_level.getCarCount();
 
+	CL_Pointf corners[4];
+	CL_LineSegment2f contacts[MAX_CONTACTS];
+
 	for (int carIdx = 0; carIdx < carCount; ++carIdx) {
 		Race::Car &car = m_level.getCar(carIdx);
+		car.getCorners(corners);
 
-		// FIXME: can this be given by reference?
-		const CL_CollisionOutline carOutline = car.getCollisionOutline();
-
-		for (int objIdx = 0; objIdx < objCount; ++objIdx) {
-			const Race::Object &obj = m_level.getObject(objIdx);
+		// only objects from chunks around the car
+		chunks.query(car.getBounds(), &m_chunkQuery);
 
-			// check collision with car
-			const std::vector<CL_CollidingContours> &cont =
-					obj.collide(carOutline);
+		foreach (int chunkIdx, m_chunkQuery) {
+			const int *objects = chunks.getObjects(chunkIdx);
+			const int objCount = chunks.getObjectCount(chunkIdx);
 
-			// if there are collisions then proceed the segments
-			const int contCount = cont.size();
-			for (int contIdx = 0; contIdx < contCount; ++contIdx) {
+			for (int objIdx = 0; objIdx < objCount; ++objIdx) {
+				const Race::Object &obj = m_level.getObject(objects[objIdx]);
 
-				const CL_CollidingContours &cc = cont[contIdx];
+				// check collision with car and proceed touched segments
+				const int contactCount =
+						obj.collide(corners, 4, contacts, MAX_CONTACTS);
 
-				const int ccCount = static_cast<signed>(cc.points.size());
-				for (int ccIdx = 0; ccIdx < ccCount; ++ccIdx) {
-					const CL_CollisionPoint &pt = cc.points[ccIdx];
-
-					const std::vector<CL_Pointf> &c1pts =
-							cc.contour1->get_points();
+				for (int i = 0; i < contactCount; ++i) {
+					car.applyCollision(contacts[i]);
+				}
+			}
+		}
+	}
+}
 
-					CL_LineSegment2f seg(
-							c1pts[pt.contour1_line_start],
-							c1pts[pt.contour1_line_end]
-					);
+void RaceLogicImpl::updateBoundCollisions()
+{
+	const BoundTree &bounds = m_level.getBoundTree();
+	const int carCount = m_level.getCarCount();
 
-					car.applyCollision(seg);
+	for (int carIdx = 0; carIdx < carCount; ++carIdx) {
+		Race::Car &car = m_level.getCar(carIdx);
 
-				}
+		// only walls near the car
+		bounds.query(car.getBounds(), &m_boundQuery);
 
+		foreach (int segIdx, m_boundQuery) {
+			const CL_LineSegment2f &seg = bounds.getSegment(segIdx);
 
+			if (car.collides(seg)) {
+				car.applyCollision(seg);
 			}
 		}
 	}
@@ -390,6 +444,56 @@ unsigned RaceLogic::getRaceFinishTime() const
 	return m_impl->m_raceFinishTimeMs;
 }
 
+void RaceLogic::loadLevel(const CL_String &p_filename)
+{
+	G_ASSERT(!m_impl->m_ready && "level is already loaded");
+
+	m_impl->m_loadFailed = false;
+	m_impl->m_loader.start(&m_impl->m_level, &m_impl->m_progress, p_filename);
+}
+
+void RaceLogic::cancelLevel()
+{
+	m_impl->m_loader.cancel();
+}
+
+void RaceLogic::onLoaderProgress(float p_progress)
+{
+	m_impl->INVOKE_1(loadProgressChanged, p_progress);
+}
+
+void RaceLogic::onLoaderFinished(bool p_succeeded)
+{
+	m_impl->m_ready = p_succeeded;
+	m_impl->m_loadFailed = !p_succeeded;
+
+	if (!p_succeeded) {
+		display(_("Cannot load level"));
+	}
+
+	onLevelLoaded(p_succeeded);
+}
+
+void RaceLogic::onLevelLoaded(bool p_succeeded)
+{
+	// empty
+}
+
+float RaceLogic::getLoadProgress() const
+{
+	return m_impl->m_loader.getProgress();
+}
+
+bool RaceLogic::isReady() const
+{
+	return m_impl->m_ready;
+}
+
+bool RaceLogic::hasLoadFailed() const
+{
+	return m_impl->m_loadFailed;
+}
+
 Level &RaceLogic::getLevel()
 {
 	return m_impl->m_level;
@@ -69,6 +69,9 @@ class RaceLogic {
 	 */
 	SIG_H_2(stateChanged, RaceState, RaceState);
 
+	/** Invoked with level loading progress from 0.0 to 1.0 */
+	SIG_H_1(loadProgressChanged, float);
+
 	public:
 
 		typedef std::list<Player*> TPlayerList;
@@ -106,6 +109,18 @@ class RaceLogic {
 
 		int getPlayerCount() const;
 
+		/** @return Level loading progress from 0.0 to 1.0 */
+		float getLoadProgress() const;
+
+		/**
+		 * @return true if level and progress are loaded. Until then
+		 * level must not be read and race is not updated.
+		 */
+		bool isReady() const;
+
+		/** @return true if the last level loading has failed */
+		bool hasLoadFailed() const;
+
 		/**
 		 * Begins the race at <code>p_startTimeMs</code>.
 		 *
@@ -166,6 +181,20 @@ class RaceLogic {
 
 		void display(const CL_String &p_message);
 
+		/**
+		 * Starts loading of level and progress on a background thread.
+		 * When done, onLevelLoaded() will be called from update().
+		 * If level is usable already, then only resistance and progress
+		 * are rebuilt.
+		 */
+		void loadLevel(const CL_String &p_filename);
+
+		/** Invoked from update() when level loading is done */
+		virtual void onLevelLoaded(bool p_succeeded);
+
+		/** Stops background loading and waits for the worker. Call it before destroy. */
+		void cancelLevel();
+
 		Player &getPlayer(int p_index);
 
 		Player &getPlayer(const CL_String& p_name);
@@ -178,6 +207,11 @@ class RaceLogic {
 
 		CL_SharedPtr<RaceLogicImpl> m_impl;
 
+
+		void onLoaderFinished(bool p_succeeded);
+
+		void onLoaderProgress(float p_progress);
+
 };
 
 } // namespace
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BoundTree.h"
+
+#include <algorithm>
+
+#include "common.h"
+#include "math/Rect.h"
+
+namespace Race
+{
+
+/** Tree node. Children of inner node are stored at next index and at m_right. */
+struct BoundNode
+{
+	/** Bounds of all segments below */
+	CL_Rectf m_bounds;
+
+	/** Index of right child (inner node) */
+	int m_right;
+
+	/** First segment in ordered list (leaf) */
+	int m_first;
+
+	/** Segment count or 0 if this is an inner node */
+	int m_count;
+};
+
+class BoundTreeImpl
+{
+	public:
+
+		/** Maximal segment count in a leaf */
+		static const int LEAF_SIZE = 4;
+
+		/** Enough for trees of any size that can be balanced by median split */
+		static const int MAX_DEPTH = 64;
+
+
+		/** Segments ordered so every leaf has continuous range */
+		std::vector<CL_LineSegment2f> m_segments;
+
+		/** Bounds of segments in the same order */
+		std::vector<CL_Rectf> m_segBounds;
+
+		/** Nodes in depth first order */
+		std::vector<BoundNode> m_nodes;
+
+
+		/** Builds node from [p_begin, p_end) segment range */
+		void buildNode(
+				std::vector<int> &p_order,
+				const std::vector<CL_Rectf> &p_bounds,
+				int p_begin, int p_end
+		);
+};
+
+/** Orders segment indexes by bounding box centre on one axis */
+class BoundCentreLess
+{
+	public:
+
+		BoundCentreLess(const std::vector<CL_Rectf> &p_bounds, bool p_xAxis) :
+			m_bounds(p_bounds),
+			m_xAxis(p_xAxis)
+		{ /* empty */ }
+
+		bool operator()(int p_a, int p_b) const
+		{
+			const CL_Rectf &a = m_bounds[p_a];
+			const CL_Rectf &b = m_bounds[p_b];
+
+			return m_xAxis ?
+					a.left + a.right < b.left + b.right :
+					a.top + a.bottom < b.top + b.bottom;
+		}
+
+	private:
+
+		const std::vector<CL_Rectf> &m_bounds;
+
+		bool m_xAxis;
+};
+
+BoundTree::BoundTree() :
+	m_impl(new BoundTreeImpl())
+{
+	// empty
+}
+
+BoundTree::~BoundTree()
+{
+	// empty
+}
+
+void BoundTree::clear()
+{
+	m_impl->m_segments.clear();
+	m_impl->m_segBounds.clear();
+	m_impl->m_nodes.clear();
+}
+
+void BoundTree::build(const std::vector<CL_LineSegment2f> &p_segments)
+{
+	clear();
+
+	const int count = static_cast<signed>(p_segments.size());
+
+	if (count == 0) {
+		return;
+	}
+
+	std::vector<CL_Rectf> bounds;
+	std::vector<int> order;
+
+	bounds.reserve(count);
+	order.reserve(count);
+
+	for (int i = 0; i < count; ++i) {
+		const CL_LineSegment2f &seg = p_segments[i];
+
+		bounds.push_back(
+				CL_Rectf(
+						std::min(seg.p.x, seg.q.x), std::min(seg.p.y, seg.q.y),
+						std::max(seg.p.x, seg.q.x), std::max(seg.p.y, seg.q.y)
+				)
+		);
+
+		order.push_back(i);
+	}
+
+	// full binary tree with leaves of at least half size
+	m_impl->m_nodes.reserve(2 * (count / (BoundTreeImpl::LEAF_SIZE / 2) + 1));
+	m_impl->buildNode(order, bounds, 0, count);
+
+	// store segments in leaf order
+	m_impl->m_segments.reserve(count);
+	m_impl->m_segBounds.reserve(count);
+
+	foreach (int idx, order) {
+		m_impl->m_segments.push_back(p_segments[idx]);
+		m_impl->m_segBounds.push_back(bounds[idx]);
+	}
+
+	cl_log_event(
+			LOG_DEBUG,
+			"bound tree built: %1 segments, %2 nodes",
+			count, m_impl->m_nodes.size()
+	);
+}
+
+void BoundTreeImpl::buildNode(
+		std::vector<int> &p_order,
+		const std::vector<CL_Rectf> &p_bounds,
+		int p_begin, int p_end
+)
+{
+	const int nodeIdx = static_cast<signed>(m_nodes.size());
+	m_nodes.push_back(BoundNode());
+
+	CL_Rectf bounds = p_bounds[p_order[p_begin]];
+
+	for (int i = p_begin + 1; i < p_end; ++i) {
+		bounds.bounding_rect(p_bounds[p_order[i]]);
+	}
+
+	m_nodes[nodeIdx].m_bounds = bounds;
+
+	if (p_end - p_begin <= LEAF_SIZE) {
+		m_nodes[nodeIdx].m_right = -1;
+		m_nodes[nodeIdx].m_first = p_begin;
+		m_nodes[nodeIdx].m_count = p_end - p_begin;
+		return;
+	}
+
+	// split at median of the longer axis
+	const bool xAxis = bounds.get_width() >= bounds.get_height();
+	const int mid = (p_begin + p_end) / 2;
+
+	std::nth_element(
+			p_order.begin() + p_begin,
+			p_order.begin() + mid,
+			p_order.begin() + p_end,
+			BoundCentreLess(p_bounds, xAxis)
+	);
+
+	buildNode(p_order, p_bounds, p_begin, mid);
+
+	const int right = static_cast<signed>(m_nodes.size());
+	buildNode(p_order, p_bounds, mid, p_end);
+
+	m_nodes[nodeIdx].m_right = right;
+	m_nodes[nodeIdx].m_first = 0;
+	m_nodes[nodeIdx].m_count = 0;
+}
+
+void BoundTree::query(const CL_Rectf &p_rect, std::vector<int> *p_result) const
+{
+	G_ASSERT(p_result);
+	p_result->clear();
+
+	if (m_impl->m_nodes.empty()) {
+		return;
+	}
+
+	int stack[BoundTreeImpl::MAX_DEPTH];
+	int top = 0;
+
+	stack[top++] = 0;
+
+	while (top > 0) {
+		const BoundNode &node = m_impl->m_nodes[stack[--top]];
+
+		if (!Math::Rect::overlaps(node.m_bounds, p_rect)) {
+			continue;
+		}
+
+		if (node.m_count > 0) {
+			const int end = node.m_first + node.m_count;
+
+			for (int i = node.m_first; i < end; ++i) {
+				if (Math::Rect::overlaps(m_impl->m_segBounds[i], p_rect)) {
+					p_result->push_back(i);
+				}
+			}
+		} else {
+			G_ASSERT(top + 2 <= BoundTreeImpl::MAX_DEPTH);
+
+			const int nodeIdx = static_cast<signed>(&node - &m_impl->m_nodes[0]);
+
+			stack[top++] = node.m_right;
+			stack[top++] = nodeIdx + 1;
+		}
+	}
+}
+
+const CL_LineSegment2f &BoundTree::getSegment(int p_idx) const
+{
+	G_ASSERT(p_idx >= 0 && p_idx < getSegmentCount());
+	return m_impl->m_segments[p_idx];
+}
+
+int BoundTree::getSegmentCount() const
+{
+	return static_cast<signed>(m_impl->m_segments.size());
+}
+
+} // namespace
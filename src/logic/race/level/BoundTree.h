@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace Race
+{
+
+class BoundTreeImpl;
+
+/**
+ * Bounding volume hierarchy of track boundary segments.
+ * <p>
+ * Segments are grouped in axis aligned boxes, so only segments near
+ * the queried area are visited. Queries do not allocate memory when
+ * result vector has enough capacity.
+ */
+class BoundTree
+{
+	public:
+
+		BoundTree();
+
+		virtual ~BoundTree();
+
+
+		/** Builds the tree from scratch */
+		void build(const std::vector<CL_LineSegment2f> &p_segments);
+
+		void clear();
+
+
+		const CL_LineSegment2f &getSegment(int p_idx) const;
+
+		int getSegmentCount() const;
+
+		/**
+		 * Finds segments which bounding boxes overlap given rectangle.
+		 *
+		 * @param p_result Cleared and filled with segment indexes.
+		 */
+		void query(const CL_Rectf &p_rect, std::vector<int> *p_result) const;
+
+
+	private:
+
+		CL_SharedPtr<BoundTreeImpl> m_impl;
+};
+
+} // namespace
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Centreline.h"
+
+#include <algorithm>
+
+#include "common.h"
+#include "math/UniformGrid.h"
+
+namespace Race
+{
+
+class CentrelineImpl
+{
+	public:
+
+		/** Grid cell size in screen units */
+		static const int CELL_SIZE = 128;
+
+
+		/** Centreline points */
+		std::vector<CL_Pointf> m_points;
+
+		/**
+		 * Arc length from the first point to each point. Contains one
+		 * more element with total length.
+		 */
+		std::vector<float> m_arcLengths;
+
+		/** Spatial index of segment bounds */
+		Math::UniformGrid m_grid;
+
+
+		void buildGrid();
+
+		/**
+		 * @return Squared distance between position and segment.
+		 * <code>p_t</code> is set to projection factor (0 to 1).
+		 */
+		float segDistPow(int p_segIdx, const CL_Pointf &p_pos, float *p_t) const;
+
+		int closestFromGrid(const CL_Pointf &p_pos) const;
+
+		int segmentCount() const
+		{
+			return static_cast<signed>(m_points.size());
+		}
+
+		const CL_Pointf &segEnd(int p_segIdx) const
+		{
+			return m_points[p_segIdx + 1 < segmentCount() ? p_segIdx + 1 : 0];
+		}
+};
+
+Centreline::Centreline() :
+	m_impl(new CentrelineImpl())
+{
+	// empty
+}
+
+Centreline::~Centreline()
+{
+	// empty
+}
+
+void Centreline::build(const std::vector<CL_Pointf> &p_points)
+{
+	// minimal length of centreline segment
+	static const float MIN_SEG_LENGTH = 0.01f;
+
+	clear();
+
+	// skip points that are too close to each other
+	m_impl->m_points.reserve(p_points.size());
+
+	foreach (const CL_Pointf &p, p_points) {
+		if (
+				m_impl->m_points.empty()
+				|| m_impl->m_points.back().distance(p) >= MIN_SEG_LENGTH
+		) {
+			m_impl->m_points.push_back(p);
+		}
+	}
+
+	while (
+			m_impl->m_points.size() > 1
+			&& m_impl->m_points.back().distance(m_impl->m_points.front())
+					< MIN_SEG_LENGTH
+	) {
+		m_impl->m_points.pop_back();
+	}
+
+	if (m_impl->m_points.size() < 2) {
+		m_impl->m_points.clear();
+		return;
+	}
+
+	// calculate arc lengths
+	const int segCount = m_impl->segmentCount();
+	m_impl->m_arcLengths.resize(segCount + 1);
+
+	float len = 0.0f;
+
+	for (int i = 0; i < segCount; ++i) {
+		m_impl->m_arcLengths[i] = len;
+		len += m_impl->m_points[i].distance(m_impl->segEnd(i));
+	}
+
+	m_impl->m_arcLengths[segCount] = len;
+
+	m_impl->buildGrid();
+}
+
+void CentrelineImpl::buildGrid()
+{
+	const int segCount = segmentCount();
+
+	std::vector<CL_Rectf> bounds(segCount);
+
+	for (int i = 0; i < segCount; ++i) {
+		const CL_Pointf &a = m_points[i];
+		const CL_Pointf &b = segEnd(i);
+
+		bounds[i] = CL_Rectf(
+				std::min(a.x, b.x), std::min(a.y, b.y),
+				std::max(a.x, b.x), std::max(a.y, b.y)
+		);
+	}
+
+	m_grid.build(bounds, CELL_SIZE);
+}
+
+void Centreline::clear()
+{
+	m_impl->m_points.clear();
+	m_impl->m_arcLengths.clear();
+	m_impl->m_grid.clear();
+}
+
+float CentrelineImpl::segDistPow(
+		int p_segIdx,
+		const CL_Pointf &p_pos,
+		float *p_t
+) const
+{
+	const CL_Pointf &a = m_points[p_segIdx];
+	const CL_Pointf &b = segEnd(p_segIdx);
+
+	const CL_Vec2f ab = b - a;
+	const CL_Vec2f ap = p_pos - a;
+
+	float t = ap.dot(ab) / ab.dot(ab);
+
+	if (t < 0.0f) {
+		t = 0.0f;
+	} else if (t > 1.0f) {
+		t = 1.0f;
+	}
+
+	const float dx = a.x + ab.x * t - p_pos.x;
+	const float dy = a.y + ab.y * t - p_pos.y;
+
+	*p_t = t;
+	return dx * dx + dy * dy;
+}
+
+/** Squared distance from fixed position to centreline segment */
+class SegmentDistance
+{
+	public:
+
+		SegmentDistance(const CentrelineImpl &p_line, const CL_Pointf &p_pos) :
+			m_line(p_line),
+			m_pos(p_pos)
+		{ /* empty */ }
+
+		float operator()(int p_segIdx) const
+		{
+			float t;
+			return m_line.segDistPow(p_segIdx, m_pos, &t);
+		}
+
+	private:
+
+		const CentrelineImpl &m_line;
+
+		const CL_Pointf &m_pos;
+};
+
+int CentrelineImpl::closestFromGrid(const CL_Pointf &p_pos) const
+{
+	const int best = m_grid.closest(p_pos, SegmentDistance(*this, p_pos));
+
+	G_ASSERT(best != -1);
+	return best;
+}
+
+float Centreline::project(const CL_Pointf &p_pos, int *p_segIdx) const
+{
+	G_ASSERT(!isEmpty() && "centreline not built");
+
+	// segments to check in each direction from hint
+	static const int WINDOW = 16;
+
+	// if nearest segment is farther than this, then hint is not valid
+	static const float LOST_DISTANCE = 400.0f;
+
+	const int segCount = m_impl->segmentCount();
+	const int hint = *p_segIdx;
+
+	int best = -1;
+	float dist = 0.0f, ndist, t;
+
+	if (hint >= 0 && hint < segCount && segCount > WINDOW * 2 + 1) {
+		int bestOffset = 0, idx;
+
+		for (int off = -WINDOW; off <= WINDOW; ++off) {
+			idx = (hint + off + segCount) % segCount;
+			ndist = m_impl->segDistPow(idx, p_pos, &t);
+
+			if (best == -1 || ndist < dist) {
+				dist = ndist;
+				best = idx;
+				bestOffset = off;
+			}
+		}
+
+		// closest on window edge can mean that real closest is outside
+		if (
+				bestOffset == -WINDOW || bestOffset == WINDOW
+				|| dist > LOST_DISTANCE * LOST_DISTANCE
+		) {
+			best = -1;
+		}
+	}
+
+	if (best == -1) {
+		best = m_impl->closestFromGrid(p_pos);
+	}
+
+	m_impl->segDistPow(best, p_pos, &t);
+	*p_segIdx = best;
+
+	const float segStart = m_impl->m_arcLengths[best];
+	const float segLength = m_impl->m_arcLengths[best + 1] - segStart;
+
+	return segStart + segLength * t;
+}
+
+float Centreline::getLength() const
+{
+	return m_impl->m_arcLengths.empty() ? 0.0f : m_impl->m_arcLengths.back();
+}
+
+const CL_Pointf &Centreline::getPoint(int p_segIdx) const
+{
+	G_ASSERT(p_segIdx >= 0 && p_segIdx < getSegmentCount());
+	return m_impl->m_points[p_segIdx];
+}
+
+CL_Vec2f Centreline::getDirection(int p_segIdx) const
+{
+	G_ASSERT(p_segIdx >= 0 && p_segIdx < getSegmentCount());
+
+	CL_Vec2f dir =
+			m_impl->segEnd(p_segIdx) - m_impl->m_points[p_segIdx];
+
+	dir.normalize();
+	return dir;
+}
+
+int Centreline::getSegmentCount() const
+{
+	return m_impl->segmentCount();
+}
+
+bool Centreline::isEmpty() const
+{
+	return m_impl->m_points.empty();
+}
+
+} // namespace
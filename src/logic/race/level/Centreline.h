@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace Race
+{
+
+class CentrelineImpl;
+
+/**
+ * Closed polyline that goes through the middle of the track. It is
+ * parameterized by arc length, so each point on the track can be described
+ * by single distance from the start line.
+ * <p>
+ * Centreline segments are indexed by spatial grid, so any position can
+ * be projected on it without checking all the segments.
+ */
+class Centreline
+{
+	public:
+
+		Centreline();
+
+		virtual ~Centreline();
+
+
+		/**
+		 * Builds the centreline from given points. The last point is
+		 * connected with the first one.
+		 */
+		void build(const std::vector<CL_Pointf> &p_points);
+
+		void clear();
+
+
+		/** @return Total length of centreline in world units */
+		float getLength() const;
+
+		/** @return Beginning of selected segment */
+		const CL_Pointf &getPoint(int p_segIdx) const;
+
+		/** @return Normalized forward direction of selected segment */
+		CL_Vec2f getDirection(int p_segIdx) const;
+
+		int getSegmentCount() const;
+
+		bool isEmpty() const;
+
+		/**
+		 * Projects the position on the nearest centreline segment.
+		 * <p>
+		 * If <code>p_segIdx</code> points to valid segment, then search
+		 * begins there and checks only few neighbours. Otherwise (or when
+		 * position is too far) the spatial index is used.
+		 *
+		 * @param p_pos Position to project.
+		 * @param p_segIdx Segment hint. Set to found segment on return.
+		 * @return Distance from centreline beginning (0 to length).
+		 */
+		float project(const CL_Pointf &p_pos, int *p_segIdx) const;
+
+
+	private:
+
+		CL_SharedPtr<CentrelineImpl> m_impl;
+};
+
+} // namespace
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ChunkGrid.h"
+
+#include <map>
+#include <math.h>
+
+#include "common.h"
+#include "math/UniformGrid.h"
+
+namespace Race
+{
+
+/** Content ranges of a non-empty chunk */
+struct Chunk
+{
+	/** Range in segment index list */
+	int m_segBegin, m_segCount;
+
+	/** Range in object index list */
+	int m_objBegin, m_objCount;
+};
+
+class ChunkGridImpl
+{
+	public:
+
+		/** Row and column of a chunk cell */
+		typedef std::pair<int, int> TCell;
+
+
+		float m_chunkSize;
+
+		std::vector<Chunk> m_chunks;
+
+		/** Segment and object indexes ordered by chunk */
+		std::vector<int> m_segments, m_objects;
+
+		/** Bounds of all content of each chunk */
+		Math::UniformGrid m_index;
+
+		unsigned m_revision;
+
+
+		ChunkGridImpl() :
+			m_chunkSize(1.0f),
+			m_revision(0)
+		{ /* empty */ }
+
+
+		/** @return Cell that contains centre of <code>p_bounds</code> */
+		TCell cellOf(const CL_Rectf &p_bounds) const;
+};
+
+ChunkGrid::ChunkGrid() :
+	m_impl(new ChunkGridImpl())
+{
+	// empty
+}
+
+ChunkGrid::~ChunkGrid()
+{
+	// empty
+}
+
+void ChunkGrid::clear()
+{
+	++m_impl->m_revision;
+
+	m_impl->m_chunks.clear();
+	m_impl->m_segments.clear();
+	m_impl->m_objects.clear();
+	m_impl->m_index.clear();
+}
+
+void ChunkGrid::build(
+		const std::vector<CL_Rectf> &p_segmentBounds,
+		const std::vector<CL_Rectf> &p_objectBounds,
+		float p_chunkSize
+)
+{
+	G_ASSERT(p_chunkSize > 0.0f);
+
+	clear();
+
+	m_impl->m_chunkSize = p_chunkSize;
+
+	const int segCount = static_cast<signed>(p_segmentBounds.size());
+	const int objCount = static_cast<signed>(p_objectBounds.size());
+
+	if (segCount + objCount == 0) {
+		return;
+	}
+
+	// number the non-empty cells in row-major order
+	typedef std::map<ChunkGridImpl::TCell, int> TCellMap;
+	TCellMap cells;
+
+	foreach (const CL_Rectf &rect, p_segmentBounds) {
+		cells[m_impl->cellOf(rect)] = 0;
+	}
+
+	foreach (const CL_Rectf &rect, p_objectBounds) {
+		cells[m_impl->cellOf(rect)] = 0;
+	}
+
+	for (TCellMap::iterator itor = cells.begin(); itor != cells.end(); ++itor) {
+		itor->second = static_cast<signed>(m_impl->m_chunks.size());
+
+		Chunk chunk = { 0, 0, 0, 0 };
+		m_impl->m_chunks.push_back(chunk);
+	}
+
+	const int chunkCount = static_cast<signed>(m_impl->m_chunks.size());
+
+	// chunk of every item
+	std::vector<int> segChunks(segCount), objChunks(objCount);
+
+	for (int i = 0; i < segCount; ++i) {
+		segChunks[i] = cells[m_impl->cellOf(p_segmentBounds[i])];
+		++m_impl->m_chunks[segChunks[i]].m_segCount;
+	}
+
+	for (int i = 0; i < objCount; ++i) {
+		objChunks[i] = cells[m_impl->cellOf(p_objectBounds[i])];
+		++m_impl->m_chunks[objChunks[i]].m_objCount;
+	}
+
+	// lay out index lists chunk by chunk
+	int segBegin = 0, objBegin = 0;
+
+	foreach (Chunk &chunk, m_impl->m_chunks) {
+		chunk.m_segBegin = segBegin;
+		chunk.m_objBegin = objBegin;
+
+		segBegin += chunk.m_segCount;
+		objBegin += chunk.m_objCount;
+
+		chunk.m_segCount = chunk.m_objCount = 0;
+	}
+
+	m_impl->m_segments.resize(segCount);
+	m_impl->m_objects.resize(objCount);
+
+	std::vector<CL_Rectf> chunkBounds(chunkCount);
+	std::vector<bool> hasBounds(chunkCount, false);
+
+	for (int i = 0; i < segCount; ++i) {
+		const int chunkIdx = segChunks[i];
+		Chunk &chunk = m_impl->m_chunks[chunkIdx];
+
+		m_impl->m_segments[chunk.m_segBegin + chunk.m_segCount++] = i;
+
+		if (hasBounds[chunkIdx]) {
+			chunkBounds[chunkIdx].bounding_rect(p_segmentBounds[i]);
+		} else {
+			chunkBounds[chunkIdx] = p_segmentBounds[i];
+			hasBounds[chunkIdx] = true;
+		}
+	}
+
+	for (int i = 0; i < objCount; ++i) {
+		const int chunkIdx = objChunks[i];
+		Chunk &chunk = m_impl->m_chunks[chunkIdx];
+
+		m_impl->m_objects[chunk.m_objBegin + chunk.m_objCount++] = i;
+
+		if (hasBounds[chunkIdx]) {
+			chunkBounds[chunkIdx].bounding_rect(p_objectBounds[i]);
+		} else {
+			chunkBounds[chunkIdx] = p_objectBounds[i];
+			hasBounds[chunkIdx] = true;
+		}
+	}
+
+	// chunk reaching far out of its cell is found only where it reaches
+	m_impl->m_index.build(chunkBounds, p_chunkSize);
+
+	cl_log_event(LOG_DEBUG, "chunk grid built: %1 chunks", chunkCount);
+}
+
+ChunkGridImpl::TCell ChunkGridImpl::cellOf(const CL_Rectf &p_bounds) const
+{
+	const float x = (p_bounds.left + p_bounds.right) / 2.0f;
+	const float y = (p_bounds.top + p_bounds.bottom) / 2.0f;
+
+	return TCell(
+			static_cast<int>(floorf(y / m_chunkSize)),
+			static_cast<int>(floorf(x / m_chunkSize))
+	);
+}
+
+unsigned ChunkGrid::getRevision() const
+{
+	return m_impl->m_revision;
+}
+
+int ChunkGrid::getChunkCount() const
+{
+	return static_cast<signed>(m_impl->m_chunks.size());
+}
+
+const CL_Rectf &ChunkGrid::getChunkBounds(int p_chunk) const
+{
+	G_ASSERT(p_chunk >= 0 && p_chunk < getChunkCount());
+	return m_impl->m_index.getBounds(p_chunk);
+}
+
+const int *ChunkGrid::getSegments(int p_chunk) const
+{
+	G_ASSERT(p_chunk >= 0 && p_chunk < getChunkCount());
+	const std::vector<int> &segments = m_impl->m_segments;
+	return segments.empty() ? NULL : &segments[0] + m_impl->m_chunks[p_chunk].m_segBegin;
+}
+
+int ChunkGrid::getSegmentCount(int p_chunk) const
+{
+	G_ASSERT(p_chunk >= 0 && p_chunk < getChunkCount());
+	return m_impl->m_chunks[p_chunk].m_segCount;
+}
+
+const int *ChunkGrid::getObjects(int p_chunk) const
+{
+	G_ASSERT(p_chunk >= 0 && p_chunk < getChunkCount());
+	const std::vector<int> &objects = m_impl->m_objects;
+	return objects.empty() ? NULL : &objects[0] + m_impl->m_chunks[p_chunk].m_objBegin;
+}
+
+int ChunkGrid::getObjectCount(int p_chunk) const
+{
+	G_ASSERT(p_chunk >= 0 && p_chunk < getChunkCount());
+	return m_impl->m_chunks[p_chunk].m_objCount;
+}
+
+void ChunkGrid::query(const CL_Rectf &p_rect, std::vector<int> *p_result) const
+{
+	m_impl->m_index.query(p_rect, p_result);
+}
+
+} // namespace
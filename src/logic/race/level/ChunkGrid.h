@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace Race
+{
+
+class ChunkGridImpl;
+
+/**
+ * Partition of level content into square world-space chunks.
+ * <p>
+ * Every track segment (with the gap to the next one) and every object
+ * belongs to exactly one chunk: the one that contains centre of its
+ * bounds. Chunk bounds cover all of its content, so a query visits only
+ * chunks near the queried area, no matter how long the track is.
+ */
+class ChunkGrid
+{
+	public:
+
+		ChunkGrid();
+
+		virtual ~ChunkGrid();
+
+
+		/**
+		 * Builds the grid from scratch.
+		 *
+		 * @param p_segmentBounds Bounds of each track segment.
+		 * @param p_objectBounds Bounds of each level object.
+		 * @param p_chunkSize Chunk side length (screen units).
+		 */
+		void build(
+				const std::vector<CL_Rectf> &p_segmentBounds,
+				const std::vector<CL_Rectf> &p_objectBounds,
+				float p_chunkSize
+		);
+
+		void clear();
+
+
+		/** @return Number increased on every build() and clear() */
+		unsigned getRevision() const;
+
+		/** @return Number of non-empty chunks */
+		int getChunkCount() const;
+
+		/** @return Bounds of everything that belongs to the chunk */
+		const CL_Rectf &getChunkBounds(int p_chunk) const;
+
+		/** @return Indexes of track segments in the chunk */
+		const int *getSegments(int p_chunk) const;
+
+		int getSegmentCount(int p_chunk) const;
+
+		/** @return Indexes of level objects in the chunk */
+		const int *getObjects(int p_chunk) const;
+
+		int getObjectCount(int p_chunk) const;
+
+		/**
+		 * Finds chunks which bounds overlap given rectangle.
+		 *
+		 * @param p_result Cleared and filled with chunk indexes.
+		 */
+		void query(const CL_Rectf &p_rect, std::vector<int> *p_result) const;
+
+
+	private:
+
+		CL_SharedPtr<ChunkGridImpl> m_impl;
+};
+
+} // namespace
@@ -0,0 +1,681 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CompiledLevel.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // UNIX
+
+#include "logic/race/level/Level.h"
+#include "logic/race/level/Object.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackPoint.h"
+#include "logic/race/level/TrackSegment.h"
+#include "logic/race/level/TrackTriangulator.h"
+
+namespace Race
+{
+
+/** Number of integers in one segment entry (without guide) */
+const int SEGMENT_INTS = 2 * TrackSegment::LOD_COUNT + 2;
+
+/** Written as integer, read back the same only on little-endian machine */
+const unsigned BYTE_ORDER_MARK = 0x01020304;
+
+const char MAGIC[4] = { 'G', 'L', 'E', 'V' };
+
+/** Where automatically compiled levels are kept */
+const char *CACHE_DIRECTORY = "cache/";
+
+
+struct CompiledLevelHeader
+{
+	char m_magic[4];
+	unsigned m_version;
+	unsigned m_byteOrder;
+	unsigned m_sourceHash;
+	unsigned m_lodCount;
+	unsigned m_trackPointCount;
+	unsigned m_segmentCount;
+	unsigned m_triPointCount;
+	unsigned m_midPointCount;
+	unsigned m_prototypeCount;
+	unsigned m_prototypePointCount;
+	unsigned m_objectCount;
+};
+
+class CompiledLevelImpl
+{
+	public:
+
+		/** File contents */
+		const char *m_data;
+
+		int m_size;
+
+#ifdef UNIX
+		/** Memory mapping of file */
+		void *m_map;
+#else
+		/** File is read into this buffer if it cannot be mapped */
+		CL_DataBuffer m_buffer;
+#endif // UNIX
+
+		CompiledLevelHeader m_header;
+
+
+		// sections
+
+		/** x, y, radius, shift of each track point */
+		const float *m_trackPoints;
+
+		/** SEGMENT_INTS integers per segment */
+		const int *m_segments;
+
+		const CL_Vec2f *m_guides;
+
+		const CL_Pointf *m_triPoints;
+
+		const CL_Pointf *m_midPoints;
+
+		/** begin and count of each object prototype */
+		const int *m_prototypes;
+
+		const CL_Pointf *m_prototypePoints;
+
+		/** prototype index of each object */
+		const int *m_objects;
+
+		const CL_Vec2f *m_objectPositions;
+
+
+		CompiledLevelImpl() :
+			m_data(NULL),
+			m_size(0)
+#ifdef UNIX
+			, m_map(NULL)
+#endif // UNIX
+		{ /* empty */ }
+
+		~CompiledLevelImpl()
+		{
+			unmap();
+		}
+
+
+		bool map(const CL_String &p_filename);
+
+		void unmap();
+
+		bool validate();
+
+		/**
+		 * @return true if <code>p_count</code> elements starting at
+		 * <code>p_begin</code> fit in <code>p_total</code> elements
+		 */
+		static bool rangeFits(int p_begin, int p_count, unsigned p_total);
+};
+
+CompiledLevel::CompiledLevel() :
+	m_impl(new CompiledLevelImpl())
+{
+	// empty
+}
+
+CompiledLevel::~CompiledLevel()
+{
+	// empty
+}
+
+CL_String CompiledLevel::getCacheName(const CL_String &p_filename)
+{
+	return CACHE_DIRECTORY + CL_PathHelp::get_basename(p_filename) + ".glev";
+}
+
+CL_String CompiledLevel::getCompiledName(const CL_String &p_filename)
+{
+	if (CL_PathHelp::get_extension(p_filename) == "glev") {
+		return p_filename;
+	}
+
+	return
+			CL_PathHelp::get_basepath(p_filename)
+			+ CL_PathHelp::get_basename(p_filename)
+			+ ".glev";
+}
+
+unsigned CompiledLevel::hashFile(const CL_String &p_filename)
+{
+	// FNV-1a
+	static const unsigned OFFSET_BASIS = 2166136261u;
+	static const unsigned PRIME = 16777619u;
+
+	static const int CHUNK_SIZE = 64 * 1024;
+
+	try {
+		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+		CL_DataBuffer chunk(CHUNK_SIZE);
+
+		unsigned hash = OFFSET_BASIS;
+		int read;
+
+		while ((read = file.read(chunk.get_data(), CHUNK_SIZE)) > 0) {
+			const unsigned char *bytes =
+					reinterpret_cast<const unsigned char*>(chunk.get_data());
+
+			for (int i = 0; i < read; ++i) {
+				hash ^= bytes[i];
+				hash *= PRIME;
+			}
+		}
+
+		file.close();
+
+		// zero means no hash
+		return hash != 0 ? hash : 1;
+
+	} catch (CL_Exception &e) {
+		return 0;
+	}
+}
+
+void CompiledLevel::write(
+		const Level &p_level,
+		unsigned p_sourceHash,
+		const CL_String &p_filename
+)
+{
+	const Track &track = p_level.getTrack();
+	const TrackTriangulator &triang = p_level.getTrackTriangulator();
+
+	const int trackPointCount = track.getPointCount();
+	const int objectCount = p_level.getObjectCount();
+
+	int triPointCount = 0, midPointCount = 0;
+
+	for (int i = 0; i < trackPointCount; ++i) {
+		const TrackSegment &seg = triang.getSegment(i);
+
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			triPointCount += seg.getTrianglePointCount(lod);
+		}
+
+		midPointCount += seg.getMidPointCount();
+	}
+
+	// instances of one prototype are next to each other
+	std::vector<ObjectPrototype> prototypes;
+	std::vector<int> objectPrototypes(objectCount);
+
+	int prototypePointCount = 0;
+
+	for (int i = 0; i < objectCount; ++i) {
+		const ObjectPrototype &proto = p_level.getObject(i).getPrototype();
+
+		if (prototypes.empty() || !(prototypes.back() == proto)) {
+			prototypes.push_back(proto);
+			prototypePointCount += proto.getPointCount();
+		}
+
+		objectPrototypes[i] = static_cast<signed>(prototypes.size()) - 1;
+	}
+
+	const int prototypeCount = static_cast<signed>(prototypes.size());
+
+	// cache directory could not exist yet
+	const CL_String directory = CL_PathHelp::get_basepath(p_filename);
+
+	if (!directory.empty()) {
+		try {
+			CL_Directory::create(directory);
+		} catch (CL_Exception &e) {
+			// already exists
+		}
+	}
+
+	// other processes can have the old file mapped, truncating it under
+	// them would crash them, so a new file replaces the old one
+#ifdef UNIX
+	const CL_String tmpFilename =
+			cl_format("%1.%2.tmp", p_filename, static_cast<int>(getpid()));
+#else
+	const CL_String tmpFilename = p_filename + ".tmp";
+#endif // UNIX
+
+	CL_File file(tmpFilename, CL_File::create_always, CL_File::access_write);
+	file.set_little_endian_mode();
+
+	// header
+	file.write(MAGIC, sizeof(MAGIC));
+	file.write_uint32(VERSION);
+	file.write_uint32(BYTE_ORDER_MARK);
+	file.write_uint32(p_sourceHash);
+	file.write_uint32(TrackSegment::LOD_COUNT);
+	file.write_uint32(trackPointCount);
+	file.write_uint32(trackPointCount);
+	file.write_uint32(triPointCount);
+	file.write_uint32(midPointCount);
+	file.write_uint32(prototypeCount);
+	file.write_uint32(prototypePointCount);
+	file.write_uint32(objectCount);
+
+	// track points
+	for (int i = 0; i < trackPointCount; ++i) {
+		const TrackPoint &point = track.getPoint(i);
+
+		file.write_float(point.getPosition().x);
+		file.write_float(point.getPosition().y);
+		file.write_float(point.getRadius());
+		file.write_float(point.getShift());
+	}
+
+	// segment ranges in the same layout as triangulator arenas
+	int triBegin = 0, midBegin = 0;
+
+	for (int i = 0; i < trackPointCount; ++i) {
+		const TrackSegment &seg = triang.getSegment(i);
+
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			file.write_int32(triBegin);
+			triBegin += seg.getTrianglePointCount(lod);
+		}
+
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			file.write_int32(seg.getTrianglePointCount(lod));
+		}
+
+		file.write_int32(midBegin);
+		file.write_int32(seg.getMidPointCount());
+
+		midBegin += seg.getMidPointCount();
+	}
+
+	for (int i = 0; i < trackPointCount; ++i) {
+		const CL_Vec2f &guide = triang.getGuide(i);
+
+		file.write_float(guide.x);
+		file.write_float(guide.y);
+	}
+
+	// triangle and mid points
+	for (int i = 0; i < trackPointCount; ++i) {
+		const TrackSegment &seg = triang.getSegment(i);
+
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			const CL_Pointf *points = seg.getTrianglePoints(lod);
+			const int count = seg.getTrianglePointCount(lod);
+
+			for (int j = 0; j < count; ++j) {
+				file.write_float(points[j].x);
+				file.write_float(points[j].y);
+			}
+		}
+	}
+
+	for (int i = 0; i < trackPointCount; ++i) {
+		const TrackSegment &seg = triang.getSegment(i);
+
+		const CL_Pointf *points = seg.getMidPoints();
+		const int count = seg.getMidPointCount();
+
+		for (int j = 0; j < count; ++j) {
+			file.write_float(points[j].x);
+			file.write_float(points[j].y);
+		}
+	}
+
+	// object prototypes
+	int prototypeBegin = 0;
+
+	for (int i = 0; i < prototypeCount; ++i) {
+		const int count = prototypes[i].getPointCount();
+
+		file.write_int32(prototypeBegin);
+		file.write_int32(count);
+
+		prototypeBegin += count;
+	}
+
+	for (int i = 0; i < prototypeCount; ++i) {
+		const ObjectPrototype &proto = prototypes[i];
+		const int count = proto.getPointCount();
+
+		for (int j = 0; j < count; ++j) {
+			file.write_float(proto.getPoint(j).x);
+			file.write_float(proto.getPoint(j).y);
+		}
+	}
+
+	// object instances
+	for (int i = 0; i < objectCount; ++i) {
+		file.write_int32(objectPrototypes[i]);
+	}
+
+	for (int i = 0; i < objectCount; ++i) {
+		const CL_Vec2f &pos = p_level.getObject(i).getPosition();
+
+		file.write_float(pos.x);
+		file.write_float(pos.y);
+	}
+
+	file.close();
+
+#ifndef UNIX
+	// rename() does not replace existing files there
+	remove(p_filename.c_str());
+#endif // !UNIX
+
+	if (rename(tmpFilename.c_str(), p_filename.c_str()) != 0) {
+		remove(tmpFilename.c_str());
+		throw CL_Exception(cl_format("cannot replace %1", p_filename));
+	}
+
+	cl_log_event(LOG_DEBUG, "compiled level written to %1", p_filename);
+}
+
+bool CompiledLevel::open(const CL_String &p_filename)
+{
+	close();
+
+	if (!m_impl->map(p_filename)) {
+		return false;
+	}
+
+	if (!m_impl->validate()) {
+		cl_log_event(LOG_WARN, "invalid compiled level %1", p_filename);
+		close();
+
+		return false;
+	}
+
+	return true;
+}
+
+bool CompiledLevelImpl::map(const CL_String &p_filename)
+{
+#ifdef UNIX
+
+	const int fd = ::open(p_filename.c_str(), O_RDONLY);
+
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED) {
+		return false;
+	}
+
+	m_map = map;
+	m_data = static_cast<const char*>(map);
+	m_size = static_cast<int>(st.st_size);
+
+#else
+
+	try {
+		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+		m_size = file.get_size();
+		m_buffer = CL_DataBuffer(m_size);
+
+		if (file.read(m_buffer.get_data(), m_size) != m_size) {
+			return false;
+		}
+
+		file.close();
+
+		m_data = m_buffer.get_data();
+
+	} catch (CL_Exception &e) {
+		return false;
+	}
+
+#endif // UNIX
+
+	return true;
+}
+
+void CompiledLevelImpl::unmap()
+{
+#ifdef UNIX
+	if (m_map != NULL) {
+		munmap(m_map, m_size);
+		m_map = NULL;
+	}
+#else
+	m_buffer = CL_DataBuffer();
+#endif // UNIX
+
+	m_data = NULL;
+	m_size = 0;
+}
+
+bool CompiledLevelImpl::rangeFits(int p_begin, int p_count, unsigned p_total)
+{
+	if (p_begin < 0 || p_count < 0) {
+		return false;
+	}
+
+	const unsigned begin = static_cast<unsigned>(p_begin);
+
+	return begin <= p_total && static_cast<unsigned>(p_count) <= p_total - begin;
+}
+
+bool CompiledLevelImpl::validate()
+{
+	// points are read directly from file
+	G_ASSERT(sizeof(CL_Pointf) == 2 * sizeof(float));
+	G_ASSERT(sizeof(CL_Vec2f) == 2 * sizeof(float));
+
+	if (m_size < static_cast<signed>(sizeof(CompiledLevelHeader))) {
+		return false;
+	}
+
+	memcpy(&m_header, m_data, sizeof(CompiledLevelHeader));
+
+	const CompiledLevelHeader &h = m_header;
+
+	if (
+			memcmp(h.m_magic, MAGIC, sizeof(MAGIC)) != 0
+			|| h.m_version != CompiledLevel::VERSION
+			|| h.m_byteOrder != BYTE_ORDER_MARK
+			|| h.m_lodCount != static_cast<unsigned>(TrackSegment::LOD_COUNT)
+			|| h.m_segmentCount != h.m_trackPointCount
+	) {
+		return false;
+	}
+
+	// sizes are summed in 64 bits, so counts from file cannot overflow
+	typedef unsigned long long TSize;
+
+	const TSize expectedSize =
+			sizeof(CompiledLevelHeader)
+			+ TSize(h.m_trackPointCount) * 4 * sizeof(float)
+			+ TSize(h.m_segmentCount) * (SEGMENT_INTS * sizeof(int) + sizeof(CL_Vec2f))
+			+ TSize(h.m_triPointCount) * sizeof(CL_Pointf)
+			+ TSize(h.m_midPointCount) * sizeof(CL_Pointf)
+			+ TSize(h.m_prototypeCount) * 2 * sizeof(int)
+			+ TSize(h.m_prototypePointCount) * sizeof(CL_Pointf)
+			+ TSize(h.m_objectCount) * (sizeof(int) + sizeof(CL_Vec2f));
+
+	if (expectedSize != static_cast<TSize>(m_size)) {
+		return false;
+	}
+
+	// all sections are made of 4 byte values
+	const char *pos = m_data + sizeof(CompiledLevelHeader);
+
+	m_trackPoints = reinterpret_cast<const float*>(pos);
+	pos += h.m_trackPointCount * 4 * sizeof(float);
+
+	m_segments = reinterpret_cast<const int*>(pos);
+	pos += h.m_segmentCount * SEGMENT_INTS * sizeof(int);
+
+	m_guides = reinterpret_cast<const CL_Vec2f*>(pos);
+	pos += h.m_segmentCount * sizeof(CL_Vec2f);
+
+	m_triPoints = reinterpret_cast<const CL_Pointf*>(pos);
+	pos += h.m_triPointCount * sizeof(CL_Pointf);
+
+	m_midPoints = reinterpret_cast<const CL_Pointf*>(pos);
+	pos += h.m_midPointCount * sizeof(CL_Pointf);
+
+	m_prototypes = reinterpret_cast<const int*>(pos);
+	pos += h.m_prototypeCount * 2 * sizeof(int);
+
+	m_prototypePoints = reinterpret_cast<const CL_Pointf*>(pos);
+	pos += h.m_prototypePointCount * sizeof(CL_Pointf);
+
+	m_objects = reinterpret_cast<const int*>(pos);
+	pos += h.m_objectCount * sizeof(int);
+
+	m_objectPositions = reinterpret_cast<const CL_Vec2f*>(pos);
+
+	// ranges must not point outside of sections
+	for (unsigned i = 0; i < h.m_segmentCount; ++i) {
+		const int *seg = m_segments + i * SEGMENT_INTS;
+
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			if (!rangeFits(seg[lod], seg[TrackSegment::LOD_COUNT + lod], h.m_triPointCount)) {
+				return false;
+			}
+		}
+
+		if (!rangeFits(seg[SEGMENT_INTS - 2], seg[SEGMENT_INTS - 1], h.m_midPointCount)) {
+			return false;
+		}
+	}
+
+	for (unsigned i = 0; i < h.m_prototypeCount; ++i) {
+		const int count = m_prototypes[2 * i + 1];
+
+		if (count <= 0 || !rangeFits(m_prototypes[2 * i], count, h.m_prototypePointCount)) {
+			return false;
+		}
+	}
+
+	for (unsigned i = 0; i < h.m_objectCount; ++i) {
+		if (m_objects[i] < 0 || static_cast<unsigned>(m_objects[i]) >= h.m_prototypeCount) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CompiledLevel::close()
+{
+	m_impl->unmap();
+}
+
+unsigned CompiledLevel::getSourceHash() const
+{
+	G_ASSERT(isOpen());
+	return m_impl->m_header.m_sourceHash;
+}
+
+bool CompiledLevel::isOpen() const
+{
+	return m_impl->m_data != NULL;
+}
+
+void CompiledLevel::readObjects(std::vector<Object> *p_objects) const
+{
+	G_ASSERT(isOpen());
+
+	const int prototypeCount = m_impl->m_header.m_prototypeCount;
+	const int count = m_impl->m_header.m_objectCount;
+
+	std::vector<ObjectPrototype> prototypes;
+	prototypes.reserve(prototypeCount);
+
+	for (int i = 0; i < prototypeCount; ++i) {
+		const int begin = m_impl->m_prototypes[2 * i];
+		const int ptCount = m_impl->m_prototypes[2 * i + 1];
+
+		prototypes.push_back(
+				ObjectPrototype(m_impl->m_prototypePoints + begin, ptCount)
+		);
+	}
+
+	p_objects->reserve(p_objects->size() + count);
+
+	for (int i = 0; i < count; ++i) {
+		p_objects->push_back(
+				Object(
+						prototypes[m_impl->m_objects[i]],
+						m_impl->m_objectPositions[i]
+				)
+		);
+	}
+}
+
+void CompiledLevel::readTrack(Track *p_track) const
+{
+	G_ASSERT(isOpen());
+
+	const int count = m_impl->m_header.m_trackPointCount;
+	const float *values = m_impl->m_trackPoints;
+
+	p_track->reserve(p_track->getPointCount() + count);
+
+	for (int i = 0; i < count; ++i, values += 4) {
+		p_track->addPoint(CL_Pointf(values[0], values[1]), values[2], values[3]);
+	}
+}
+
+void CompiledLevel::readTriangulation(TrackTriangulator *p_triangulator) const
+{
+	G_ASSERT(isOpen());
+
+	const CompiledLevelHeader &h = m_impl->m_header;
+
+	p_triangulator->assign(
+			m_impl->m_triPoints, h.m_triPointCount,
+			m_impl->m_midPoints, h.m_midPointCount,
+			m_impl->m_segments, m_impl->m_guides, h.m_segmentCount
+	);
+}
+
+}
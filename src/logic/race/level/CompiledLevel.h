@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+
+namespace Race
+{
+
+class Level;
+class Object;
+class Track;
+class TrackTriangulator;
+
+class CompiledLevelImpl;
+
+/**
+ * Binary level format (*.glev).
+ * <p>
+ * Compiled level keeps the track together with data calculated from it
+ * (track triangulation, object prototypes and their placements in screen
+ * units), so it can be loaded without parsing and triangulating. All
+ * values are 32-bit little-endian integers and floats. File is mapped
+ * into memory when it is read.
+ * <p>
+ * Compiled file remembers the hash of XML file that it was built from,
+ * so outdated files can be detected.
+ */
+class CompiledLevel
+{
+	public:
+
+		/**
+		 * Binary format version. Increase it on every format change
+		 * and on every change of derived data (i.e. triangulation
+		 * algorithm), so old files are rejected.
+		 */
+		static const unsigned VERSION = 2;
+
+
+		CompiledLevel();
+
+		virtual ~CompiledLevel();
+
+
+		/**
+		 * Provides file name of cached level. Cache is updated after
+		 * every load from XML, so next time the compiled form can be
+		 * used. Entries are validated by the source hash.
+		 *
+		 * @return Cache file name for given level file
+		 */
+		static CL_String getCacheName(const CL_String &p_filename);
+
+		/** @return Compiled file name for given level file */
+		static CL_String getCompiledName(const CL_String &p_filename);
+
+		/** @return Hash of file contents or 0 if file cannot be read */
+		static unsigned hashFile(const CL_String &p_filename);
+
+		/**
+		 * Writes loaded level in compiled form.
+		 *
+		 * @param p_level Loaded level.
+		 * @param p_sourceHash Hash of level source file.
+		 * @param p_filename Output file name.
+		 * @throws CL_Exception When file cannot be written.
+		 */
+		static void write(
+				const Level &p_level,
+				unsigned p_sourceHash,
+				const CL_String &p_filename
+		);
+
+
+		void close();
+
+		/** @return Hash of XML file that level was compiled from */
+		unsigned getSourceHash() const;
+
+		bool isOpen() const;
+
+		/**
+		 * Maps compiled level into memory and validates its header.
+		 *
+		 * @return false if file doesn't exist or it is not valid
+		 */
+		bool open(const CL_String &p_filename);
+
+		void readObjects(std::vector<Object> *p_objects) const;
+
+		void readTrack(Track *p_track) const;
+
+		void readTriangulation(TrackTriangulator *p_triangulator) const;
+
+
+	private:
+
+		CL_SharedPtr<CompiledLevelImpl> m_impl;
+};
+
+}
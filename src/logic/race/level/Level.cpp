@@ -28,6 +28,7 @@
 
 #include "Level.h"
 
+#include <algorithm>
 #include <assert.h>
 
 #include "common/Limits.h"
@@ -35,7 +36,12 @@
 #include "common/Units.h"
 #include "logic/race/Block.h"
 #include "logic/race/level/Bound.h"
+#include "logic/race/level/BoundTree.h"
+#include "logic/race/level/ChunkGrid.h"
+#include "logic/race/level/Centreline.h"
 #include "logic/race/level/Checkpoint.h"
+#include "logic/race/level/CompiledLevel.h"
+#include "logic/race/level/LevelParser.h"
 #include "logic/race/level/Object.h"
 #include "logic/race/Car.h"
 #include "logic/race/level/Track.h"
@@ -43,6 +49,7 @@
 #include "logic/race/level/TrackPoint.h"
 #include "logic/race/level/TrackSegment.h"
 #include "logic/race/resistance/Geometry.h"
+#include "logic/race/resistance/ResistanceGrid.h"
 #include "logic/race/resistance/ResistanceMap.h"
 
 namespace Race {
@@ -96,12 +103,28 @@ class LevelImpl
 		/** Triangulator object */
 		TrackTriangulator m_trackTriangulator;
 
+		/** Reports load() progress */
+		CL_Callback_v1<float> m_func_loadProgress;
+
 		/** Resistance mapping */
 		RaceResistance::ResistanceMap m_resistanceMap;
 
+		/** Resistance of the track and mapping baked for fast lookup */
+		RaceResistance::ResistanceGrid m_resistanceGrid;
+
+		/** Distance of bounds from track edges */
+		float m_boundOffset;
+
+		/** Track bounds */
+		BoundTree m_boundTree;
+
+		/** Track segments and objects partitioned into world chunks */
+		ChunkGrid m_chunks;
+
 
 		LevelImpl() :
-			m_initialized(false)
+			m_initialized(false),
+			m_boundOffset(Units::toScreen(2.0f))
 			{}
 
 		CL_SharedPtr<RaceResistance::Geometry> buildResistanceGeometry(int p_x, int p_y, Common::GroundBlockType p_blockType) const;
@@ -109,29 +132,31 @@ class LevelImpl
 
 		// level loading
 
-		void loadMetaEl(const CL_DomNode &p_metaNode);
-
-		void loadTrackEl(const CL_DomNode &p_trackNode);
+		/**
+		 * Loads compiled level if it was built from the source with
+		 * <code>p_sourceHash</code> (0 skips this check).
+		 *
+		 * @return false if there is no valid compiled level
+		 */
+		bool loadCompiled(const CL_String &p_filename, unsigned p_sourceHash);
 
-		void loadBoundsEl(const CL_DomNode &p_boundsNode);
+		/** Builds everything that comes from track triangulation */
+		void buildTrackData();
 
-		void loadObjectsEl(const CL_DomNode &p_objectsNode);
+		/** Invokes the progress callback if it is set */
+		void reportProgress(float p_progress);
 
-		void loadObjectEl(const CL_DomNode &p_objNode);
+		/** Bakes track surface and resistance mapping into the grid */
+		void buildResistanceGrid();
 
-		std::vector<CL_Pointf> loadObjectGeom(const CL_DomNode &p_geomNode);
+		/** Builds walls along left and right track edges */
+		void buildBounds();
 
-		void loadObjectRefs(
-				const std::vector<CL_Pointf> &p_geom,
-				const CL_DomNode &p_refsNode
-		);
+		/** Gives the start line to the car, so it can detect crossings */
+		void applyStartLine(Car *p_car) const;
 
-		void geomTranslate(
-				std::vector<CL_Pointf> *p_geom,
-				const CL_Vec2f &p_vec
-		);
-
-		Race::Object buildObject(const std::vector<CL_Pointf> &p_geom);
+		/** Partitions track segments and objects into chunks */
+		void buildChunks();
 
 
 		// saving
@@ -161,6 +186,15 @@ void Level::destroy()
 {
 	if (m_impl->m_initialized) {
 		m_impl->m_resistanceMap.clear();
+		m_impl->m_resistanceGrid.clear();
+		m_impl->m_boundTree.clear();
+		m_impl->m_chunks.clear();
+
+		foreach (Car *car, m_impl->m_cars) {
+			car->setResistance(NULL);
+			car->setStartLine(CL_Pointf(), CL_Vec2f(), 0.0f);
+		}
+
 		m_impl->m_cars.clear();
 
 		std::pair<Car*, CL_Pointf*> entry;
@@ -174,171 +208,86 @@ bool Level::load(const CL_String& p_filename)
 {
 	G_ASSERT(!isUsable() && "level is already loaded");
 
-	try {
-		cl_log_event(LOG_DEBUG, "loading level %1", p_filename);
-		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+	// part of work done after each stage, the rest is buildTrackData()
+	static const float PARSED_PROGRESS = 0.2f;
+	static const float TRIANGULATED_PROGRESS = 0.4f;
 
-		CL_DomDocument document(file);
-		const CL_DomElement root = document.get_document_element();
+	const CL_String compiledName = CompiledLevel::getCompiledName(p_filename);
+	const CL_String cacheName = CompiledLevel::getCacheName(p_filename);
 
-		// load meta element
-		const CL_DomNode metaNode = root.named_item("meta");
-		m_impl->loadMetaEl(metaNode);
+	// compiled file given directly is used without source check
+	const unsigned sourceHash = compiledName != p_filename ?
+			CompiledLevel::hashFile(p_filename) : 0;
 
-		// gets level's content
-		const CL_DomNode contentNode = root.named_item("content");
-
-//		// load sand
-//		const CL_DomNode sandNode = contentNode.named_item("sand");
-//		loadSandElement(sandNode);
-
-		// load track
-		const CL_DomNode trackNode = contentNode.named_item("track");
-		m_impl->loadTrackEl(trackNode);
-
-		// load objects
-		const CL_DomNode objectsNode = contentNode.named_item("objects");
-		m_impl->loadObjectsEl(objectsNode);
+	if (
+			m_impl->loadCompiled(compiledName, sourceHash)
+			|| (sourceHash != 0 && m_impl->loadCompiled(cacheName, sourceHash))
+	) {
+		m_impl->reportProgress(TRIANGULATED_PROGRESS);
+		m_impl->buildTrackData();
+		return true;
+	}
 
-		// load track bounds
-		const CL_DomNode boundsNode = contentNode.named_item("bounds");
-		m_impl->loadBoundsEl(boundsNode);
+	try {
+		cl_log_event(LOG_DEBUG, "loading level %1", p_filename);
 
-		file.close();
+		LevelParser parser;
+		parser.parse(p_filename, &m_impl->m_track, &m_impl->m_objects);
 
 		cl_log_event(LOG_DEBUG, "level loaded");
+		m_impl->reportProgress(PARSED_PROGRESS);
 
 		// run triangulator
 		m_impl->m_trackTriangulator.clear();
 		m_impl->m_trackTriangulator.triangulate(m_impl->m_track);
+		m_impl->reportProgress(TRIANGULATED_PROGRESS);
 
-		return true;
+		m_impl->buildTrackData();
 
 	} catch (CL_Exception &e) {
 		cl_log_event(LOG_ERROR, "cannot load level '%1': %2", p_filename, e.message);
-	}
 
-	return false;
-
-}
-
-void LevelImpl::loadMetaEl(const CL_DomNode &p_metaNode)
-{
-	// TODO
-}
-
-void LevelImpl::loadTrackEl(const CL_DomNode &p_trackNode)
-{
-	const CL_DomNodeList blockList = p_trackNode.get_child_nodes();
-	const int blockListSize = blockList.get_length();
-
-	for (int i = 0; i < blockListSize; ++i) {
-		const CL_DomNode blockNode = blockList.item(i);
-
-		if (blockNode.get_node_name() == "point") {
-			const float x = blockNode.select_float("@x");
-			const float y = blockNode.select_float("@y");
-			const float radius = blockNode.select_float("@radius");
-			const float modifier = blockNode.select_float("@shift");
+		// don't leave partially loaded level
+		m_impl->m_track.clear();
+		m_impl->m_objects.clear();
 
-			cl_log_event(LOG_DEBUG, "Loaded track point %1 x %2, rad = %3, mod = %4", x, y, radius, modifier);
-			m_track.addPoint(
-					Units::toScreen(CL_Pointf(x, y)),
-					Units::toScreen(radius),
-					modifier
-			);
-		} else {
-			cl_log_event(LOG_WARN, "Unknown element in <track>: %1", blockNode.get_node_name());
-		}
+		return false;
 	}
-}
-
-void LevelImpl::loadObjectsEl(const CL_DomNode &p_objectsNode)
-{
-	const CL_DomNodeList objList = p_objectsNode.get_child_nodes();
-	const int objListSize = objList.get_length();
 
-	for (int i = 0; i < objListSize; ++i) {
-		loadObjectEl(objList.item(i));
+	// remember derived data for the next load
+	if (sourceHash != 0) {
+		try {
+			CompiledLevel::write(*this, sourceHash, cacheName);
+		} catch (CL_Exception &e) {
+			cl_log_event(LOG_WARN, "cannot cache level '%1': %2", p_filename, e.message);
+		}
 	}
-}
 
-void LevelImpl::loadObjectEl(const CL_DomNode &p_objNode)
-{
-	const CL_DomNode geomNode = p_objNode.named_item("geometry");
-	const CL_DomNode refsNode = p_objNode.named_item("refs");
+	return true;
 
-	std::vector<CL_Pointf> geom = loadObjectGeom(geomNode);
-	loadObjectRefs(geom, refsNode);
 }
 
-std::vector<CL_Pointf> LevelImpl::loadObjectGeom(const CL_DomNode &p_geomNode)
+bool LevelImpl::loadCompiled(const CL_String &p_filename, unsigned p_sourceHash)
 {
-	const CL_DomNodeList list = p_geomNode.get_child_nodes();
-	const int listSize = list.get_length();
-
-	float x, y;
-	std::vector<CL_Pointf> result;
-
-	for (int i = 0; i < listSize; ++i) {
-		const CL_DomNode vertex = list.item(i);
-		x = vertex.select_float("@x");
-		y = vertex.select_float("@y");
+	CompiledLevel compiled;
 
-		result.push_back(CL_Pointf(x, y));
+	if (!compiled.open(p_filename)) {
+		return false;
 	}
 
-	return result;
-}
-
-void LevelImpl::loadObjectRefs(
-		const std::vector<CL_Pointf> &p_geom,
-		const CL_DomNode &p_refsNode
-)
-{
-	const CL_DomNodeList list = p_refsNode.get_child_nodes();
-	const int listSize = list.get_length();
-
-	CL_Vec2f trans;
-
-	for (int i = 0; i < listSize; ++i) {
-		std::vector<CL_Pointf> geomCopy(p_geom);
-
-		const CL_DomNode ref = list.item(i);
-		const CL_DomNode position = ref.named_item("position");
-
-		trans.x = position.select_float("@x");
-		trans.y = position.select_float("@y");
-
-		geomTranslate(&geomCopy, trans);
-		m_objects.push_back(buildObject(geomCopy));
+	// compiled file must be built from current source
+	if (p_sourceHash != 0 && p_sourceHash != compiled.getSourceHash()) {
+		cl_log_event(LOG_DEBUG, "compiled level %1 is outdated", p_filename);
+		return false;
 	}
-}
-
-void LevelImpl::geomTranslate(
-		std::vector<CL_Pointf> *p_geom,
-		const CL_Vec2f &p_vec
-)
-{
-	const int geomSize = static_cast<signed>(p_geom->size());
-	for (int i = 0; i < geomSize; i++) {
-		(*p_geom)[i] += p_vec;
-	}
-}
 
-Race::Object LevelImpl::buildObject(const std::vector<CL_Pointf> &p_geom)
-{
-	const int geomSize = static_cast<signed>(p_geom.size());
-	CL_Pointf *pts = new CL_Pointf[geomSize];
-
-	for (int i = 0; i < geomSize; ++i) {
-		pts[i] = Units::toScreen(p_geom[i]);
-	}
+	compiled.readTrack(&m_track);
+	compiled.readObjects(&m_objects);
+	compiled.readTriangulation(&m_trackTriangulator);
 
-	Race::Object obj(pts, geomSize);
+	cl_log_event(LOG_DEBUG, "level loaded from %1", p_filename);
 
-	delete[] pts;
-	return obj;
+	return true;
 }
 
 CL_SharedPtr<RaceResistance::Geometry> LevelImpl::buildResistanceGeometry(int p_x, int p_y, Common::GroundBlockType p_blockType) const
@@ -411,37 +360,6 @@ CL_SharedPtr<RaceResistance::Geometry> LevelImpl::buildResistanceGeometry(int p_
 	return geom;
 }
 
-void LevelImpl::loadBoundsEl(const CL_DomNode &p_boundsNode)
-{
-//	const CL_DomNodeList boundList = p_boundsNode.get_child_nodes();
-//	const int boundListSize = boundList.get_length();
-//
-//	for (int i = 0; i < boundListSize; ++i) {
-//		const CL_DomNode boundNode = boundList.item(i);
-//
-//		if (boundNode.get_node_name() == "bound") {
-//			CL_DomNamedNodeMap attrs = boundNode.get_attributes();
-//
-//			float x1 = CL_StringHelp::local8_to_float(attrs.get_named_item("x1").get_node_value());
-//			float y1 = CL_StringHelp::local8_to_float(attrs.get_named_item("y1").get_node_value());
-//			float x2 = CL_StringHelp::local8_to_float(attrs.get_named_item("x2").get_node_value());
-//			float y2 = CL_StringHelp::local8_to_float(attrs.get_named_item("y2").get_node_value());
-//
-//			x1 *= Block::WIDTH;
-//			y1 *= Block::WIDTH;
-//			x2 *= Block::WIDTH;
-//			y2 *= Block::WIDTH;
-//
-//			cl_log_event("debug", "Loading bound %1 x %2 -> %3 x %4", x1, y1, x2, y2);
-//
-//			const CL_LineSegment2f segment(CL_Pointf(x1, y1), CL_Pointf(x2, y2));
-//			m_bounds.push_back(CL_SharedPtr<Bound>(new Bound(segment)));
-//		} else {
-//			cl_log_event("race", "Unknown node '%1', ignoring", boundNode.get_node_name());
-//		}
-//	}
-}
-
 void Level::save(const CL_String &p_filename)
 {
 	CL_File file;
@@ -497,15 +415,283 @@ void LevelImpl::saveTrackEl(CL_DomDocument &p_doc, CL_DomNode &p_trackNode)
 	}
 }
 
-float Level::getResistance(float p_realX, float p_realY)
+float Level::getResistance(float p_realX, float p_realY) const
+{
+	if (m_impl->m_resistanceGrid.isEmpty()) {
+		return 0.0f;
+	}
+
+	return m_impl->m_resistanceGrid.sample(CL_Pointf(p_realX, p_realY));
+}
+
+void Level::rebuildTrackData()
+{
+	m_impl->buildTrackData();
+}
+
+CL_Callback_v1<float> &Level::func_loadProgress()
+{
+	return m_impl->m_func_loadProgress;
+}
+
+void LevelImpl::reportProgress(float p_progress)
+{
+	if (!m_func_loadProgress.is_null()) {
+		m_func_loadProgress.invoke(p_progress);
+	}
+}
+
+void LevelImpl::buildTrackData()
+{
+	// resistance grid is the most expensive part
+	buildResistanceGrid();
+	reportProgress(0.8f);
+
+	buildBounds();
+	reportProgress(0.9f);
+
+	buildChunks();
+
+	foreach (Car *car, m_cars) {
+		applyStartLine(car);
+	}
+
+	reportProgress(1.0f);
+}
+
+void LevelImpl::buildChunks()
+{
+	// about one screen
+	static const float CHUNK_SIZE = Units::toScreen(50.0f);
+
+	const int segCount = m_track.getPointCount();
+	const int objCount = static_cast<signed>(m_objects.size());
+
+	std::vector<CL_Rectf> segBounds, objBounds;
+
+	segBounds.reserve(segCount);
+	objBounds.reserve(objCount);
+
+	for (int i = 0; i < segCount; ++i) {
+		const TrackSegment &seg = m_trackTriangulator.getSegment(i);
+		CL_Rectf bounds = seg.getBounds();
+
+		// segment owns the gap to the next one
+		const TrackSegment &next = m_trackTriangulator.getSegment((i + 1) % segCount);
+
+		if (next.getTrianglePointCount() >= 2) {
+			const CL_Pointf *points = next.getTrianglePoints();
+
+			bounds.bounding_rect(
+					CL_Rectf(
+							std::min(points[0].x, points[1].x),
+							std::min(points[0].y, points[1].y),
+							std::max(points[0].x, points[1].x),
+							std::max(points[0].y, points[1].y)
+					)
+			);
+		}
+
+		segBounds.push_back(bounds);
+	}
+
+	foreach (const Object &obj, m_objects) {
+		objBounds.push_back(obj.getBounds());
+	}
+
+	m_chunks.build(segBounds, objBounds, CHUNK_SIZE);
+}
+
+const ChunkGrid &Level::getChunks() const
+{
+	return m_impl->m_chunks;
+}
+
+void Level::rebuildChunks()
+{
+	m_impl->buildChunks();
+}
+
+void LevelImpl::buildBounds()
+{
+	const int segCount = m_track.getPointCount();
+
+	// left and right edge of whole track, offset outside
+	std::vector<CL_Pointf> left, right;
+
+	for (int i = 0; i < segCount; ++i) {
+		const TrackSegment &seg = m_trackTriangulator.getSegment(i);
+
+		const CL_Pointf *points = seg.getTrianglePoints();
+		const int quadCount = seg.getTrianglePointCount() / 6;
+
+		if (quadCount == 0) {
+			continue;
+		}
+
+		// each quad is (left, right, next right), (left, next right, next left)
+		for (int q = 0; q <= quadCount; ++q) {
+			const CL_Pointf &l = q < quadCount ? points[q * 6] : points[q * 6 - 1];
+			const CL_Pointf &r = q < quadCount ? points[q * 6 + 1] : points[q * 6 - 4];
+
+			CL_Vec2f out = l - r;
+			const float width = out.length();
+
+			if (width > 0.0f) {
+				out *= m_boundOffset / width;
+			}
+
+			left.push_back(l + out);
+			right.push_back(r - out);
+		}
+	}
+
+	std::vector<CL_LineSegment2f> segments;
+	segments.reserve(left.size() + right.size());
+
+	const int edgeCount = static_cast<signed>(left.size());
+
+	for (int i = 0; i < edgeCount; ++i) {
+		const int next = i + 1 < edgeCount ? i + 1 : 0;
+
+		if (left[i] != left[next]) {
+			segments.push_back(CL_LineSegment2f(left[i], left[next]));
+		}
+
+		if (right[i] != right[next]) {
+			segments.push_back(CL_LineSegment2f(right[i], right[next]));
+		}
+	}
+
+	m_boundTree.build(segments);
+}
+
+const BoundTree &Level::getBoundTree() const
+{
+	return m_impl->m_boundTree;
+}
+
+float Level::getBoundOffset() const
 {
-//	return m_impl->m_resistanceMap.resistance(CL_Pointf(p_realX, p_realY));
-	return 0.0f;
+	return m_impl->m_boundOffset;
+}
+
+void Level::setBoundOffset(float p_offset)
+{
+	m_impl->m_boundOffset = p_offset;
+
+	if (isUsable()) {
+		m_impl->buildBounds();
+	}
+}
+
+void LevelImpl::buildResistanceGrid()
+{
+	// grid resolution
+	static const float CELL_SIZE = Units::toScreen(0.5f);
+	// resistance area around the track
+	static const float MARGIN = Units::toScreen(20.0f);
+
+	static const float TRACK_RESISTANCE = 0.0f;
+	static const float OFF_TRACK_RESISTANCE = 0.02f;
+	static const float MAX_RESISTANCE = 0.1f;
+
+	const int segCount = m_track.getPointCount();
+
+	if (segCount == 0) {
+		m_resistanceGrid.clear();
+		return;
+	}
+
+	CL_Rectf bounds = m_trackTriangulator.getSegment(0).getBounds();
+
+	for (int i = 1; i < segCount; ++i) {
+		bounds.bounding_rect(m_trackTriangulator.getSegment(i).getBounds());
+	}
+
+	bounds.left -= MARGIN;
+	bounds.top -= MARGIN;
+	bounds.right += MARGIN;
+	bounds.bottom += MARGIN;
+
+	m_resistanceGrid.create(bounds, CELL_SIZE, MAX_RESISTANCE, OFF_TRACK_RESISTANCE);
+
+	// the most detailed mesh with gaps between segments, as it is drawn
+	for (int i = 0; i < segCount; ++i) {
+		const TrackSegment &seg = m_trackTriangulator.getSegment(i);
+
+		const CL_Pointf *points = seg.getTrianglePoints();
+		const int pointCount = seg.getTrianglePointCount();
+
+		for (int j = 0; j + 2 < pointCount; j += 3) {
+			m_resistanceGrid.fillTriangle(
+					points[j], points[j + 1], points[j + 2],
+					TRACK_RESISTANCE
+			);
+		}
+
+		if (pointCount < 2) {
+			continue;
+		}
+
+		const TrackSegment &next =
+				m_trackTriangulator.getSegment(i + 1 < segCount ? i + 1 : 0);
+
+		if (next.getTrianglePointCount() < 2) {
+			continue;
+		}
+
+		const CL_Pointf &prevLeft = points[pointCount - 1];
+		const CL_Pointf &prevRight = points[pointCount - 2];
+		const CL_Pointf &nextLeft = next.getTrianglePoints()[0];
+		const CL_Pointf &nextRight = next.getTrianglePoints()[1];
+
+		m_resistanceGrid.fillTriangle(prevLeft, prevRight, nextRight, TRACK_RESISTANCE);
+		m_resistanceGrid.fillTriangle(prevLeft, nextRight, nextLeft, TRACK_RESISTANCE);
+	}
+
+	// sandpits and other surfaces go over the track
+	m_resistanceMap.bake(&m_resistanceGrid);
+
+	cl_log_event(
+			LOG_DEBUG,
+			"resistance grid built with cell size %1",
+			m_resistanceGrid.getCellSize()
+	);
 }
 
 void Level::addCar(Car *p_car) {
 
 	m_impl->m_cars.push_back(p_car);
+
+	// car reads ground resistance directly
+	p_car->setResistance(&m_impl->m_resistanceGrid);
+	m_impl->applyStartLine(p_car);
+}
+
+void LevelImpl::applyStartLine(Car *p_car) const
+{
+	const Centreline &line = m_trackTriangulator.getCentreline();
+
+	if (line.isEmpty() || m_track.getPointCount() == 0) {
+		p_car->setStartLine(CL_Pointf(), CL_Vec2f(), 0.0f);
+		return;
+	}
+
+	// start line divides the last and the first centreline segments
+	CL_Vec2f forward =
+			line.getDirection(line.getSegmentCount() - 1) + line.getDirection(0);
+
+	if (forward.length() < 0.01f) {
+		forward = line.getDirection(0);
+	}
+
+	forward.normalize();
+
+	// cars can go off the track up to the bounds
+	const float halfWidth = m_track.getPoint(0).getRadius() + m_boundOffset;
+
+	p_car->setStartLine(line.getPoint(0), forward, halfWidth);
 }
 
 void Level::removeCar(Car *p_car) {
@@ -516,6 +702,8 @@ void Level::removeCar(Car *p_car) {
 	) {
 		if (*itor == p_car) {
 			m_impl->m_cars.erase(itor);
+			p_car->setResistance(NULL);
+			p_car->setStartLine(CL_Pointf(), CL_Vec2f(), 0.0f);
 			break;
 		}
 	}
@@ -552,11 +740,11 @@ void Level::getStartPosAndRot(
 	for (int i = lastSegIdx; i >= 0; --i) {
 		// get track segment from the end
 		const TrackSegment &s = m_impl->m_trackTriangulator.getSegment(i);
-		const std::vector<CL_Pointf> &mids = s.getMidPoints();
+		const CL_Pointf *mids = s.getMidPoints();
 
 		// find segment for car positioning
 		found = false;
-		lastMidsIdx = static_cast<signed>(mids.size()) - 1;
+		lastMidsIdx = s.getMidPointCount() - 1;
 
 		for (int j = lastMidsIdx; j >= 0; --j) {
 			const CL_Pointf &curr = mids[j];
@@ -36,6 +36,8 @@ namespace Race {
 
 class Block;
 class Bound;
+class BoundTree;
+class ChunkGrid;
 class Car;
 class Object;
 class Track;
@@ -65,9 +67,17 @@ class Level
 		/** @deprecated Check load() state instead  */
 		DEPRECATED(bool isLoaded() const);
 
-		/** @return true if track was loaded */
+		/**
+		 * Loads level and builds its track data. Progress callback is
+		 * invoked from the calling thread on every finished stage.
+		 *
+		 * @return true if track was loaded
+		 */
 		bool load(const CL_String &p_filename);
 
+		/** Invoked with the load() progress from 0.0 to 1.0 */
+		CL_Callback_v1<float> &func_loadProgress();
+
 		void save(const CL_String &p_filename);
 
 		/**
@@ -125,7 +135,42 @@ class Level
 
 		// other
 
-		float getResistance(float p_x, float p_y);
+		/**
+		 * @return Ground resistance at given point. Off-track areas
+		 * slow cars down. Constant cost lookup in baked grid.
+		 */
+		float getResistance(float p_x, float p_y) const;
+
+		/**
+		 * Builds resistance grid, bounds and chunks again. Use it after
+		 * track was triangulated outside of load().
+		 */
+		void rebuildTrackData();
+
+
+		// bounds
+
+		/** @return Walls along both track edges */
+		const BoundTree &getBoundTree() const;
+
+		/** @return Distance of bounds from track edges */
+		float getBoundOffset() const;
+
+		/** Sets distance of bounds from track edges and rebuilds them */
+		void setBoundOffset(float p_offset);
+
+
+		// chunks
+
+		/** @return Track segments and objects partitioned in world space */
+		const ChunkGrid &getChunks() const;
+
+		/**
+		 * Partitions track and objects into chunks again. It is cheaper
+		 * than rebuildTrackData(), so editor can use it after every
+		 * triangulation.
+		 */
+		void rebuildChunks();
 
 		/**
 		 * @return A start position of <code>p_num</code>
@@ -0,0 +1,690 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LevelParser.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "common.h"
+#include "common/Units.h"
+#include "logic/race/level/Object.h"
+#include "logic/race/level/Track.h"
+
+namespace Race
+{
+
+/** Elements of level schema */
+enum Element {
+	E_LEVEL,
+	E_CONTENT,
+	E_TRACK,
+	E_POINT,
+	E_OBJECTS,
+	E_OBJECT,
+	E_GEOMETRY,
+	E_VERTEX,
+	E_REFS,
+	E_REF,
+	E_POSITION,
+	E_OTHER
+};
+
+struct ElementName {
+	const char *m_name;
+	Element m_element;
+};
+
+const ElementName ELEMENT_NAMES[] = {
+	{ "level", E_LEVEL },
+	{ "content", E_CONTENT },
+	{ "track", E_TRACK },
+	{ "point", E_POINT },
+	{ "objects", E_OBJECTS },
+	{ "object", E_OBJECT },
+	{ "geometry", E_GEOMETRY },
+	{ "vertex", E_VERTEX },
+	{ "refs", E_REFS },
+	{ "ref", E_REF },
+	{ "position", E_POSITION }
+};
+
+/** Text range in parsed buffer */
+struct Token {
+	const char *m_begin;
+	int m_length;
+
+	bool operator==(const char *p_str) const {
+		return
+				static_cast<signed>(strlen(p_str)) == m_length
+				&& strncmp(m_begin, p_str, m_length) == 0;
+	}
+
+	bool operator==(const Token &p_other) const {
+		return
+				p_other.m_length == m_length
+				&& strncmp(m_begin, p_other.m_begin, m_length) == 0;
+	}
+};
+
+struct Tag {
+	/** Max number of attributes that are remembered */
+	static const int MAX_ATTRIBUTES = 8;
+
+	Token m_name;
+
+	/** Closing tag like </name> */
+	bool m_closing;
+
+	/** Empty element tag like <name/> */
+	bool m_empty;
+
+	int m_attrCount;
+
+	Token m_attrNames[MAX_ATTRIBUTES];
+
+	Token m_attrValues[MAX_ATTRIBUTES];
+};
+
+class LevelParserImpl
+{
+	public:
+
+		/** File contents */
+		CL_DataBuffer m_buffer;
+
+		const char *m_pos, *m_end;
+
+		/** Current line (for error messages) */
+		int m_line;
+
+		/** Open elements */
+		std::vector<std::pair<Element, Token> > m_stack;
+
+		/** Geometry of currently parsed object (world units) */
+		std::vector<CL_Pointf> m_geometry;
+
+		/** Prototype built from m_geometry on first ref (screen units) */
+		ObjectPrototype m_prototype;
+
+
+		LevelParserImpl() :
+			m_pos(NULL),
+			m_end(NULL),
+			m_line(1)
+		{ /* empty */ }
+
+
+		// tokenizer
+
+		void advance(int p_count);
+
+		/** @return Number of occurrences of <code>p_str</code> in buffer */
+		int count(const char *p_str) const;
+
+		void error(const CL_String &p_message) const;
+
+		/** @return false on end of document */
+		bool nextTag(Tag *p_tag);
+
+		void parseAttributes(Tag *p_tag);
+
+		Token parseName();
+
+		/** Skips text until <code>p_str</code> (inclusive) */
+		void skipPast(const char *p_str);
+
+		void skipSpaces();
+
+
+		// schema
+
+		/** @return Attribute as number (required if no default is given) */
+		float attribute(
+				const Tag &p_tag,
+				const char *p_name,
+				bool p_required = true,
+				float p_default = 0.0f
+		) const;
+
+		Element element(const Token &p_name) const;
+
+		Element parent() const;
+
+		float toFloat(const Token &p_token) const;
+};
+
+LevelParser::LevelParser() :
+	m_impl(new LevelParserImpl())
+{
+	// empty
+}
+
+LevelParser::~LevelParser()
+{
+	// empty
+}
+
+void LevelParser::parse(
+		const CL_String &p_filename,
+		Track *p_track,
+		std::vector<Object> *p_objects
+)
+{
+	CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+	const int size = file.get_size();
+	CL_DataBuffer data(size);
+
+	if (file.read(data.get_data(), size) != size) {
+		throw CL_Exception(cl_format("cannot read %1", p_filename));
+	}
+
+	file.close();
+
+	parse(data, p_track, p_objects);
+}
+
+void LevelParser::parse(
+		const CL_DataBuffer &p_data,
+		Track *p_track,
+		std::vector<Object> *p_objects
+)
+{
+	m_impl->m_buffer = p_data;
+
+	m_impl->m_pos = m_impl->m_buffer.get_data();
+	m_impl->m_end = m_impl->m_pos + m_impl->m_buffer.get_size();
+	m_impl->m_line = 1;
+	m_impl->m_stack.clear();
+
+	// one track point for every point tag and one instance for every ref
+	p_track->reserve(p_track->getPointCount() + m_impl->count("<point"));
+	p_objects->reserve(p_objects->size() + m_impl->count("<position"));
+
+	Tag tag;
+	Element elem;
+
+	while (m_impl->nextTag(&tag)) {
+
+		if (tag.m_closing) {
+			if (
+					m_impl->m_stack.empty()
+					|| !(m_impl->m_stack.back().second == tag.m_name)
+			) {
+				m_impl->error(
+						cl_format(
+								"unexpected closing tag </%1>",
+								CL_String(tag.m_name.m_begin, tag.m_name.m_length)
+						)
+				);
+			}
+
+			m_impl->m_stack.pop_back();
+			continue;
+		}
+
+		elem = m_impl->element(tag.m_name);
+
+		switch (elem) {
+			case E_POINT:
+				if (m_impl->parent() == E_TRACK) {
+					const float x = m_impl->attribute(tag, "x");
+					const float y = m_impl->attribute(tag, "y");
+					const float radius = m_impl->attribute(tag, "radius");
+					const float shift = m_impl->attribute(tag, "shift", false);
+
+					p_track->addPoint(
+							Units::toScreen(CL_Pointf(x, y)),
+							Units::toScreen(radius),
+							shift
+					);
+				}
+				break;
+
+			case E_OBJECT:
+				m_impl->m_geometry.clear();
+				m_impl->m_prototype = ObjectPrototype();
+				break;
+
+			case E_VERTEX:
+				if (m_impl->parent() == E_GEOMETRY) {
+					m_impl->m_geometry.push_back(
+							CL_Pointf(
+									m_impl->attribute(tag, "x"),
+									m_impl->attribute(tag, "y")
+							)
+					);
+				}
+				break;
+
+			case E_POSITION:
+				if (m_impl->parent() == E_REF) {
+					const CL_Vec2f trans(
+							m_impl->attribute(tag, "x"),
+							m_impl->attribute(tag, "y")
+					);
+
+					// geometry is shared by all refs of object
+					if (m_impl->m_prototype.isNull()) {
+						const int geomSize = static_cast<signed>(m_impl->m_geometry.size());
+
+						if (geomSize == 0) {
+							m_impl->error("object has no geometry");
+						}
+
+						std::vector<CL_Pointf> pts(geomSize);
+
+						for (int i = 0; i < geomSize; ++i) {
+							pts[i] = Units::toScreen(m_impl->m_geometry[i]);
+						}
+
+						m_impl->m_prototype = ObjectPrototype(&pts[0], geomSize);
+					}
+
+					p_objects->push_back(
+							Object(m_impl->m_prototype, Units::toScreen(trans))
+					);
+				}
+				break;
+
+			// structure only, nothing to read
+			case E_LEVEL:
+			case E_CONTENT:
+			case E_TRACK:
+			case E_OBJECTS:
+			case E_GEOMETRY:
+			case E_REFS:
+			case E_REF:
+			case E_OTHER:
+			default:
+				if (m_impl->parent() == E_TRACK) {
+					cl_log_event(
+							LOG_WARN,
+							"Unknown element in <track>: %1",
+							CL_String(tag.m_name.m_begin, tag.m_name.m_length)
+					);
+				}
+				break;
+		}
+
+		if (!tag.m_empty) {
+			m_impl->m_stack.push_back(std::make_pair(elem, tag.m_name));
+		}
+	}
+
+	if (!m_impl->m_stack.empty()) {
+		m_impl->error("unexpected end of file");
+	}
+
+	// buffer is not needed anymore
+	m_impl->m_buffer = CL_DataBuffer();
+	m_impl->m_geometry.clear();
+	m_impl->m_prototype = ObjectPrototype();
+}
+
+void LevelParserImpl::advance(int p_count)
+{
+	const char *end = m_pos + p_count;
+
+	for (; m_pos < end; ++m_pos) {
+		if (*m_pos == '\n') {
+			++m_line;
+		}
+	}
+}
+
+int LevelParserImpl::count(const char *p_str) const
+{
+	const int length = strlen(p_str);
+	int result = 0;
+
+	const char *pos = m_pos;
+
+	while (m_end - pos >= length) {
+		pos = static_cast<const char*>(memchr(pos, p_str[0], m_end - pos));
+
+		if (pos == NULL || m_end - pos < length) {
+			break;
+		}
+
+		if (strncmp(pos, p_str, length) == 0) {
+			++result;
+		}
+
+		++pos;
+	}
+
+	return result;
+}
+
+void LevelParserImpl::error(const CL_String &p_message) const
+{
+	throw CL_Exception(cl_format("line %1: %2", m_line, p_message));
+}
+
+bool LevelParserImpl::nextTag(Tag *p_tag)
+{
+	while (true) {
+		// skip text content
+		const char *lt = static_cast<const char*>(memchr(m_pos, '<', m_end - m_pos));
+
+		if (lt == NULL) {
+			advance(m_end - m_pos);
+			return false;
+		}
+
+		advance(lt - m_pos);
+
+		if (m_end - m_pos >= 4 && strncmp(m_pos, "<!--", 4) == 0) {
+			skipPast("-->");
+		} else if (m_end - m_pos >= 2 && (m_pos[1] == '?' || m_pos[1] == '!')) {
+			// processing instruction or declaration
+			skipPast(">");
+		} else {
+			break;
+		}
+	}
+
+	advance(1);
+
+	p_tag->m_closing = false;
+	p_tag->m_empty = false;
+	p_tag->m_attrCount = 0;
+
+	if (m_pos < m_end && *m_pos == '/') {
+		p_tag->m_closing = true;
+		advance(1);
+	}
+
+	p_tag->m_name = parseName();
+
+	if (p_tag->m_closing) {
+		skipSpaces();
+	} else {
+		parseAttributes(p_tag);
+	}
+
+	if (m_pos < m_end && *m_pos == '/' && !p_tag->m_closing) {
+		p_tag->m_empty = true;
+		advance(1);
+	}
+
+	if (m_pos >= m_end || *m_pos != '>') {
+		error("'>' expected");
+	}
+
+	advance(1);
+
+	return true;
+}
+
+void LevelParserImpl::parseAttributes(Tag *p_tag)
+{
+	while (true) {
+		skipSpaces();
+
+		if (m_pos >= m_end || *m_pos == '/' || *m_pos == '>') {
+			return;
+		}
+
+		const Token name = parseName();
+
+		skipSpaces();
+
+		if (m_pos >= m_end || *m_pos != '=') {
+			error("'=' expected after attribute name");
+		}
+
+		advance(1);
+		skipSpaces();
+
+		if (m_pos >= m_end || (*m_pos != '"' && *m_pos != '\'')) {
+			error("attribute value must be quoted");
+		}
+
+		const char quote = *m_pos;
+		advance(1);
+
+		const char *close =
+				static_cast<const char*>(memchr(m_pos, quote, m_end - m_pos));
+
+		if (close == NULL) {
+			error("unterminated attribute value");
+		}
+
+		Token value;
+		value.m_begin = m_pos;
+		value.m_length = close - m_pos;
+
+		advance(value.m_length + 1);
+
+		if (p_tag->m_attrCount < Tag::MAX_ATTRIBUTES) {
+			p_tag->m_attrNames[p_tag->m_attrCount] = name;
+			p_tag->m_attrValues[p_tag->m_attrCount] = value;
+			++p_tag->m_attrCount;
+		}
+	}
+}
+
+Token LevelParserImpl::parseName()
+{
+	Token token;
+	token.m_begin = m_pos;
+
+	while (
+			m_pos < m_end
+			&& *m_pos != '>' && *m_pos != '/' && *m_pos != '='
+			&& *m_pos != ' ' && *m_pos != '\t' && *m_pos != '\r' && *m_pos != '\n'
+	) {
+		++m_pos;
+	}
+
+	token.m_length = m_pos - token.m_begin;
+
+	if (token.m_length == 0) {
+		error("name expected");
+	}
+
+	return token;
+}
+
+void LevelParserImpl::skipPast(const char *p_str)
+{
+	const int length = strlen(p_str);
+
+	while (m_end - m_pos >= length) {
+		if (strncmp(m_pos, p_str, length) == 0) {
+			advance(length);
+			return;
+		}
+
+		advance(1);
+	}
+
+	error(cl_format("'%1' expected", p_str));
+}
+
+void LevelParserImpl::skipSpaces()
+{
+	while (
+			m_pos < m_end
+			&& (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n')
+	) {
+		advance(1);
+	}
+}
+
+float LevelParserImpl::attribute(
+		const Tag &p_tag,
+		const char *p_name,
+		bool p_required,
+		float p_default
+) const
+{
+	for (int i = 0; i < p_tag.m_attrCount; ++i) {
+		if (p_tag.m_attrNames[i] == p_name) {
+			return toFloat(p_tag.m_attrValues[i]);
+		}
+	}
+
+	if (p_required) {
+		error(
+				cl_format(
+						"attribute '%1' missing in <%2>",
+						p_name,
+						CL_String(p_tag.m_name.m_begin, p_tag.m_name.m_length)
+				)
+		);
+	}
+
+	return p_default;
+}
+
+Element LevelParserImpl::element(const Token &p_name) const
+{
+	static const int COUNT = sizeof(ELEMENT_NAMES) / sizeof(ELEMENT_NAMES[0]);
+
+	for (int i = 0; i < COUNT; ++i) {
+		if (p_name == ELEMENT_NAMES[i].m_name) {
+			return ELEMENT_NAMES[i].m_element;
+		}
+	}
+
+	return E_OTHER;
+}
+
+Element LevelParserImpl::parent() const
+{
+	return m_stack.empty() ? E_OTHER : m_stack.back().first;
+}
+
+float LevelParserImpl::toFloat(const Token &p_token) const
+{
+	// powers of ten that are exact in double
+	static const double POW10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	static const int MAX_EXACT_POW10 = sizeof(POW10) / sizeof(POW10[0]) - 1;
+
+	// 10^15 < 2^53, so collected digits are exact in double
+	static const int MAX_DIGITS = 15;
+
+	// locale independent conversion of [-+]digits[.digits][e[-+]digits]
+	//
+	// Up to 15 significant digits are kept, the rest are dropped. Mantissa
+	// and power of ten are exact in double, so their product is correctly
+	// rounded. The cast to float rounds again, which can differ from direct
+	// rounding by one unit in rare halfway cases.
+	const char *pos = p_token.m_begin;
+	const char *end = pos + p_token.m_length;
+
+	unsigned long long mantissa = 0;
+	int digitCount = 0, exp10 = 0;
+	bool negative = false, digits = false;
+
+	if (pos < end && (*pos == '-' || *pos == '+')) {
+		negative = *pos == '-';
+		++pos;
+	}
+
+	for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos) {
+		if (digitCount < MAX_DIGITS) {
+			mantissa = mantissa * 10 + (*pos - '0');
+			digitCount += mantissa != 0;
+		} else {
+			++exp10;
+		}
+
+		digits = true;
+	}
+
+	if (pos < end && *pos == '.') {
+		for (++pos; pos < end && *pos >= '0' && *pos <= '9'; ++pos) {
+			if (digitCount < MAX_DIGITS) {
+				mantissa = mantissa * 10 + (*pos - '0');
+				digitCount += mantissa != 0;
+				--exp10;
+			}
+
+			digits = true;
+		}
+	}
+
+	if (digits && pos < end && (*pos == 'e' || *pos == 'E')) {
+		++pos;
+
+		bool negExp = false;
+		int exp = 0;
+
+		if (pos < end && (*pos == '-' || *pos == '+')) {
+			negExp = *pos == '-';
+			++pos;
+		}
+
+		digits = false;
+
+		for (; pos < end && *pos >= '0' && *pos <= '9'; ++pos) {
+			// float range is much smaller anyway
+			if (exp < 1000) {
+				exp = exp * 10 + (*pos - '0');
+			}
+
+			digits = true;
+		}
+
+		exp10 += negExp ? -exp : exp;
+	}
+
+	if (!digits || pos != end) {
+		error(
+				cl_format(
+						"invalid number '%1'",
+						CL_String(p_token.m_begin, p_token.m_length)
+				)
+		);
+	}
+
+	double value = static_cast<double>(mantissa);
+
+	if (mantissa == 0) {
+		value = 0.0;
+	} else if (exp10 >= 0 && exp10 <= MAX_EXACT_POW10) {
+		value *= POW10[exp10];
+	} else if (exp10 < 0 && exp10 >= -MAX_EXACT_POW10) {
+		value /= POW10[-exp10];
+	} else {
+		value *= pow(10.0, exp10);
+	}
+
+	return static_cast<float>(negative ? -value : value);
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace Race
+{
+
+class Object;
+class Track;
+
+class LevelParserImpl;
+
+/**
+ * Streaming parser of level XML files.
+ * <p>
+ * File is read into memory once and scanned tag by tag, without building
+ * a DOM tree. Only elements from level schema are interpreted and numbers
+ * are converted directly from the file buffer. Other elements are
+ * skipped.
+ */
+class LevelParser
+{
+	public:
+
+		LevelParser();
+
+		virtual ~LevelParser();
+
+
+		/**
+		 * Parses level file. Track points and objects are appended
+		 * to given containers (in screen units).
+		 *
+		 * @throws CL_Exception when file cannot be read or it is not
+		 * valid. Message contains the line number.
+		 */
+		void parse(
+				const CL_String &p_filename,
+				Track *p_track,
+				std::vector<Object> *p_objects
+		);
+
+		/** Parses level file contents, see parse() above */
+		void parse(
+				const CL_DataBuffer &p_data,
+				Track *p_track,
+				std::vector<Object> *p_objects
+		);
+
+
+	private:
+
+		CL_SharedPtr<LevelParserImpl> m_impl;
+};
+
+}
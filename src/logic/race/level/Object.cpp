@@ -31,73 +31,78 @@
 namespace Race
 {
 
-class ObjectImpl
+Object::Object(const CL_Pointf p_points[], int p_count) :
+	m_prototype(p_points, p_count),
+	m_position(0.0f, 0.0f),
+	m_bounds(m_prototype.getBounds())
 {
-	public:
-
-		mutable CL_CollisionOutline m_outline;
+	// empty
+}
 
-		std::vector<CL_Pointf> *m_pts;
+Object::Object(const ObjectPrototype &p_prototype, const CL_Vec2f &p_position) :
+	m_prototype(p_prototype),
+	m_position(p_position),
+	m_bounds(m_prototype.getBounds())
+{
+	m_bounds.translate(p_position);
+}
 
+Object::~Object()
+{
+	// empty
+}
 
-		ObjectImpl(const CL_Pointf p_points[], int p_count)
-		{
-			CL_Contour contour;
-			m_pts = &contour.get_points();
+int Object::collide(
+		const CL_Pointf p_convex[], int p_convexCount,
+		CL_LineSegment2f p_contacts[], int p_maxContacts
+) const
+{
+	G_ASSERT(
+			p_convexCount > 0
+			&& p_convexCount <= ObjectPrototype::MAX_CONVEX_POINTS
+	);
 
-			for (int i = 0; i < p_count; ++i) {
-				m_pts->push_back(p_points[i]);
-			}
+	CL_Pointf local[ObjectPrototype::MAX_CONVEX_POINTS];
 
-			m_outline.get_contours().push_back(contour);
-			m_outline.set_inside_test(true);
-			m_outline.calculate_radius();
-			m_outline.calculate_sub_circles();
-			m_outline.enable_collision_info(true, false, true);
-		}
+	for (int i = 0; i < p_convexCount; ++i) {
+		local[i] = p_convex[i] - m_position;
+	}
 
-};
+	const int count = m_prototype.collide(
+			local, p_convexCount, p_contacts, p_maxContacts
+	);
 
-const std::vector<CL_CollidingContours> EMPTY_CONTOURS;
+	for (int i = 0; i < count; ++i) {
+		p_contacts[i].p += m_position;
+		p_contacts[i].q += m_position;
+	}
 
-Object::Object(const CL_Pointf p_points[], int p_count) :
-	m_impl(new ObjectImpl(p_points, p_count))
-{
-	// empty
+	return count;
 }
 
-Object::~Object()
+const CL_Rectf &Object::getBounds() const
 {
-	// empty
+	return m_bounds;
 }
 
-const std::vector<CL_CollidingContours> &Object::collide(
-		const CL_CollisionOutline &p_outline
-) const
+CL_Pointf Object::getPoint(int p_idx) const
 {
-	if (m_impl->m_outline.collide(p_outline)) {
-		return m_impl->m_outline.get_collision_info();
-	} else {
-		return EMPTY_CONTOURS;
-	}
+	return m_prototype.getPoint(p_idx) + m_position;
 }
 
-const CL_CollisionOutline &Object::getCollisionOutline() const
+int Object::getPointCount() const
 {
-	return m_impl->m_outline;
+	return m_prototype.getPointCount();
 }
 
-const CL_Pointf &Object::getPoint(int p_idx) const
+const CL_Vec2f &Object::getPosition() const
 {
-	G_ASSERT(p_idx >=0 && p_idx <= getPointCount());
-	return (*m_impl->m_pts)[p_idx];
+	return m_position;
 }
 
-int Object::getPointCount() const
+const ObjectPrototype &Object::getPrototype() const
 {
-	return static_cast<signed>(
-			m_impl->m_pts->size()
-	);
+	return m_prototype;
 }
 
 }
@@ -29,21 +29,27 @@
 #pragma once
 
 #include <ClanLib/core.h>
-#include <ClanLib/display.h>
 
 #include "common.h"
+#include "logic/race/level/ObjectPrototype.h"
 
 namespace Race
 {
 
-class ObjectImpl;
-
+/**
+ * Placement of level object.
+ * <p>
+ * Object is a lightweight instance: it keeps only its position and
+ * a reference to shared prototype geometry, so level with many
+ * identical objects stores their geometry once.
+ */
 class Object
 {
 	public:
 
 		/**
-		 * Build level object from <code>p_points</code>.
+		 * Build level object with its own prototype from
+		 * <code>p_points</code>.
 		 * <p>
 		 * Points must be ordered in counter-clockwise order.
 		 *
@@ -52,25 +58,58 @@ class Object
 		 */
 		Object(const CL_Pointf p_points[], int p_count);
 
+		/**
+		 * Places <code>p_prototype</code> at <code>p_position</code>.
+		 */
+		Object(const ObjectPrototype &p_prototype, const CL_Vec2f &p_position);
+
 		virtual ~Object();
 
 
-		const CL_CollisionOutline &getCollisionOutline() const;
+		/** @return Axis aligned rectangle that contains all object points */
+		const CL_Rectf &getBounds() const;
 
-		const CL_Pointf &getPoint(int p_idx) const;
+		/** @return Object point in level space */
+		CL_Pointf getPoint(int p_idx) const;
 
 		int getPointCount() const;
 
+		/** @return Translation from prototype to level space */
+		const CL_Vec2f &getPosition() const;
+
+		const ObjectPrototype &getPrototype() const;
+
 
-		const std::vector<CL_CollidingContours> &collide(
-				const CL_CollisionOutline &p_outline
+		/**
+		 * Finds object edges that touch convex polygon <code>p_convex</code>.
+		 * <p>
+		 * Polygon is moved into prototype space and tested there, found
+		 * edges are moved back to level space. See
+		 * ObjectPrototype::collide().
+		 *
+		 * @param p_convex Convex polygon points (at most
+		 * ObjectPrototype::MAX_CONVEX_POINTS).
+		 * @param p_convexCount Number of convex polygon points.
+		 * @param p_contacts Storage for touching edges.
+		 * @param p_maxContacts Size of <code>p_contacts</code>.
+		 * @return Number of contacts written.
+		 */
+		int collide(
+				const CL_Pointf p_convex[], int p_convexCount,
+				CL_LineSegment2f p_contacts[], int p_maxContacts
 		) const;
 
 
 	private:
 
-		CL_SharedPtr<ObjectImpl> m_impl;
+		/** Shared geometry */
+		ObjectPrototype m_prototype;
+
+		/** Translation from prototype to level space */
+		CL_Vec2f m_position;
+
+		/** Prototype bounds in level space */
+		CL_Rectf m_bounds;
 };
 
 }
-
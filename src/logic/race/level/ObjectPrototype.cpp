@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ObjectPrototype.h"
+
+#include <algorithm>
+
+namespace Race
+{
+
+class ObjectPrototypeImpl
+{
+	public:
+
+		/** Object outline points */
+		std::vector<CL_Pointf> m_pts;
+
+		/** Normal of edge from point i to i + 1 */
+		std::vector<CL_Vec2f> m_normals;
+
+		/** Edge line offset: dot product of edge normal and its start point */
+		std::vector<float> m_offsets;
+
+		/** Bounding box of all points */
+		CL_Rectf m_bounds;
+
+
+		ObjectPrototypeImpl(const CL_Pointf p_points[], int p_count) :
+			m_pts(p_points, p_points + p_count)
+		{
+			G_ASSERT(p_count > 0);
+
+			m_normals.reserve(p_count);
+			m_offsets.reserve(p_count);
+
+			m_bounds = CL_Rectf(p_points[0], CL_Sizef(0.0f, 0.0f));
+
+			for (int i = 0; i < p_count; ++i) {
+				const CL_Pointf &a = p_points[i];
+				const CL_Pointf &b = p_points[(i + 1) % p_count];
+
+				const CL_Vec2f n(b.y - a.y, a.x - b.x);
+
+				m_normals.push_back(n);
+				m_offsets.push_back(n.dot(a));
+
+				m_bounds.left = std::min(m_bounds.left, a.x);
+				m_bounds.top = std::min(m_bounds.top, a.y);
+				m_bounds.right = std::max(m_bounds.right, a.x);
+				m_bounds.bottom = std::max(m_bounds.bottom, a.y);
+			}
+		}
+
+};
+
+ObjectPrototype::ObjectPrototype() :
+	m_impl()
+{
+	// empty
+}
+
+ObjectPrototype::ObjectPrototype(const CL_Pointf p_points[], int p_count) :
+	m_impl(new ObjectPrototypeImpl(p_points, p_count))
+{
+	// empty
+}
+
+ObjectPrototype::~ObjectPrototype()
+{
+	// empty
+}
+
+int ObjectPrototype::collide(
+		const CL_Pointf p_convex[], int p_convexCount,
+		CL_LineSegment2f p_contacts[], int p_maxContacts
+) const
+{
+	G_ASSERT(p_convexCount > 0 && p_convexCount <= MAX_CONVEX_POINTS);
+
+	// convex polygon bounds
+	float left = p_convex[0].x, right = p_convex[0].x;
+	float top = p_convex[0].y, bottom = p_convex[0].y;
+
+	for (int i = 1; i < p_convexCount; ++i) {
+		left = std::min(left, p_convex[i].x);
+		right = std::max(right, p_convex[i].x);
+		top = std::min(top, p_convex[i].y);
+		bottom = std::max(bottom, p_convex[i].y);
+	}
+
+	const CL_Rectf &bounds = m_impl->m_bounds;
+
+	if (
+			left > bounds.right || right < bounds.left
+			|| top > bounds.bottom || bottom < bounds.top
+	) {
+		return 0;
+	}
+
+	// convex polygon edge normals and its projection on them
+	CL_Vec2f axes[MAX_CONVEX_POINTS];
+	float axisMin[MAX_CONVEX_POINTS], axisMax[MAX_CONVEX_POINTS];
+
+	for (int i = 0; i < p_convexCount; ++i) {
+		const CL_Pointf &a = p_convex[i];
+		const CL_Pointf &b = p_convex[(i + 1) % p_convexCount];
+
+		axes[i] = CL_Vec2f(b.y - a.y, a.x - b.x);
+		axisMin[i] = axisMax[i] = axes[i].dot(a);
+
+		for (int j = 0; j < p_convexCount; ++j) {
+			const float d = axes[i].dot(p_convex[j]);
+
+			axisMin[i] = std::min(axisMin[i], d);
+			axisMax[i] = std::max(axisMax[i], d);
+		}
+	}
+
+	const std::vector<CL_Pointf> &pts = m_impl->m_pts;
+	const int count = static_cast<signed>(pts.size());
+
+	int contactCount = 0;
+
+	for (int i = 0; i < count && contactCount < p_maxContacts; ++i) {
+		const CL_Pointf &a = pts[i];
+		const CL_Pointf &b = pts[(i + 1) % count];
+
+		// edge bounds
+		if (
+				std::min(a.x, b.x) > right || std::max(a.x, b.x) < left
+				|| std::min(a.y, b.y) > bottom || std::max(a.y, b.y) < top
+		) {
+			continue;
+		}
+
+		// separating axis test: edge normal
+		const CL_Vec2f &n = m_impl->m_normals[i];
+		const float offset = m_impl->m_offsets[i];
+
+		bool below = false, above = false;
+
+		for (int j = 0; j < p_convexCount; ++j) {
+			const float d = n.dot(p_convex[j]);
+
+			below = below || d <= offset;
+			above = above || d >= offset;
+		}
+
+		if (!below || !above) {
+			continue;
+		}
+
+		// separating axis test: convex polygon normals
+		bool separated = false;
+
+		for (int j = 0; j < p_convexCount && !separated; ++j) {
+			const float da = axes[j].dot(a);
+			const float db = axes[j].dot(b);
+
+			separated =
+					std::min(da, db) > axisMax[j]
+					|| std::max(da, db) < axisMin[j];
+		}
+
+		if (!separated) {
+			p_contacts[contactCount++] = CL_LineSegment2f(a, b);
+		}
+	}
+
+	return contactCount;
+}
+
+const CL_Rectf &ObjectPrototype::getBounds() const
+{
+	return m_impl->m_bounds;
+}
+
+const CL_Pointf &ObjectPrototype::getPoint(int p_idx) const
+{
+	G_ASSERT(p_idx >= 0 && p_idx < getPointCount());
+	return m_impl->m_pts[p_idx];
+}
+
+int ObjectPrototype::getPointCount() const
+{
+	return static_cast<signed>(
+			m_impl->m_pts.size()
+	);
+}
+
+bool ObjectPrototype::isNull() const
+{
+	return m_impl.is_null();
+}
+
+bool ObjectPrototype::operator==(const ObjectPrototype &p_other) const
+{
+	return m_impl.get() == p_other.m_impl.get();
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+
+namespace Race
+{
+
+class ObjectPrototypeImpl;
+
+/**
+ * Level object geometry with precomputed collision data.
+ * <p>
+ * Geometry is loaded once for every object definition and shared by all
+ * its placements (see Race::Object). Copies of prototype share the same
+ * data.
+ */
+class ObjectPrototype
+{
+	public:
+
+		/** Maximum number of points of polygon passed to collide() */
+		static const int MAX_CONVEX_POINTS = 8;
+
+
+		/** Creates null prototype */
+		ObjectPrototype();
+
+		/**
+		 * Build prototype from <code>p_points</code>.
+		 * <p>
+		 * Points must be ordered in counter-clockwise order.
+		 *
+		 * @param p_points Points to build from.
+		 * @param p_count Number of points to read.
+		 */
+		ObjectPrototype(const CL_Pointf p_points[], int p_count);
+
+		virtual ~ObjectPrototype();
+
+
+		/** @return Axis aligned rectangle that contains all points */
+		const CL_Rectf &getBounds() const;
+
+		const CL_Pointf &getPoint(int p_idx) const;
+
+		int getPointCount() const;
+
+		bool isNull() const;
+
+
+		/**
+		 * Finds prototype edges that touch convex polygon
+		 * <code>p_convex</code> (given in prototype space).
+		 * <p>
+		 * Each touching edge is written once to <code>p_contacts</code> as
+		 * a segment running in points order. Nothing is allocated and the
+		 * prototype is not modified, so it's safe to call this method
+		 * from many threads at once.
+		 *
+		 * @param p_convex Convex polygon points (at most MAX_CONVEX_POINTS).
+		 * @param p_convexCount Number of convex polygon points.
+		 * @param p_contacts Storage for touching edges.
+		 * @param p_maxContacts Size of <code>p_contacts</code>.
+		 * @return Number of contacts written.
+		 */
+		int collide(
+				const CL_Pointf p_convex[], int p_convexCount,
+				CL_LineSegment2f p_contacts[], int p_maxContacts
+		) const;
+
+
+		/** @return true if both prototypes share the same geometry */
+		bool operator==(const ObjectPrototype &p_other) const;
+
+
+	private:
+
+		CL_SharedPtr<ObjectPrototypeImpl> m_impl;
+};
+
+}
@@ -106,4 +106,10 @@ void Track::clear()
 	m_impl->m_trackPoints.clear();
 }
 
+void Track::reserve(int p_count)
+{
+	G_ASSERT(p_count >= 0);
+	m_impl->m_trackPoints.reserve(p_count);
+}
+
 } // namespace
@@ -66,6 +66,9 @@ class Track {
 
 		void clear();
 
+		/** Preallocates space for <code>p_count</code> points */
+		void reserve(int p_count);
+
 
 		// points accessors
 
@@ -33,36 +33,39 @@
 namespace Race
 {
 
-class TrackSegmentImpl
+TrackSegment::TrackSegment() :
+	m_triArena(NULL),
+	m_midArena(NULL),
+	m_midBegin(0),
+	m_midCount(0)
 {
-	public:
-
-		std::vector<CL_Pointf> m_triPoints;
-
-		std::vector<CL_Pointf> m_midPoints;
-
-		CL_Rectf m_bounds;
-
-
-		TrackSegmentImpl(
-				const std::vector<CL_Pointf> &p_triPoints,
-				const std::vector<CL_Pointf> &p_midPoints
-		) :
-			m_triPoints(p_triPoints),
-			m_midPoints(p_midPoints)
-		{ /* empty */ }
-
-
-		void calculateBounds();
-};
+	for (int lod = 0; lod < LOD_COUNT; ++lod) {
+		m_triBegin[lod] = 0;
+		m_triCount[lod] = 0;
+	}
+}
 
 TrackSegment::TrackSegment(
-		const std::vector<CL_Pointf> &p_triPoints,
-		const std::vector<CL_Pointf> &p_midPoints
+		const std::vector<CL_Pointf> *p_triArena,
+		const int p_triBegin[LOD_COUNT], const int p_triCount[LOD_COUNT],
+		const std::vector<CL_Pointf> *p_midArena,
+		int p_midBegin, int p_midCount
 ) :
-	m_impl(new TrackSegmentImpl(p_triPoints, p_midPoints))
+	m_triArena(p_triArena),
+	m_midArena(p_midArena),
+	m_midBegin(p_midBegin),
+	m_midCount(p_midCount)
 {
-	m_impl->calculateBounds();
+	for (int lod = 0; lod < LOD_COUNT; ++lod) {
+		G_ASSERT(p_triBegin[lod] + p_triCount[lod] <= static_cast<signed>(p_triArena->size()));
+
+		m_triBegin[lod] = p_triBegin[lod];
+		m_triCount[lod] = p_triCount[lod];
+	}
+
+	G_ASSERT(p_midBegin + p_midCount <= static_cast<signed>(p_midArena->size()));
+
+	calculateBounds();
 }
 
 TrackSegment::~TrackSegment()
@@ -70,13 +73,15 @@ TrackSegment::~TrackSegment()
 	// empty
 }
 
-void TrackSegmentImpl::calculateBounds()
+void TrackSegment::calculateBounds()
 {
-	bool first = true;
+	// the most detailed mesh covers the others
+	const CL_Pointf *points = getTrianglePoints(0);
 
-	foreach (const CL_Pointf &p, m_triPoints) {
+	for (int i = 0; i < m_triCount[0]; ++i) {
+		const CL_Pointf &p = points[i];
 
-		if (!first) {
+		if (i != 0) {
 			if (p.x < m_bounds.left) {
 				m_bounds.left = p.x;
 			} else if (p.x > m_bounds.right) {
@@ -93,25 +98,44 @@ void TrackSegmentImpl::calculateBounds()
 			m_bounds.right = p.x;
 			m_bounds.top = p.y;
 			m_bounds.bottom = p.y;
-
-			first = false;
 		}
 	}
 }
 
 const CL_Rectf &TrackSegment::getBounds() const
 {
-	return m_impl->m_bounds;
+	return m_bounds;
+}
+
+const CL_Pointf *TrackSegment::getMidPoints() const
+{
+	if (m_midCount == 0) {
+		return NULL;
+	}
+
+	return &(*m_midArena)[m_midBegin];
+}
+
+int TrackSegment::getMidPointCount() const
+{
+	return m_midCount;
 }
 
-const std::vector<CL_Pointf> &TrackSegment::getMidPoints() const
+const CL_Pointf *TrackSegment::getTrianglePoints(int p_lod) const
 {
-	return m_impl->m_midPoints;
+	G_ASSERT(p_lod >= 0 && p_lod < LOD_COUNT);
+
+	if (m_triCount[p_lod] == 0) {
+		return NULL;
+	}
+
+	return &(*m_triArena)[m_triBegin[p_lod]];
 }
 
-const std::vector<CL_Pointf> &TrackSegment::getTrianglePoints() const
+int TrackSegment::getTrianglePointCount(int p_lod) const
 {
-	return m_impl->m_triPoints;
+	G_ASSERT(p_lod >= 0 && p_lod < LOD_COUNT);
+	return m_triCount[p_lod];
 }
 
 }
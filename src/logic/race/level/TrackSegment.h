@@ -35,16 +35,29 @@
 namespace Race
 {
 
-class TrackSegmentImpl;
-
+/**
+ * View of single track segment triangulation data. Points are not
+ * owned by the segment. They are stored in arenas of TrackTriangulator
+ * that are shared by all segments, so segment is valid only as long
+ * as its triangulator is not changed.
+ */
 class TrackSegment
 {
 
 	public:
 
+		/** Number of triangle meshes with decreasing detail */
+		static const int LOD_COUNT = 3;
+
+
+		/** Constructs empty segment */
+		TrackSegment();
+
 		TrackSegment(
-				const std::vector<CL_Pointf> &p_triPoints,
-				const std::vector<CL_Pointf> &p_midPoints
+				const std::vector<CL_Pointf> *p_triArena,
+				const int p_triBegin[LOD_COUNT], const int p_triCount[LOD_COUNT],
+				const std::vector<CL_Pointf> *p_midArena,
+				int p_midBegin, int p_midCount
 		);
 
 		virtual ~TrackSegment();
@@ -54,15 +67,33 @@ class TrackSegment
 		const CL_Rectf &getBounds() const;
 
 		/** @return Middle track points from what track was constructed. */
-		const std::vector<CL_Pointf> &getMidPoints() const;
+		const CL_Pointf *getMidPoints() const;
+
+		int getMidPointCount() const;
+
+		/**
+		 * @param p_lod Level of detail. Zero is the most detailed one.
+		 * @return Triangle vertices, three per triangle
+		 */
+		const CL_Pointf *getTrianglePoints(int p_lod = 0) const;
 
-		const std::vector<CL_Pointf> &getTrianglePoints() const;
+		int getTrianglePointCount(int p_lod = 0) const;
 
 
 	private:
 
-		CL_SharedPtr<TrackSegmentImpl> m_impl;
+		const std::vector<CL_Pointf> *m_triArena;
+
+		int m_triBegin[LOD_COUNT], m_triCount[LOD_COUNT];
+
+		const std::vector<CL_Pointf> *m_midArena;
+
+		int m_midBegin, m_midCount;
+
+		CL_Rectf m_bounds;
+
+
+		void calculateBounds();
 };
 
 }
-
@@ -28,20 +28,24 @@
 
 #include "TrackTriangulator.h"
 
-#include <map>
+#include <algorithm>
 #include <vector>
 
 #include "common.h"
 #include "common/LoopVector.h"
 #include "math/Integer.h"
+#include "logic/race/level/Centreline.h"
 #include "logic/race/level/Track.h"
 #include "logic/race/level/TrackPoint.h"
 #include "logic/race/level/TrackSegment.h"
 
 namespace Race {
 
-/** Resolution of curves (in degrees). Lower is better, but slower. */
-const float CURVE_RESOLUTION = 6.0f;
+/**
+ * Maximal distance between curve and its tessellation for each level
+ * of detail (in screen units). Lower is better, but slower.
+ */
+const float LOD_TOLERANCE[TrackSegment::LOD_COUNT] = { 0.5f, 2.0f, 8.0f };
 
 
 class TrackTriangulatorImpl
@@ -53,26 +57,123 @@ class TrackTriangulatorImpl
 			S_RIGHT
 		};
 
-		typedef std::map<int, CL_SharedPtr<TrackSegment> > TIntSegmentMap;
+		/** Triangulation output of one segment before packing */
+		struct SegmentData {
+			std::vector<CL_Pointf> m_triPoints[TrackSegment::LOD_COUNT];
+			std::vector<CL_Pointf> m_midPoints;
+			CL_Vec2f m_guide;
+		};
+
+		typedef std::vector<SegmentData> TSegmentDataList;
+
+
+		/** Triangle points of all segments */
+		std::vector<CL_Pointf> m_triArena;
+
+		/** Mid points of all segments */
+		std::vector<CL_Pointf> m_midArena;
+
+		/** Segment ranges in arenas, indexed by segment */
+		std::vector<TrackSegment> m_segments;
+
+		std::vector<CL_Vec2f> m_guides;
+
+		Centreline m_centreline;
 
-		typedef std::map<int, CL_Vec2f> TIntGuideMap;
+		/** Incremented whenever triangulation output changes */
+		unsigned m_revision;
 
 
-		TIntSegmentMap m_intSegMap;
+		TrackTriangulatorImpl() :
+			m_revision(0)
+		{ /* empty */ }
 
-		TIntGuideMap m_intGuideMap;
+		void buildCentreline();
+
+		/**
+		 * Appends points of cubic Bezier curve (without the first one)
+		 * so the distance between curve and output lines is not greater
+		 * than <code>p_tolerance</code>.
+		 */
+		void flatten(
+				const CL_Pointf &p_p0, const CL_Pointf &p_p1,
+				const CL_Pointf &p_p2, const CL_Pointf &p_p3,
+				float p_tolerance, int p_depth,
+				std::vector<CL_Pointf> *p_out
+		) const;
 
 		CL_Vec2f helper(const Track &p_track, int p_index, Side p_side) const;
 
-		float interpolate(float p_pos, float p_prev, float p_next);
+		float interpolate(float p_pos, float p_prev, float p_next) const;
+
+		float lengthTotal(const std::vector<CL_Pointf> &p_points) const;
 
-		float lengthTotal(const std::vector<CL_Pointf> &p_points);
+		/** Replaces arenas content with given segments */
+		void pack(const TSegmentDataList &p_data);
 
 		std::vector<TrackPoint> toTrackPoints(
 				const std::vector<CL_Pointf> &p_points,
 				float p_prevRadius, float p_nextRadius,
 				float p_prevShift, float p_nextShift
-		);
+		) const;
+
+		void toTriangles(
+				const std::vector<TrackPoint> &p_trackPoints,
+				std::vector<CL_Pointf> *p_triPoints
+		) const;
+
+		void triangulateAll(const Track &p_track);
+
+		/**
+		 * Calculates single segment. It depends only on the track
+		 * so it can be called from many threads at once.
+		 */
+		void triangulateSegment(
+				const Track &p_track,
+				int p_segment,
+				SegmentData *p_data
+		) const;
+
+		/** Copies segment data back from arenas */
+		void unpack(int p_segment, SegmentData *p_data) const;
+};
+
+/** Triangulates every n-th segment of the track */
+class TriangulateWorker : public CL_Runnable
+{
+	public:
+
+		TriangulateWorker(
+				const TrackTriangulatorImpl &p_impl,
+				const Track &p_track,
+				TrackTriangulatorImpl::TSegmentDataList &p_data,
+				int p_first, int p_step
+		) :
+			m_impl(p_impl),
+			m_track(p_track),
+			m_data(p_data),
+			m_first(p_first),
+			m_step(p_step)
+		{ /* empty */ }
+
+		virtual void run()
+		{
+			const int segCount = static_cast<signed>(m_data.size());
+
+			for (int i = m_first; i < segCount; i += m_step) {
+				m_impl.triangulateSegment(m_track, i, &m_data[i]);
+			}
+		}
+
+	private:
+
+		const TrackTriangulatorImpl &m_impl;
+
+		const Track &m_track;
+
+		TrackTriangulatorImpl::TSegmentDataList &m_data;
+
+		const int m_first, m_step;
 };
 
 TrackTriangulator::TrackTriangulator() :
@@ -117,7 +218,7 @@ CL_Vec2f TrackTriangulatorImpl::helper(const Track &p_track, int p_index, TrackT
 	return middleNextVec;
 }
 
-float TrackTriangulatorImpl::lengthTotal(const std::vector<CL_Pointf> &p_points)
+float TrackTriangulatorImpl::lengthTotal(const std::vector<CL_Pointf> &p_points) const
 {
 	float len = 0.0f;
 	const int size = static_cast<signed>(p_points.size());
@@ -134,7 +235,7 @@ float TrackTriangulatorImpl::lengthTotal(const std::vector<CL_Pointf> &p_points)
 	return len;
 }
 
-float TrackTriangulatorImpl::interpolate(float p_pos, float p_prev, float p_next)
+float TrackTriangulatorImpl::interpolate(float p_pos, float p_prev, float p_next) const
 {
 	G_ASSERT(p_pos >= 0.0f && p_pos <= 1.0f);
 
@@ -146,7 +247,7 @@ std::vector<TrackPoint> TrackTriangulatorImpl::toTrackPoints(
 		const std::vector<CL_Pointf> &p_points,
 		float p_prevRadius, float p_nextRadius,
 		float p_prevShift, float p_nextShift
-)
+) const
 {
 	std::vector<TrackPoint> trackPoints;
 
@@ -190,130 +291,400 @@ void TrackTriangulator::triangulate(const Track &p_track, int p_segment)
 	G_ASSERT(p_segment >= -1 && p_segment <= pointCount);
 
 	if (p_segment == -1) {
+		m_impl->triangulateAll(p_track);
+	} else {
 
-		clear();
+		// other segments are kept, so copy them out before repacking
+		const int oldCount = static_cast<signed>(m_impl->m_segments.size());
+		const int segCount = std::max(oldCount, p_segment + 1);
 
-		for (int i = 0; i < pointCount; ++i) {
-			triangulate(p_track, i);
-		}
+		TrackTriangulatorImpl::TSegmentDataList data(segCount);
 
-	} else {
+		for (int i = 0; i < segCount; ++i) {
+			if (i == p_segment) {
+				m_impl->triangulateSegment(p_track, i, &data[i]);
+			} else if (i < oldCount) {
+				m_impl->unpack(i, &data[i]);
+			}
+		}
 
-		CL_BezierCurve curve;
-		const int prevIdx = p_segment;
-		const int nextIdx =
-				Math::Integer::clamp(p_segment + 1, 0, pointCount - 1);
+		m_impl->pack(data);
 
-		const TrackPoint &prev = p_track.getPoint(prevIdx);
-		const TrackPoint &next = p_track.getPoint(nextIdx);
+		// rebuild centreline when all segments are ready
+		if (segCount == pointCount) {
+			m_impl->buildCentreline();
+		}
+	}
 
+}
 
-		const CL_Vec2f prevHelper = m_impl->helper(
-				p_track,
-				prevIdx,
-				TrackTriangulatorImpl::S_RIGHT
+void TrackTriangulatorImpl::triangulateAll(const Track &p_track)
+{
+	// minimal amount of segments that is worth a thread
+	static const int SEGMENTS_PER_THREAD = 16;
+
+	const int segCount = p_track.getPointCount();
+	TSegmentDataList data(segCount);
+
+	const int threadCount = std::max(
+			1,
+			std::min(CL_System::get_num_cores(), segCount / SEGMENTS_PER_THREAD)
+	);
+
+	// segments depend only on track points, so every worker
+	// takes every n-th segment and writes to its own output
+	std::vector<CL_SharedPtr<TriangulateWorker> > workers;
+	std::vector<CL_SharedPtr<CL_Thread> > threads;
+
+	for (int i = 0; i < threadCount; ++i) {
+		workers.push_back(
+				CL_SharedPtr<TriangulateWorker>(
+						new TriangulateWorker(*this, p_track, data, i, threadCount)
+				)
 		);
+	}
+
+	for (int i = 1; i < threadCount; ++i) {
+		threads.push_back(CL_SharedPtr<CL_Thread>(new CL_Thread()));
+		threads.back()->start(workers[i].get());
+	}
+
+	// current thread does its part too
+	workers[0]->run();
+
+	foreach (CL_SharedPtr<CL_Thread> &thread, threads) {
+		thread->join();
+	}
+
+	pack(data);
+	buildCentreline();
+
+	cl_log_event(
+			LOG_DEBUG,
+			"triangulated %1 segments using %2 threads",
+			segCount, threadCount
+	);
+}
+
+void TrackTriangulatorImpl::triangulateSegment(
+		const Track &p_track,
+		int p_segment,
+		SegmentData *p_data
+) const
+{
+	const int pointCount = p_track.getPointCount();
+
+	const int prevIdx = p_segment;
+	const int nextIdx =
+			Math::Integer::clamp(p_segment + 1, 0, pointCount - 1);
+
+	const TrackPoint &prev = p_track.getPoint(prevIdx);
+	const TrackPoint &next = p_track.getPoint(nextIdx);
 
-		const CL_Vec2f nextHelper = m_impl->helper(
-				p_track,
-				nextIdx,
-				TrackTriangulatorImpl::S_LEFT
-		);
 
+	const CL_Vec2f prevHelper = helper(
+			p_track,
+			prevIdx,
+			TrackTriangulatorImpl::S_RIGHT
+	);
 
-		curve.add_control_point(prev.getPosition());
-		curve.add_control_point(prev.getPosition() + prevHelper);
-		curve.add_control_point(next.getPosition() + nextHelper);
-		curve.add_control_point(next.getPosition());
+	const CL_Vec2f nextHelper = helper(
+			p_track,
+			nextIdx,
+			TrackTriangulatorImpl::S_LEFT
+	);
 
-		std::vector<CL_Pointf> curvePoints = curve.generate_curve_points(CURVE_RESOLUTION);
+	const CL_Pointf p0 = prev.getPosition();
+	const CL_Pointf p1 = prev.getPosition() + prevHelper;
+	const CL_Pointf p2 = next.getPosition() + nextHelper;
+	const CL_Pointf p3 = next.getPosition();
+
+	std::vector<CL_Pointf> curvePoints;
+
+	for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+		curvePoints.clear();
+		curvePoints.push_back(p0);
+
+		flatten(p0, p1, p2, p3, LOD_TOLERANCE[lod], 0, &curvePoints);
 
 		// track points knows thier radius and shift (interpolated values)
-		std::vector<TrackPoint> trackPoints = m_impl->toTrackPoints(
+		std::vector<TrackPoint> trackPoints = toTrackPoints(
 				curvePoints,
 				prev.getRadius(), next.getRadius(),
 				prev.getShift(), next.getShift()
 		);
 
-		const int curveSize = static_cast<signed>(curvePoints.size());
-		G_ASSERT(static_cast<signed>(trackPoints.size()) == curveSize);
+		G_ASSERT(trackPoints.size() == curvePoints.size());
+
+		toTriangles(trackPoints, &p_data->m_triPoints[lod]);
+
+		// the most detailed curve is the track centreline
+		if (lod == 0) {
+			p_data->m_midPoints = curvePoints;
+		}
+	}
+
+	p_data->m_guide = prevHelper;
+}
 
-		std::vector<CL_Pointf> triPoints;
+void TrackTriangulatorImpl::flatten(
+		const CL_Pointf &p_p0, const CL_Pointf &p_p1,
+		const CL_Pointf &p_p2, const CL_Pointf &p_p3,
+		float p_tolerance, int p_depth,
+		std::vector<CL_Pointf> *p_out
+) const
+{
+	// straight segments still need few points to make triangles
+	// and follow radius changes
+	static const int MIN_DEPTH = 2;
 
-		CL_Pointf lastLeftPoint, lastRightPoint;
-		bool first = true;
+	// protection against degenerated control points
+	static const int MAX_DEPTH = 12;
 
-		for (int i = 1; i < curveSize; ++i) {
-			const TrackPoint &tprev = trackPoints[i - 1];
-			const TrackPoint &tnext = trackPoints[i];
+	// curve never goes further from its chord than control points,
+	// so their distance from the chord limits the chordal error
+	CL_Vec2f chord = p_p3 - p_p0;
+	const float chordLength = chord.length();
 
-			const CL_Pointf prevPoint = tprev.getPosition();
-			const CL_Pointf nextPoint = tnext.getPosition();
+	float dist1, dist2;
 
-			CL_Vec2f tvec = nextPoint - prevPoint;
-			tvec.normalize();
-			tvec *= tprev.getRadius();
+	if (chordLength > 0.0001f) {
+		chord /= chordLength;
 
-			// calculate left and right wing
-			CL_Vec2f leftVec(tvec.y, -tvec.x); // due to inverted Y the left side is actually a right side
-			CL_Vec2f rightVec(-leftVec.x, -leftVec.y);
+		const CL_Vec2f v1 = p_p1 - p_p0;
+		const CL_Vec2f v2 = p_p2 - p_p0;
 
-			leftVec += leftVec * (tprev.getShift() * -1);
-			rightVec += rightVec * tprev.getShift();
+		dist1 = fabs(v1.x * chord.y - v1.y * chord.x);
+		dist2 = fabs(v2.x * chord.y - v2.y * chord.x);
+	} else {
+		dist1 = p_p0.distance(p_p1);
+		dist2 = p_p0.distance(p_p2);
+	}
 
-			if (!first) {
+	const bool flat = std::max(dist1, dist2) <= p_tolerance;
 
-				const CL_Pointf leftPoint = prevPoint + leftVec;
-				const CL_Pointf rightPoint = prevPoint + rightVec;
+	if ((flat && p_depth >= MIN_DEPTH) || p_depth == MAX_DEPTH) {
+		p_out->push_back(p_p3);
+		return;
+	}
 
-				// got 4 points, can make two triangles
-				triPoints.push_back(lastLeftPoint);
-				triPoints.push_back(lastRightPoint);
-				triPoints.push_back(rightPoint);
+	// de Casteljau split in half
+	const CL_Pointf p01 = (p_p0 + p_p1) * 0.5f;
+	const CL_Pointf p12 = (p_p1 + p_p2) * 0.5f;
+	const CL_Pointf p23 = (p_p2 + p_p3) * 0.5f;
+	const CL_Pointf p012 = (p01 + p12) * 0.5f;
+	const CL_Pointf p123 = (p12 + p23) * 0.5f;
+	const CL_Pointf mid = (p012 + p123) * 0.5f;
 
-				triPoints.push_back(lastLeftPoint);
-				triPoints.push_back(rightPoint);
-				triPoints.push_back(leftPoint);
+	flatten(p_p0, p01, p012, mid, p_tolerance, p_depth + 1, p_out);
+	flatten(mid, p123, p23, p_p3, p_tolerance, p_depth + 1, p_out);
+}
 
-			} else {
-				first = false;
-			}
+void TrackTriangulatorImpl::toTriangles(
+		const std::vector<TrackPoint> &p_trackPoints,
+		std::vector<CL_Pointf> *p_triPoints
+) const
+{
+	std::vector<CL_Pointf> &triPoints = *p_triPoints;
+	triPoints.clear();
 
-			lastLeftPoint = prevPoint + leftVec;
-			lastRightPoint = prevPoint + rightVec;
+	const int curveSize = static_cast<signed>(p_trackPoints.size());
+
+	CL_Pointf lastLeftPoint, lastRightPoint;
+	bool first = true;
+
+	for (int i = 1; i < curveSize; ++i) {
+		const TrackPoint &tprev = p_trackPoints[i - 1];
+		const TrackPoint &tnext = p_trackPoints[i];
+
+		const CL_Pointf prevPoint = tprev.getPosition();
+		const CL_Pointf nextPoint = tnext.getPosition();
+
+		CL_Vec2f tvec = nextPoint - prevPoint;
+		tvec.normalize();
+		tvec *= tprev.getRadius();
+
+		// calculate left and right wing
+		CL_Vec2f leftVec(tvec.y, -tvec.x); // due to inverted Y the left side is actually a right side
+		CL_Vec2f rightVec(-leftVec.x, -leftVec.y);
+
+		leftVec += leftVec * (tprev.getShift() * -1);
+		rightVec += rightVec * tprev.getShift();
+
+		if (!first) {
+
+			const CL_Pointf leftPoint = prevPoint + leftVec;
+			const CL_Pointf rightPoint = prevPoint + rightVec;
+
+			// got 4 points, can make two triangles
+			triPoints.push_back(lastLeftPoint);
+			triPoints.push_back(lastRightPoint);
+			triPoints.push_back(rightPoint);
+
+			triPoints.push_back(lastLeftPoint);
+			triPoints.push_back(rightPoint);
+			triPoints.push_back(leftPoint);
+
+		} else {
+			first = false;
+		}
+
+		lastLeftPoint = prevPoint + leftVec;
+		lastRightPoint = prevPoint + rightVec;
+	}
+}
+
+void TrackTriangulatorImpl::pack(const TSegmentDataList &p_data)
+{
+	const int segCount = static_cast<signed>(p_data.size());
+
+	// count first to allocate arenas only once
+	int triTotal = 0, midTotal = 0;
+
+	foreach (const SegmentData &data, p_data) {
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			triTotal += static_cast<signed>(data.m_triPoints[lod].size());
+		}
+
+		midTotal += static_cast<signed>(data.m_midPoints.size());
+	}
+
+	m_triArena.clear();
+	m_midArena.clear();
+	m_segments.clear();
+	m_guides.clear();
+
+	++m_revision;
+
+	m_triArena.reserve(triTotal);
+	m_midArena.reserve(midTotal);
+	m_segments.reserve(segCount);
+	m_guides.reserve(segCount);
+
+	int triBegin[TrackSegment::LOD_COUNT];
+	int triCount[TrackSegment::LOD_COUNT];
+
+	foreach (const SegmentData &data, p_data) {
+
+		// levels of detail of one segment are stored together
+		for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+			triBegin[lod] = static_cast<signed>(m_triArena.size());
+			triCount[lod] = static_cast<signed>(data.m_triPoints[lod].size());
+
+			m_triArena.insert(
+					m_triArena.end(),
+					data.m_triPoints[lod].begin(), data.m_triPoints[lod].end()
+			);
 		}
 
-		// update triangle points in map
-		m_impl->m_intSegMap[p_segment] =
-				CL_SharedPtr<TrackSegment>(
-						new TrackSegment(triPoints, curvePoints)
+		const int midBegin = static_cast<signed>(m_midArena.size());
+
+		m_midArena.insert(
+				m_midArena.end(),
+				data.m_midPoints.begin(), data.m_midPoints.end()
+		);
+
+		m_segments.push_back(
+				TrackSegment(
+						&m_triArena, triBegin, triCount,
+						&m_midArena, midBegin, static_cast<signed>(data.m_midPoints.size())
+				)
 		);
 
-		// update direction vector
-		m_impl->m_intGuideMap[p_segment] = prevHelper;
+		m_guides.push_back(data.m_guide);
+	}
+}
+
+void TrackTriangulatorImpl::unpack(int p_segment, SegmentData *p_data) const
+{
+	const TrackSegment &seg = m_segments[p_segment];
+
+	for (int lod = 0; lod < TrackSegment::LOD_COUNT; ++lod) {
+		const CL_Pointf *tri = seg.getTrianglePoints(lod);
+		p_data->m_triPoints[lod].assign(tri, tri + seg.getTrianglePointCount(lod));
+	}
+
+	const CL_Pointf *mid = seg.getMidPoints();
+
+	p_data->m_midPoints.assign(mid, mid + seg.getMidPointCount());
+	p_data->m_guide = m_guides[p_segment];
+}
+
+void TrackTriangulator::assign(
+		const CL_Pointf *p_triPoints, int p_triCount,
+		const CL_Pointf *p_midPoints, int p_midCount,
+		const int *p_ranges, const CL_Vec2f *p_guides, int p_segCount
+)
+{
+	static const int RANGE_SIZE = 2 * TrackSegment::LOD_COUNT + 2;
+
+	m_impl->m_triArena.assign(p_triPoints, p_triPoints + p_triCount);
+	m_impl->m_midArena.assign(p_midPoints, p_midPoints + p_midCount);
+	m_impl->m_guides.assign(p_guides, p_guides + p_segCount);
+
+	++m_impl->m_revision;
+
+	m_impl->m_segments.clear();
+	m_impl->m_segments.reserve(p_segCount);
+
+	for (int i = 0; i < p_segCount; ++i) {
+		const int *range = p_ranges + i * RANGE_SIZE;
 
+		m_impl->m_segments.push_back(
+				TrackSegment(
+						&m_impl->m_triArena,
+						range, range + TrackSegment::LOD_COUNT,
+						&m_impl->m_midArena,
+						range[RANGE_SIZE - 2], range[RANGE_SIZE - 1]
+				)
+		);
 	}
 
+	m_impl->buildCentreline();
+}
+
+void TrackTriangulatorImpl::buildCentreline()
+{
+	// segments are stored one after another
+	m_centreline.build(m_midArena);
+}
+
+const Centreline &TrackTriangulator::getCentreline() const
+{
+	return m_impl->m_centreline;
 }
 
 const TrackSegment &TrackTriangulator::getSegment(int p_index) const
 {
-	TrackTriangulatorImpl::TIntSegmentMap::const_iterator itor =
-			m_impl->m_intSegMap.find(p_index);
+	G_ASSERT(
+			p_index >= 0
+			&& p_index < static_cast<signed>(m_impl->m_segments.size())
+			&& "segment not triangulated"
+	);
+
+	return m_impl->m_segments[p_index];
+}
 
-	G_ASSERT(itor != m_impl->m_intSegMap.end() && "segment not triangulated");
+unsigned TrackTriangulator::getRevision() const
+{
+	return m_impl->m_revision;
+}
 
-	return *(itor->second);
+float TrackTriangulator::getLodTolerance(int p_lod)
+{
+	G_ASSERT(p_lod >= 0 && p_lod < TrackSegment::LOD_COUNT);
+	return LOD_TOLERANCE[p_lod];
 }
 
 const CL_Vec2f &TrackTriangulator::getGuide(int p_pointIndex) const
 {
-	TrackTriangulatorImpl::TIntGuideMap::const_iterator itor =
-			m_impl->m_intGuideMap.find(p_pointIndex);
+	G_ASSERT(
+			p_pointIndex >= 0
+			&& p_pointIndex < static_cast<signed>(m_impl->m_guides.size())
+			&& "segment not triangulated"
+	);
 
-	G_ASSERT(itor != m_impl->m_intGuideMap.end() && "segment not triangulated");
-
-	return itor->second;
+	return m_impl->m_guides[p_pointIndex];
 }
 
 const CL_Pointf &TrackTriangulator::getFirstLeftPoint(int p_segIndex) const
@@ -331,22 +702,24 @@ const CL_Pointf &TrackTriangulator::getFirstRightPoint(int p_segIndex) const
 const CL_Pointf &TrackTriangulator::getLastLeftPoint(int p_segIndex) const
 {
 	const TrackSegment &seg = getSegment(p_segIndex);
-	const std::vector<CL_Pointf> &pts = seg.getTrianglePoints();
-
-	return pts[pts.size() - 1];
+	return seg.getTrianglePoints()[seg.getTrianglePointCount() - 1];
 }
 
 const CL_Pointf &TrackTriangulator::getLastRightPoint(int p_segIndex) const
 {
 	const TrackSegment &seg = getSegment(p_segIndex);
-	const std::vector<CL_Pointf> &pts = seg.getTrianglePoints();
-
-	return pts[pts.size() - 2];
+	return seg.getTrianglePoints()[seg.getTrianglePointCount() - 2];
 }
 
 void TrackTriangulator::clear()
 {
-	m_impl->m_intSegMap.clear();
+	m_impl->m_segments.clear();
+	m_impl->m_guides.clear();
+	m_impl->m_triArena.clear();
+	m_impl->m_midArena.clear();
+	m_impl->m_centreline.clear();
+
+	++m_impl->m_revision;
 }
 
 } // namespace
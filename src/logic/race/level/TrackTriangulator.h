@@ -33,6 +33,7 @@
 namespace Race
 {
 
+class Centreline;
 class Track;
 class TrackSegment;
 
@@ -55,9 +56,34 @@ class TrackTriangulator
 
 		virtual ~TrackTriangulator();
 
+		/**
+		 * Replaces triangulation with precomputed data (i.e. from
+		 * compiled level).
+		 *
+		 * @param p_triPoints Triangle points of all segments.
+		 * @param p_midPoints Mid points of all segments.
+		 * @param p_ranges For each segment: first triangle point index
+		 * and triangle point count of each level of detail, then first
+		 * mid point index and mid point count.
+		 * @param p_guides Guide vector of each segment.
+		 */
+		void assign(
+				const CL_Pointf *p_triPoints, int p_triCount,
+				const CL_Pointf *p_midPoints, int p_midCount,
+				const int *p_ranges, const CL_Vec2f *p_guides, int p_segCount
+		);
+
 		/** Removes all triangulation data. */
 		void clear();
 
+		/**
+		 * Provides the line that goes through the middle of the track.
+		 * It is available only when all segments are triangulated.
+		 *
+		 * @return Arc length parameterized track centreline.
+		 */
+		const Centreline &getCentreline() const;
+
 		/** @return First left side point from selected segment */
 		const CL_Pointf &getFirstLeftPoint(int p_segIndex) const;
 
@@ -80,6 +106,18 @@ class TrackTriangulator
 		 */
 		const CL_Vec2f &getGuide(int p_pointIndex) const;
 
+		/**
+		 * @return Maximal distance between track curve and triangles
+		 * of given level of detail (in screen units).
+		 */
+		static float getLodTolerance(int p_lod);
+
+		/**
+		 * @return Number that changes every time triangulation data
+		 * is replaced, so derived data can tell if it is out of date.
+		 */
+		unsigned getRevision() const;
+
 		const TrackSegment &getSegment(int p_segIndex) const;
 
 		/**
@@ -163,7 +163,7 @@ bool Geometry::contains(const CL_Pointf &p_point) const
 				break;
 			case Primitive::IT_AND:
 				result = result && pr->contains(p_point);
-
+				break;
 			default:
 				G_ASSERT(0 && "unknown InsertionType");
 		}
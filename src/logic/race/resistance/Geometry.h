@@ -59,6 +59,9 @@ class Geometry : public boost::noncopyable {
 
 		bool contains(const CL_Pointf &p_point) const;
 
+		/** @return true if no primitive was added */
+		bool isEmpty() const { return m_primitives.empty(); }
+
 		void subtractCircle(const CL_Circlef &p_circle);
 
 		void subtractRect(const CL_Rectf &p_rectangle);
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ResistanceGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "common.h"
+#include "Geometry.h"
+
+namespace RaceResistance {
+
+ResistanceGrid::ResistanceGrid() :
+	m_cellSize(1.0f),
+	m_invCellSize(1.0f),
+	m_width(0),
+	m_height(0),
+	m_step(1.0f),
+	m_outside(0),
+	m_tileCols(0)
+{
+}
+
+ResistanceGrid::~ResistanceGrid()
+{
+}
+
+void ResistanceGrid::create(
+		const CL_Rectf &p_bounds,
+		float p_cellSize,
+		float p_maxValue,
+		float p_fillValue
+)
+{
+	G_ASSERT(p_cellSize > 0.0f);
+	G_ASSERT(p_maxValue > 0.0f);
+
+	clear();
+
+	const float w = p_bounds.get_width();
+	const float h = p_bounds.get_height();
+
+	m_cellSize = p_cellSize;
+	m_invCellSize = 1.0f / m_cellSize;
+
+	m_origin = CL_Pointf(p_bounds.left, p_bounds.top);
+
+	m_width = std::max(1, static_cast<int>(ceil(w * m_invCellSize)));
+	m_height = std::max(1, static_cast<int>(ceil(h * m_invCellSize)));
+
+	m_tileCols = (m_width + TILE_SIDE - 1) / TILE_SIDE;
+
+	// tile keys must fit in int
+	G_ASSERT(
+			static_cast<double>(m_tileCols)
+			* ((m_height + TILE_SIDE - 1) / TILE_SIDE) < 2147483647.0
+	);
+
+	m_step = p_maxValue / 255.0f;
+	m_outside = quantize(p_fillValue);
+}
+
+void ResistanceGrid::clear()
+{
+	m_tileIndex.clear();
+	m_tiles.clear();
+	m_width = m_height = m_tileCols = 0;
+}
+
+unsigned char ResistanceGrid::quantize(float p_value) const
+{
+	const float q = floor(p_value / m_step + 0.5f);
+
+	if (q <= 0.0f) {
+		return 0;
+	}
+
+	if (q >= 255.0f) {
+		return 255;
+	}
+
+	return static_cast<unsigned char>(q);
+}
+
+int ResistanceGrid::findTile(int p_x, int p_y) const
+{
+	const int key = (p_y / TILE_SIDE) * m_tileCols + p_x / TILE_SIDE;
+
+	const std::vector< std::pair<int, int> >::const_iterator itor =
+			std::lower_bound(
+					m_tileIndex.begin(), m_tileIndex.end(),
+					std::make_pair(key, -1)
+			);
+
+	if (itor == m_tileIndex.end() || itor->first != key) {
+		return -1;
+	}
+
+	return itor->second;
+}
+
+int ResistanceGrid::cellAt(int p_x, int p_y) const
+{
+	if (p_x < 0 || p_y < 0 || p_x >= m_width || p_y >= m_height) {
+		return m_outside;
+	}
+
+	const int tile = findTile(p_x, p_y);
+
+	if (tile == -1) {
+		return m_outside;
+	}
+
+	return m_tiles[
+			tile * TILE_SIDE * TILE_SIDE
+			+ (p_y % TILE_SIDE) * TILE_SIDE + p_x % TILE_SIDE
+	];
+}
+
+void ResistanceGrid::setCell(int p_x, int p_y, unsigned char p_value)
+{
+	G_ASSERT(p_x >= 0 && p_y >= 0 && p_x < m_width && p_y < m_height);
+
+	int tile = findTile(p_x, p_y);
+
+	if (tile == -1) {
+		// not allocated tile has the fill value everywhere
+		if (p_value == m_outside) {
+			return;
+		}
+
+		const int key = (p_y / TILE_SIDE) * m_tileCols + p_x / TILE_SIDE;
+		tile = static_cast<signed>(m_tileIndex.size());
+
+		m_tileIndex.insert(
+				std::lower_bound(
+						m_tileIndex.begin(), m_tileIndex.end(),
+						std::make_pair(key, -1)
+				),
+				std::make_pair(key, tile)
+		);
+
+		m_tiles.resize(m_tiles.size() + TILE_SIDE * TILE_SIDE, m_outside);
+	}
+
+	m_tiles[
+			tile * TILE_SIDE * TILE_SIDE
+			+ (p_y % TILE_SIDE) * TILE_SIDE + p_x % TILE_SIDE
+	] = p_value;
+}
+
+CL_Pointf ResistanceGrid::cellCentre(int p_x, int p_y) const
+{
+	return CL_Pointf(
+			m_origin.x + (p_x + 0.5f) * m_cellSize,
+			m_origin.y + (p_y + 0.5f) * m_cellSize
+	);
+}
+
+bool ResistanceGrid::cellRange(
+		float p_left, float p_top, float p_right, float p_bottom,
+		int *p_x0, int *p_y0, int *p_x1, int *p_y1
+) const
+{
+	// cells which centres may be inside
+	*p_x0 = std::max(0, static_cast<int>(ceil((p_left - m_origin.x) * m_invCellSize - 0.5f)));
+	*p_y0 = std::max(0, static_cast<int>(ceil((p_top - m_origin.y) * m_invCellSize - 0.5f)));
+	*p_x1 = std::min(m_width - 1, static_cast<int>(floor((p_right - m_origin.x) * m_invCellSize - 0.5f)));
+	*p_y1 = std::min(m_height - 1, static_cast<int>(floor((p_bottom - m_origin.y) * m_invCellSize - 0.5f)));
+
+	return *p_x0 <= *p_x1 && *p_y0 <= *p_y1;
+}
+
+void ResistanceGrid::fill(const Geometry &p_geometry, float p_value)
+{
+	if (p_geometry.isEmpty()) {
+		return;
+	}
+
+	const CL_Rectf &bounds = p_geometry.getBounds();
+	int x0, y0, x1, y1;
+
+	if (!cellRange(bounds.left, bounds.top, bounds.right, bounds.bottom, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+
+	const unsigned char value = quantize(p_value);
+
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			if (p_geometry.contains(cellCentre(x, y))) {
+				setCell(x, y, value);
+			}
+		}
+	}
+}
+
+void ResistanceGrid::fillTriangle(
+		const CL_Pointf &p_a, const CL_Pointf &p_b, const CL_Pointf &p_c,
+		float p_value
+)
+{
+	const float left = std::min(p_a.x, std::min(p_b.x, p_c.x));
+	const float top = std::min(p_a.y, std::min(p_b.y, p_c.y));
+	const float right = std::max(p_a.x, std::max(p_b.x, p_c.x));
+	const float bottom = std::max(p_a.y, std::max(p_b.y, p_c.y));
+
+	int x0, y0, x1, y1;
+
+	if (!cellRange(left, top, right, bottom, &x0, &y0, &x1, &y1)) {
+		return;
+	}
+
+	// works for both windings
+	const float area = (p_b.x - p_a.x) * (p_c.y - p_a.y) - (p_b.y - p_a.y) * (p_c.x - p_a.x);
+
+	if (area == 0.0f) {
+		return;
+	}
+
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+	const unsigned char value = quantize(p_value);
+
+	for (int y = y0; y <= y1; ++y) {
+		for (int x = x0; x <= x1; ++x) {
+			const CL_Pointf p = cellCentre(x, y);
+
+			const float e0 = (p_b.x - p_a.x) * (p.y - p_a.y) - (p_b.y - p_a.y) * (p.x - p_a.x);
+			const float e1 = (p_c.x - p_b.x) * (p.y - p_b.y) - (p_c.y - p_b.y) * (p.x - p_b.x);
+			const float e2 = (p_a.x - p_c.x) * (p.y - p_c.y) - (p_a.y - p_c.y) * (p.x - p_c.x);
+
+			if (e0 * sign >= 0.0f && e1 * sign >= 0.0f && e2 * sign >= 0.0f) {
+				setCell(x, y, value);
+			}
+		}
+	}
+}
+
+float ResistanceGrid::get(const CL_Pointf &p_point) const
+{
+	const float fx = (p_point.x - m_origin.x) * m_invCellSize;
+	const float fy = (p_point.y - m_origin.y) * m_invCellSize;
+
+	return cellAt(
+			static_cast<int>(floor(fx)),
+			static_cast<int>(floor(fy))
+	) * m_step;
+}
+
+float ResistanceGrid::sample(const CL_Pointf &p_point) const
+{
+	// position relative to cell centres
+	const float fx = (p_point.x - m_origin.x) * m_invCellSize - 0.5f;
+	const float fy = (p_point.y - m_origin.y) * m_invCellSize - 0.5f;
+
+	const float flx = floor(fx);
+	const float fly = floor(fy);
+
+	const int x = static_cast<int>(flx);
+	const int y = static_cast<int>(fly);
+
+	const float tx = fx - flx;
+	const float ty = fy - fly;
+
+	const float top =
+			cellAt(x, y) * (1.0f - tx) + cellAt(x + 1, y) * tx;
+	const float bottom =
+			cellAt(x, y + 1) * (1.0f - tx) + cellAt(x + 1, y + 1) * tx;
+
+	return (top * (1.0f - ty) + bottom * ty) * m_step;
+}
+
+} // namespace
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace RaceResistance {
+
+class Geometry;
+
+/**
+ * Resistance values baked into a regular grid.
+ * <p>
+ * Every cell keeps 8-bit value quantized in range from 0.0 to maximal
+ * value given on creation, so lookups cost the same no matter how
+ * complicated the source geometry was. Points outside of the grid have
+ * the fill value.
+ * <p>
+ * Cells are stored in square tiles allocated on first write of other
+ * than fill value, so cell size does not depend on the level size. Only
+ * tiles touched by the track and resistance geometries take memory.
+ */
+class ResistanceGrid {
+
+	public:
+
+		ResistanceGrid();
+
+		virtual ~ResistanceGrid();
+
+
+		/**
+		 * Creates the grid covering <code>p_bounds</code> filled with
+		 * <code>p_fillValue</code>.
+		 *
+		 * @param p_cellSize Cell side length.
+		 * @param p_maxValue Maximal value that can be stored.
+		 */
+		void create(
+				const CL_Rectf &p_bounds,
+				float p_cellSize,
+				float p_maxValue,
+				float p_fillValue
+		);
+
+		void clear();
+
+		/** Sets value of cells which centres are inside of geometry */
+		void fill(const Geometry &p_geometry, float p_value);
+
+		/** Sets value of cells which centres are inside of triangle */
+		void fillTriangle(
+				const CL_Pointf &p_a, const CL_Pointf &p_b, const CL_Pointf &p_c,
+				float p_value
+		);
+
+		bool isEmpty() const { return m_width == 0; }
+
+		float getCellSize() const { return m_cellSize; }
+
+		/** @return Value of cell containing <code>p_point</code> */
+		float get(const CL_Pointf &p_point) const;
+
+		/** @return Value bilinearly interpolated between cell centres */
+		float sample(const CL_Pointf &p_point) const;
+
+	private:
+
+		/** Number of cells on one side of a tile */
+		static const int TILE_SIDE = 32;
+
+		/** Grid origin */
+		CL_Pointf m_origin;
+
+		float m_cellSize, m_invCellSize;
+
+		int m_width, m_height;
+
+		/** Value of one quantization step */
+		float m_step;
+
+		/** Quantized value outside of the grid */
+		unsigned char m_outside;
+
+		/** Number of tile columns */
+		int m_tileCols;
+
+		/**
+		 * Allocated tiles sorted by key (tile row * m_tileCols + tile
+		 * column). Second value is tile index in m_tiles.
+		 */
+		std::vector< std::pair<int, int> > m_tileIndex;
+
+		/** Quantized cell values, tile by tile and row by row in a tile */
+		std::vector<unsigned char> m_tiles;
+
+
+		unsigned char quantize(float p_value) const;
+
+		/** @return Index of tile containing given cell or -1 if not allocated */
+		int findTile(int p_x, int p_y) const;
+
+		int cellAt(int p_x, int p_y) const;
+
+		/** Sets cell value, allocates its tile when needed */
+		void setCell(int p_x, int p_y, unsigned char p_value);
+
+		/** Computes cell range covering given rectangle */
+		bool cellRange(
+				float p_left, float p_top, float p_right, float p_bottom,
+				int *p_x0, int *p_y0, int *p_x1, int *p_y1
+		) const;
+
+		CL_Pointf cellCentre(int p_x, int p_y) const;
+};
+
+} // namespace
@@ -30,6 +30,7 @@
 
 #include "common.h"
 #include "Geometry.h"
+#include "ResistanceGrid.h"
 
 namespace RaceResistance {
 
@@ -51,12 +52,17 @@ void ResistanceMap::addGeometry(const CL_SharedPtr<Geometry> &p_geometry, float
 	m_resistances.push_back(res);
 }
 
-float ResistanceMap::resistance(const CL_Pointf &p_point)
+float ResistanceMap::resistance(const CL_Pointf &p_point) const
 {
 	float result = 0.0f;
 
 	foreach(const Resistance &res, m_resistances) {
 		const CL_SharedPtr<Geometry> &geom = res.m_geometry;
+
+		if (geom->isEmpty()) {
+			continue;
+		}
+
 		const CL_Rectf &bounds = geom->getBounds();
 
 		if (bounds.contains(p_point) && geom->contains(p_point)) {
@@ -67,6 +73,15 @@ float ResistanceMap::resistance(const CL_Pointf &p_point)
 	return result;
 }
 
+void ResistanceMap::bake(ResistanceGrid *p_grid) const
+{
+	G_ASSERT(p_grid && !p_grid->isEmpty());
+
+	foreach(const Resistance &res, m_resistances) {
+		p_grid->fill(*res.m_geometry, res.m_value);
+	}
+}
+
 void ResistanceMap::clear()
 {
 	m_resistances.clear();
@@ -35,6 +35,7 @@
 namespace RaceResistance {
 
 class Geometry;
+class ResistanceGrid;
 
 class ResistanceMap {
 
@@ -48,9 +49,19 @@ class ResistanceMap {
 		void addGeometry(const CL_SharedPtr<Geometry> &p_geometry, float p_resistanceValue);
 
 
+		/**
+		 * Writes all geometries into the grid. Geometry added later
+		 * overwrites previous ones.
+		 */
+		void bake(ResistanceGrid *p_grid) const;
+
 		void clear();
 
-		float resistance(const CL_Pointf &p_point);
+		/**
+		 * Tests every geometry, so prefer baked grid when querying
+		 * often.
+		 */
+		float resistance(const CL_Pointf &p_point) const;
 
 	private:
 
@@ -28,7 +28,6 @@
 
 #include "Float.h"
 
-#include <map>
 #include <math.h>
 
 #include "common.h"
@@ -52,76 +51,32 @@ float Float::reduce(float p_val, float p_min, float p_max)
 	return p_val;
 }
 
-class Animation {
-
-	public:
-
-		float m_from, m_to;
-
-		unsigned m_stime, m_etime;
-
-		unsigned m_dur;
-
-		const Easing *m_easing;
-};
-
-class FloatImpl
-{
-	public:
-
-		typedef std::map<size_t, Animation*> TAnimationMap;
-
-
-		/** Current value container */
-		float m_value;
-
-		/** Time registered from the beginning object life */
-		size_t m_timeFromStart;
-
-		/** Animations to do in time. Key is the start time. */
-		TAnimationMap m_animMap;
-
-		/** Currently running animation */
-		Animation *m_currAnim;
-
-
-		FloatImpl(float p_val) :
-			m_value(p_val),
-			m_timeFromStart(0),
-			m_currAnim(NULL)
-		{ /* empty */ }
-
-
-		void setCurrentAnimation(Animation *p_animation);
-
-		void update(unsigned p_timeElapsed);
-};
-
 Float::Float() :
-	m_impl(new FloatImpl(0.0f))
+	m_value(0.0f),
+	m_timeFromStart(0),
+	m_queueSize(0),
+	m_running(false)
 {
 	// empty
 }
 
 Float::Float(float p_val) :
-	m_impl(new FloatImpl(p_val))
-{
-	// empty
-}
-
-Float::~Float()
+	m_value(p_val),
+	m_timeFromStart(0),
+	m_queueSize(0),
+	m_running(false)
 {
 	// empty
 }
 
 float Float::get() const
 {
-	return m_impl->m_value;
+	return m_value;
 }
 
 void Float::set(float p_value)
 {
-	m_impl->m_value = p_value;
+	m_value = p_value;
 }
 
 void Float::animate(
@@ -131,68 +86,91 @@ void Float::animate(
 		unsigned p_delay
 )
 {
-	const unsigned startTime = m_impl->m_timeFromStart + p_delay;
+	const unsigned startTime = m_timeFromStart + p_delay;
+
+	Animation animation;
+	animation.m_from = p_startValue;
+	animation.m_to = p_endValue;
+	animation.m_stime = startTime;
+	animation.m_etime = startTime + p_duration;
+	animation.m_easing = &p_easing;
 
-	Animation *animation = new Animation();
-	animation->m_from = p_startValue;
-	animation->m_to = p_endValue;
-	animation->m_stime = startTime;
-	animation->m_etime = startTime + p_duration;
-	animation->m_easing = &p_easing;
+	// find place in queue ordered by start time
+	int pos = 0;
 
-	m_impl->m_animMap[startTime] = animation;
+	while (pos < m_queueSize && m_queue[pos].m_stime < startTime) {
+		++pos;
+	}
+
+	if (pos < m_queueSize && m_queue[pos].m_stime == startTime) {
+		m_queue[pos] = animation;
+	} else {
+		if (m_queueSize == MAX_QUEUED) {
+			// the one that starts last is dropped
+			if (pos == MAX_QUEUED) {
+				return;
+			}
+
+			--m_queueSize;
+		}
+
+		for (int i = m_queueSize; i > pos; --i) {
+			m_queue[i] = m_queue[i - 1];
+		}
+
+		m_queue[pos] = animation;
+		++m_queueSize;
+	}
 
 	// set start value if animation should start now
 	if (p_delay == 0) {
-		m_impl->m_value = p_startValue;
+		m_value = p_startValue;
 	}
 }
 
 void Float::update(unsigned p_timeElapsed)
-{
-	m_impl->update(p_timeElapsed);
-}
-
-void FloatImpl::update(unsigned p_timeElapsed)
 {
 	m_timeFromStart += p_timeElapsed;
 
-	// look for the next animation
-	if (!m_animMap.empty()) {
-		FloatImpl::TAnimationMap::iterator itor;
-		for (itor = m_animMap.begin(); itor != m_animMap.end();) {
-			if (itor->first <= m_timeFromStart) {
-				setCurrentAnimation(itor->second);
-				m_animMap.erase(itor++);
-			} else {
-				++itor;
-			}
+	// the latest animation that should have started is the current one
+	int started = 0;
+
+	while (started < m_queueSize && m_queue[started].m_stime <= m_timeFromStart) {
+		++started;
+	}
+
+	if (started > 0) {
+		m_currAnim = m_queue[started - 1];
+		m_running = true;
+
+		for (int i = started; i < m_queueSize; ++i) {
+			m_queue[i - started] = m_queue[i];
 		}
+
+		m_queueSize -= started;
 	}
 
-	if (m_currAnim != NULL) {
+	if (m_running) {
 
-		if (m_currAnim->m_etime <= m_timeFromStart) {
+		if (m_currAnim.m_etime <= m_timeFromStart) {
 			// animation should end now
-			m_value = m_currAnim->m_to;
-
-			delete m_currAnim;
-			m_currAnim = NULL;
+			m_value = m_currAnim.m_to;
+			m_running = false;
 
 		} else {
 
 			// make progress
 			const float progress =
-					(m_timeFromStart - m_currAnim->m_stime) /
+					(m_timeFromStart - m_currAnim.m_stime) /
 					static_cast<float> (
-							m_currAnim->m_etime - m_currAnim->m_stime
+							m_currAnim.m_etime - m_currAnim.m_stime
 					);
 
 			// this should be value between 0.0 and 1.0
 			G_ASSERT(progress >= 0.0f && progress <= 1.0f);
 
-			m_value = m_currAnim->m_easing->ease(
-					m_currAnim->m_from, m_currAnim->m_to,
+			m_value = m_currAnim.m_easing->ease(
+					m_currAnim.m_from, m_currAnim.m_to,
 					progress
 			);
 
@@ -200,13 +178,4 @@ void FloatImpl::update(unsigned p_timeElapsed)
 	}
 }
 
-void FloatImpl::setCurrentAnimation(Animation *p_animation)
-{
-	if (m_currAnim != NULL) {
-		delete m_currAnim;
-	}
-
-	m_currAnim = p_animation;
-}
-
 } // namespace
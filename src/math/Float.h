@@ -38,12 +38,20 @@ namespace Math {
 
 class Easing;
 
-class FloatImpl;
-
+/**
+ * Float value that can be animated in time.
+ * <p>
+ * It is a plain value type: queued animations are kept inline, so
+ * animating and updating never touches the heap.
+ */
 class Float {
 
 	public:
 
+		/** How many animations can wait for their start at once */
+		static const int MAX_QUEUED = 4;
+
+
 		static bool cmp(float p_a, float p_b, float p_precision);
 
 		static float reduce(float p_val, float p_min, float p_max);
@@ -53,12 +61,15 @@ class Float {
 
 		Float(float p_val);
 
-		virtual ~Float();
-
 
 		float get() const;
 
 
+		/**
+		 * Queues animation. Animation with the same start time as
+		 * already queued one replaces it. When MAX_QUEUED animations
+		 * are waiting, the one that starts last is dropped.
+		 */
 		void animate(
 				float p_startValue, float p_endValue,
 				unsigned p_duration,
@@ -80,7 +91,31 @@ class Float {
 
 	private:
 
-		CL_SharedPtr<FloatImpl> m_impl;
+		struct Animation {
+
+			float m_from, m_to;
+
+			unsigned m_stime, m_etime;
+
+			const Easing *m_easing;
+		};
+
+
+		/** Current value container */
+		float m_value;
+
+		/** Time registered from the beginning object life */
+		unsigned m_timeFromStart;
+
+		/** Animations to do in time, ordered by start time */
+		Animation m_queue[MAX_QUEUED];
+
+		int m_queueSize;
+
+		/** Currently running animation (valid if m_running) */
+		Animation m_currAnim;
+
+		bool m_running;
 
 };
 
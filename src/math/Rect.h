@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2009, Piotr Korzuszek
+ * Copyright (c) 2009-2010, Piotr Korzuszek
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,41 +26,33 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "Car.h"
+#pragma once
 
-#include <assert.h>
+#include <ClanLib/core.h>
 
-#include "gfx/Stage.h"
-
-namespace Gfx {
-
-Car::Car()
-{
-}
-
-Car::~Car()
+namespace Math
 {
-}
 
-void Car::load(CL_GraphicContext &p_gc)
+class Rect
 {
-	Drawable::load(p_gc);
+	public:
 
-	m_sprite = CL_Sprite(p_gc, "race/car", Stage::getResourceManager());
-}
+		/**
+		 * Unlike CL_Rectf::is_overlapped() accepts boxes of zero width
+		 * or height, like bounds of axis aligned segments.
+		 */
+		static bool overlaps(const CL_Rectf &p_a, const CL_Rectf &p_b)
+		{
+			return p_a.left <= p_b.right && p_a.right >= p_b.left
+					&& p_a.top <= p_b.bottom && p_a.bottom >= p_b.top;
+		}
 
-void Car::draw(CL_GraphicContext &p_gc)
-{
-	assert(isLoaded());
+	private:
 
-	p_gc.push_modelview();
+		Rect();
 
-	p_gc.mult_translate(m_position.x, m_position.y);
-	p_gc.mult_rotate(m_rotation, 0, 0, 1);
+		virtual ~Rect();
+};
 
-	m_sprite.draw(p_gc, 0, 0);
-
-	p_gc.pop_modelview();
 }
 
-}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "common.h"
+#include "math/Rect.h"
+
+namespace Math
+{
+
+UniformGrid::UniformGrid() :
+	m_cellSize(1.0f),
+	m_cols(0),
+	m_rows(0),
+	m_queryStamp(0)
+{
+	// empty
+}
+
+UniformGrid::~UniformGrid()
+{
+	// empty
+}
+
+void UniformGrid::clear()
+{
+	m_cols = m_rows = 0;
+	m_queryStamp = 0;
+
+	m_bounds.clear();
+	m_cells.clear();
+	m_cellBegin.clear();
+	m_items.clear();
+	m_overflow.clear();
+	m_visited.clear();
+}
+
+void UniformGrid::build(const std::vector<CL_Rectf> &p_bounds, float p_cellSize)
+{
+	G_ASSERT(p_cellSize > 0.0f);
+
+	clear();
+
+	const int itemCount = static_cast<signed>(p_bounds.size());
+
+	if (itemCount == 0) {
+		return;
+	}
+
+	m_bounds = p_bounds;
+	m_visited.assign(itemCount, 0);
+
+	CL_Rectf area = p_bounds[0];
+
+	foreach (const CL_Rectf &rect, p_bounds) {
+		area.bounding_rect(rect);
+	}
+
+	m_cellSize = p_cellSize;
+	m_origin = CL_Pointf(area.left, area.top);
+	m_cols = static_cast<int>(area.get_width() / m_cellSize) + 1;
+	m_rows = static_cast<int>(area.get_height() / m_cellSize) + 1;
+
+	// (cell, item) pair for every cell covered by an item
+	std::vector< std::pair<TCell, int> > entries;
+	entries.reserve(itemCount);
+
+	for (int i = 0; i < itemCount; ++i) {
+		const CL_Rectf &rect = p_bounds[i];
+
+		const int c1 = column(rect.left);
+		const int c2 = column(rect.right);
+		const int r1 = row(rect.top);
+		const int r2 = row(rect.bottom);
+
+		const float cellCount =
+				static_cast<float>(c2 - c1 + 1) * static_cast<float>(r2 - r1 + 1);
+
+		if (cellCount > MAX_ITEM_CELLS) {
+			m_overflow.push_back(i);
+			continue;
+		}
+
+		for (int r = r1; r <= r2; ++r) {
+			for (int c = c1; c <= c2; ++c) {
+				entries.push_back(std::make_pair(TCell(r, c), i));
+			}
+		}
+	}
+
+	std::sort(entries.begin(), entries.end());
+
+	// lay out items cell by cell
+	m_items.reserve(entries.size());
+
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (i == 0 || entries[i].first != entries[i - 1].first) {
+			m_cells.push_back(entries[i].first);
+			m_cellBegin.push_back(static_cast<signed>(m_items.size()));
+		}
+
+		m_items.push_back(entries[i].second);
+	}
+
+	m_cellBegin.push_back(static_cast<signed>(m_items.size()));
+}
+
+int UniformGrid::column(float p_x) const
+{
+	const int col = static_cast<int>(floorf((p_x - m_origin.x) / m_cellSize));
+	return std::max(0, std::min(col, m_cols - 1));
+}
+
+int UniformGrid::row(float p_y) const
+{
+	const int row = static_cast<int>(floorf((p_y - m_origin.y) / m_cellSize));
+	return std::max(0, std::min(row, m_rows - 1));
+}
+
+void UniformGrid::findSpan(
+		int p_row, int p_col1, int p_col2,
+		int *p_begin, int *p_end
+) const
+{
+	const std::vector<TCell>::const_iterator first = std::lower_bound(
+			m_cells.begin(), m_cells.end(), TCell(p_row, p_col1)
+	);
+
+	const std::vector<TCell>::const_iterator last = std::upper_bound(
+			first, m_cells.end(), TCell(p_row, p_col2)
+	);
+
+	*p_begin = static_cast<int>(first - m_cells.begin());
+	*p_end = static_cast<int>(last - m_cells.begin());
+}
+
+int UniformGrid::getItemCount() const
+{
+	return static_cast<signed>(m_bounds.size());
+}
+
+const CL_Rectf &UniformGrid::getBounds(int p_item) const
+{
+	G_ASSERT(p_item >= 0 && p_item < getItemCount());
+	return m_bounds[p_item];
+}
+
+void UniformGrid::query(const CL_Rectf &p_rect, std::vector<int> *p_result) const
+{
+	G_ASSERT(p_result);
+
+	p_result->clear();
+
+	if (m_bounds.empty()) {
+		return;
+	}
+
+	// item in many cells must be reported once
+	if (++m_queryStamp == 0) {
+		std::fill(m_visited.begin(), m_visited.end(), 0);
+		m_queryStamp = 1;
+	}
+
+	foreach (int item, m_overflow) {
+		if (Rect::overlaps(m_bounds[item], p_rect)) {
+			p_result->push_back(item);
+		}
+	}
+
+	const int left = column(p_rect.left);
+	const int right = column(p_rect.right);
+	const int top = row(p_rect.top);
+	const int bottom = row(p_rect.bottom);
+
+	int begin, end;
+
+	for (int r = top; r <= bottom; ++r) {
+		findSpan(r, left, right, &begin, &end);
+
+		for (int i = m_cellBegin[begin]; i < m_cellBegin[end]; ++i) {
+			const int item = m_items[i];
+
+			if (m_visited[item] == m_queryStamp) {
+				continue;
+			}
+
+			m_visited[item] = m_queryStamp;
+
+			if (Rect::overlaps(m_bounds[item], p_rect)) {
+				p_result->push_back(item);
+			}
+		}
+	}
+}
+
+}
+
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <ClanLib/core.h>
+
+namespace Math
+{
+
+/**
+ * Sparse uniform grid over item bounds.
+ * <p>
+ * Every item is stored in all cells its bounds overlap, and only
+ * non-empty cells are kept. Query cost depends on the queried area
+ * and on what is inside it, not on the size of the whole area or on
+ * the biggest item.
+ */
+class UniformGrid
+{
+	public:
+
+		UniformGrid();
+
+		virtual ~UniformGrid();
+
+
+		/**
+		 * Builds the grid from scratch.
+		 *
+		 * @param p_bounds Bounds of each item.
+		 * @param p_cellSize Cell side length.
+		 */
+		void build(const std::vector<CL_Rectf> &p_bounds, float p_cellSize);
+
+		void clear();
+
+
+		int getItemCount() const;
+
+		const CL_Rectf &getBounds(int p_item) const;
+
+		/**
+		 * Finds items which bounds overlap given rectangle. Each item
+		 * is reported once.
+		 *
+		 * @param p_result Cleared and filled with item indexes.
+		 */
+		void query(const CL_Rectf &p_rect, std::vector<int> *p_result) const;
+
+		/**
+		 * Finds item closest to given point. Cells are visited ring by
+		 * ring around the point until no farther cell can hold anything
+		 * closer.
+		 *
+		 * @param p_distance Functor returning squared distance from the
+		 * point to item of given index.
+		 * @return Closest item or -1 if grid is empty.
+		 */
+		template <typename Distance>
+		int closest(const CL_Pointf &p_pos, const Distance &p_distance) const;
+
+
+	private:
+
+		/** Row and column of a cell */
+		typedef std::pair<int, int> TCell;
+
+
+		/** Items that cover more cells than this are kept aside */
+		static const int MAX_ITEM_CELLS = 1024;
+
+
+		std::vector<CL_Rectf> m_bounds;
+
+		/** Top left corner of the grid */
+		CL_Pointf m_origin;
+
+		float m_cellSize;
+
+		int m_cols, m_rows;
+
+		/** Non-empty cells in row-major order */
+		std::vector<TCell> m_cells;
+
+		/** Begin of each non-empty cell in m_items (one more than cells) */
+		std::vector<int> m_cellBegin;
+
+		/** Item indexes ordered by cell */
+		std::vector<int> m_items;
+
+		/** Items that are too big for cells, checked by every query */
+		std::vector<int> m_overflow;
+
+		/** Last query that reported each item */
+		mutable std::vector<unsigned> m_visited;
+
+		mutable unsigned m_queryStamp;
+
+
+		int column(float p_x) const;
+
+		int row(float p_y) const;
+
+		/** Finds range of non-empty cells in a row between two columns */
+		void findSpan(int p_row, int p_col1, int p_col2, int *p_begin, int *p_end) const;
+
+		/** Checks items of cells from range against the best one */
+		template <typename Distance>
+		void closestInSpan(
+				int p_begin, int p_end,
+				const Distance &p_distance,
+				int *p_best, float *p_bestDist
+		) const;
+};
+
+template <typename Distance>
+void UniformGrid::closestInSpan(
+		int p_begin, int p_end,
+		const Distance &p_distance,
+		int *p_best, float *p_bestDist
+) const
+{
+	for (int i = m_cellBegin[p_begin]; i < m_cellBegin[p_end]; ++i) {
+		const float dist = p_distance(m_items[i]);
+
+		if (*p_best == -1 || dist < *p_bestDist) {
+			*p_bestDist = dist;
+			*p_best = m_items[i];
+		}
+	}
+}
+
+template <typename Distance>
+int UniformGrid::closest(const CL_Pointf &p_pos, const Distance &p_distance) const
+{
+	int best = -1;
+	float bestDist = 0.0f;
+
+	const int overflowCount = static_cast<signed>(m_overflow.size());
+
+	for (int i = 0; i < overflowCount; ++i) {
+		const float dist = p_distance(m_overflow[i]);
+
+		if (best == -1 || dist < bestDist) {
+			bestDist = dist;
+			best = m_overflow[i];
+		}
+	}
+
+	if (m_cells.empty()) {
+		return best;
+	}
+
+	const int col = column(p_pos.x);
+	const int row = this->row(p_pos.y);
+	const int maxRing = std::max(m_cols, m_rows);
+
+	int begin, end;
+
+	for (int ring = 0; ring <= maxRing; ++ring) {
+
+		for (int r = row - ring; r <= row + ring; ++r) {
+			if (r < 0 || r >= m_rows) {
+				continue;
+			}
+
+			if (r == row - ring || r == row + ring) {
+				// whole row of the ring border
+				findSpan(r, col - ring, col + ring, &begin, &end);
+				closestInSpan(begin, end, p_distance, &best, &bestDist);
+			} else {
+				// only side cells
+				findSpan(r, col - ring, col - ring, &begin, &end);
+				closestInSpan(begin, end, p_distance, &best, &bestDist);
+
+				findSpan(r, col + ring, col + ring, &begin, &end);
+				closestInSpan(begin, end, p_distance, &best, &bestDist);
+			}
+		}
+
+		// items outside of this ring can't be closer
+		const float ringDist = ring * m_cellSize;
+
+		if (best != -1 && bestDist <= ringDist * ringDist) {
+			break;
+		}
+	}
+
+	return best;
+}
+
+}
+
@@ -26,6 +26,7 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <math.h>
 #include <unistd.h>
 #include <boost/test/unit_test.hpp>
 
@@ -92,4 +93,53 @@ BOOST_AUTO_TEST_CASE(CloneTest)
 	BOOST_CHECK(car3 != car2);
 }
 
+BOOST_AUTO_TEST_CASE(StartLineCrossing)
+{
+	// line along y axis, race goes to positive x
+	const CL_Pointf origin(0.0f, 0.0f);
+	const CL_Vec2f forward(1.0f, 0.0f);
+
+	Race::Car car;
+
+	// drive at an angle to the line
+	car.setPosition(CL_Pointf(-40.0f, -30.0f));
+	car.setAngle(CL_Angle(30.0f, cl_degrees));
+	car.setStartLine(origin, forward, 100.0f);
+	car.setAcceleration(true);
+
+	float expected = -1.0f;
+
+	for (int i = 0; i < 600 && car.getStartLineCrossCount() == 0; ++i) {
+		const CL_Pointf prev = car.getPosition();
+		const unsigned iter = car.getIterationCount();
+
+		car.update(Race::Car::ITERATION_TIME);
+
+		const CL_Pointf &pos = car.getPosition();
+
+		if (prev.x < 0.0f && pos.x >= 0.0f) {
+			expected = iter + (-prev.x) / (pos.x - prev.x);
+		}
+	}
+
+	BOOST_REQUIRE_EQUAL(car.getStartLineCrossCount(), 1u);
+	BOOST_REQUIRE(expected >= 0.0f);
+
+	// crossing moment is inside of the physics step
+	BOOST_CHECK_CLOSE(car.getStartLineCrossTime(), expected, 0.01f);
+	BOOST_CHECK(car.getStartLineCrossTime() > floor(expected));
+
+	// the same movement outside of the line is not counted
+	Race::Car other;
+
+	other.setPosition(CL_Pointf(-40.0f, -30.0f));
+	other.setAngle(CL_Angle(30.0f, cl_degrees));
+	other.setStartLine(origin, forward, 5.0f);
+	other.setAcceleration(true);
+	other.update(600 * Race::Car::ITERATION_TIME);
+
+	BOOST_CHECK(other.getPosition().x > 0.0f);
+	BOOST_CHECK_EQUAL(other.getStartLineCrossCount(), 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+
+#include "logic/race/LapTimer.h"
+
+/*
+ * Minimal testing facility:
+ *
+ * BOOST_CHECK( predicate )
+ * BOOST_REQUIRE( predicate )
+ * BOOST_ERROR( message )
+ * BOOST_FAIL( message )
+ *
+ * Test tools:
+ * http://www.boost.org/doc/libs/1_34_0/libs/test/doc/components/test_tools/index.html
+ */
+
+BOOST_AUTO_TEST_SUITE(LapTimerTest)
+
+static const float LENGTH = 1000.0f;
+
+BOOST_AUTO_TEST_CASE(crossingBeforeDistance)
+{
+	Race::LapTimer laps(LENGTH);
+
+	// line is crossed while projection is still before the lap end
+	laps.update(990.0f, 99.0f);
+	laps.addCrossing(996.0f, 99.4f);
+	laps.update(996.0f, 100.0f);
+
+	BOOST_CHECK_EQUAL(laps.getLapNumber(), 1);
+
+	laps.update(1004.0f, 101.0f);
+
+	BOOST_REQUIRE_EQUAL(laps.getLapNumber(), 2);
+	BOOST_CHECK_CLOSE(laps.getFinishTime(1), 99.4f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(crossingAfterDistance)
+{
+	Race::LapTimer laps(LENGTH);
+
+	// projection reaches the lap end one update before the line
+	laps.update(1003.0f, 100.0f);
+
+	BOOST_REQUIRE_EQUAL(laps.getLapNumber(), 2);
+
+	laps.addCrossing(1009.0f, 100.6f);
+	laps.update(1009.0f, 101.0f);
+
+	BOOST_CHECK_CLOSE(laps.getFinishTime(1), 100.6f, 0.001f);
+
+	// next crossing near the same lap end does not change it
+	laps.addCrossing(1012.0f, 102.5f);
+
+	BOOST_CHECK_CLOSE(laps.getFinishTime(1), 100.6f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(crossingInSameUpdate)
+{
+	Race::LapTimer laps(LENGTH);
+
+	laps.addCrossing(1002.0f, 99.7f);
+	laps.update(1002.0f, 100.0f);
+
+	BOOST_REQUIRE_EQUAL(laps.getLapNumber(), 2);
+	BOOST_CHECK_CLOSE(laps.getFinishTime(1), 99.7f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(distantCrossings)
+{
+	Race::LapTimer laps(LENGTH);
+
+	// start of the race and the middle of the lap are not lap ends
+	laps.addCrossing(2.0f, 0.5f);
+	laps.addCrossing(500.0f, 50.5f);
+	laps.update(1001.0f, 100.0f);
+
+	BOOST_REQUIRE_EQUAL(laps.getLapNumber(), 2);
+	BOOST_CHECK_CLOSE(laps.getFinishTime(1), 100.0f, 0.001f);
+
+	laps.addCrossing(2003.0f, 199.5f);
+	laps.update(2003.0f, 200.0f);
+
+	BOOST_REQUIRE_EQUAL(laps.getLapNumber(), 3);
+	BOOST_CHECK_CLOSE(laps.getFinishTime(2), 199.5f, 0.001f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
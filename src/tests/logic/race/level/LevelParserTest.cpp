@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+#include "common/Units.h"
+#include "logic/race/level/LevelParser.h"
+#include "logic/race/level/Object.h"
+#include "logic/race/level/Track.h"
+#include "logic/race/level/TrackPoint.h"
+
+static CL_DataBuffer toBuffer(const char *p_text)
+{
+	const int size = strlen(p_text);
+
+	CL_DataBuffer buffer(size);
+	memcpy(buffer.get_data(), p_text, size);
+
+	return buffer;
+}
+
+/** @return Message of parse exception or empty string if parsed */
+static CL_String parseError(const char *p_text)
+{
+	Race::LevelParser parser;
+	Race::Track track;
+	std::vector<Race::Object> objects;
+
+	try {
+		parser.parse(toBuffer(p_text), &track, &objects);
+	} catch (CL_Exception &e) {
+		return e.message;
+	}
+
+	return CL_String();
+}
+
+BOOST_AUTO_TEST_SUITE(LevelParserTest)
+
+BOOST_AUTO_TEST_CASE(demoLevel)
+{
+	Race::LevelParser parser;
+	Race::Track track;
+	std::vector<Race::Object> objects;
+
+	parser.parse(CL_String(TEST_DATA_DIR "/levels/level2.0.xml"), &track, &objects);
+
+	BOOST_REQUIRE_EQUAL(track.getPointCount(), 10);
+
+	const Race::TrackPoint &second = track.getPoint(1);
+
+	BOOST_CHECK_CLOSE(second.getPosition().x, Units::toScreen(200.0f), 0.001f);
+	BOOST_CHECK_SMALL(second.getPosition().y, 0.001f);
+	BOOST_CHECK_CLOSE(second.getRadius(), Units::toScreen(8.0f), 0.001f);
+	BOOST_CHECK_CLOSE(second.getShift(), -1.0f, 0.001f);
+
+	const Race::TrackPoint &last = track.getPoint(9);
+
+	BOOST_CHECK_SMALL(last.getPosition().x, 0.001f);
+	BOOST_CHECK_CLOSE(last.getPosition().y, Units::toScreen(100.0f), 0.001f);
+	BOOST_CHECK_CLOSE(last.getRadius(), Units::toScreen(7.0f), 0.001f);
+
+	// one object with 8 vertices placed 34 times
+	BOOST_REQUIRE_EQUAL(static_cast<int>(objects.size()), 34);
+	BOOST_CHECK_EQUAL(objects[0].getPointCount(), 8);
+
+	BOOST_CHECK_CLOSE(objects[0].getPosition().x, Units::toScreen(200.8f), 0.001f);
+	BOOST_CHECK_CLOSE(objects[0].getPosition().y, Units::toScreen(2.5f), 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(commentsAndInstructions)
+{
+	Race::LevelParser parser;
+	Race::Track track;
+	std::vector<Race::Object> objects;
+
+	parser.parse(
+			toBuffer(
+				"<?xml version=\"1.0\"?>\n"
+				"<!DOCTYPE level>\n"
+				"<level><content>\n"
+				"<!-- <track><point x=\"9\" y=\"9\" radius=\"9\"/></track> -->\n"
+				"<track>\n"
+				"  <?editor hint?>\n"
+				"  <point x='1.5' y=\"-2.25e1\" radius=\"4\" />\n"
+				"  <!-- -> > still a comment -->\n"
+				"</track>\n"
+				"</content></level>\n"
+			),
+			&track, &objects
+	);
+
+	BOOST_REQUIRE_EQUAL(track.getPointCount(), 1);
+
+	const Race::TrackPoint &point = track.getPoint(0);
+
+	BOOST_CHECK_CLOSE(point.getPosition().x, Units::toScreen(1.5f), 0.001f);
+	BOOST_CHECK_CLOSE(point.getPosition().y, Units::toScreen(-22.5f), 0.001f);
+	BOOST_CHECK_SMALL(point.getShift(), 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(numbers)
+{
+	Race::LevelParser parser;
+	Race::Track track;
+	std::vector<Race::Object> objects;
+
+	// values that accumulate rounding error when built digit by digit
+	parser.parse(
+			toBuffer(
+				"<level><content><track>"
+				"<point x=\"0.1\" y=\"123456.789\" radius=\"1e-3\" shift=\"-0.3\"/>"
+				"</track></content></level>"
+			),
+			&track, &objects
+	);
+
+	BOOST_REQUIRE_EQUAL(track.getPointCount(), 1);
+
+	const Race::TrackPoint &point = track.getPoint(0);
+
+	BOOST_CHECK_EQUAL(point.getPosition().x, Units::toScreen(0.1f));
+	BOOST_CHECK_EQUAL(point.getPosition().y, Units::toScreen(123456.789f));
+	BOOST_CHECK_EQUAL(point.getRadius(), Units::toScreen(1e-3f));
+	BOOST_CHECK_EQUAL(point.getShift(), -0.3f);
+}
+
+BOOST_AUTO_TEST_CASE(missingAttribute)
+{
+	const CL_String message = parseError(
+			"<level><content><track>\n"
+			"<point x=\"1\" y=\"2\" />\n"
+			"</track></content></level>\n"
+	);
+
+	BOOST_CHECK_EQUAL(message, "line 2: attribute 'radius' missing in <point>");
+
+	// shift is optional
+	BOOST_CHECK(
+			parseError(
+				"<level><content><track>"
+				"<point x=\"1\" y=\"2\" radius=\"3\" />"
+				"</track></content></level>"
+			).empty()
+	);
+}
+
+BOOST_AUTO_TEST_CASE(errorLine)
+{
+	BOOST_CHECK_EQUAL(
+			parseError(
+				"<level>\n"
+				"<content>\n"
+				"<track>\n"
+				"</content>\n"
+				"</level>\n"
+			),
+			"line 4: unexpected closing tag </content>"
+	);
+
+	BOOST_CHECK_EQUAL(
+			parseError(
+				"<level><content><track>\n"
+				"\n"
+				"<point x=\"1,5\" y=\"2\" radius=\"3\" />\n"
+				"</track></content></level>\n"
+			),
+			"line 3: invalid number '1,5'"
+	);
+
+	BOOST_CHECK_EQUAL(
+			parseError("<level>\n<content>\n"),
+			"line 3: unexpected end of file"
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
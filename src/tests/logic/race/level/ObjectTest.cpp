@@ -27,6 +27,7 @@
  */
 
 #include <unistd.h>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 #include <ClanLib/core.h>
@@ -65,45 +66,218 @@ BOOST_AUTO_TEST_CASE(collision1)
 	};
 
 	Race::Object obj1(pts1, 4);
-	Race::Object obj2(pts2, 4);
 
-	const std::vector<CL_CollidingContours> & contours =
-			obj1.collide(obj2.getCollisionOutline());
+	CL_LineSegment2f contacts[4];
+	const int count = obj1.collide(pts2, 4, contacts, 4);
+
+	BOOST_REQUIRE_EQUAL(count, 2);
 
-	const int count = static_cast<signed>(contours.size());
 	for (int i = 0; i < count; ++i) {
-		const CL_CollidingContours &cc = contours[i];
+		const CL_LineSegment2f &seg = contacts[i];
 
-		const int ccCount = static_cast<signed>(cc.points.size());
-		for (int j = 0; j < ccCount; ++j) {
-			const CL_CollisionPoint &pt = cc.points[j];
+		BOOST_CHECK(
+				seg.p == CL_Pointf(2.0f, 0.0f) ||
+				seg.p == CL_Pointf(2.0f, 2.0f)
+		);
 
-			const std::vector<CL_Pointf> &c1pts = cc.contour1->get_points();
-			const std::vector<CL_Pointf> &c2pts = cc.contour2->get_points();
+		BOOST_CHECK(
+				seg.q == CL_Pointf(2.0f, 2.0f) ||
+				seg.q == CL_Pointf(0.0f, 2.0f)
+		);
+	}
 
-			BOOST_CHECK(
-					c1pts[pt.contour1_line_start] == CL_Pointf(2.0f, 0.0f) ||
-					c1pts[pt.contour1_line_start] == CL_Pointf(2.0f, 2.0f)
-			);
+	// storage limit
+	BOOST_CHECK_EQUAL(obj1.collide(pts2, 4, contacts, 1), 1);
+}
 
-			BOOST_CHECK(
-					c1pts[pt.contour1_line_end] == CL_Pointf(2.0f, 2.0f) ||
-					c1pts[pt.contour1_line_end] == CL_Pointf(0.0f, 2.0f)
-			);
+BOOST_AUTO_TEST_CASE(noCollision)
+{
+	const CL_Pointf pts1[] = {
+			CL_Pointf(0.0f, 0.0f),
+			CL_Pointf(4.0f, 0.0f),
+			CL_Pointf(4.0f, 4.0f),
+			CL_Pointf(0.0f, 4.0f)
+	};
 
+	// bounding boxes overlap, but polygons do not
+	const CL_Pointf outside[] = {
+			CL_Pointf(3.0f, 5.5f),
+			CL_Pointf(5.5f, 3.0f),
+			CL_Pointf(6.0f, 6.0f)
+	};
 
-			BOOST_CHECK(
-					c2pts[pt.contour2_line_start] == CL_Pointf(1.0f, 1.0f) ||
-					c2pts[pt.contour2_line_start] == CL_Pointf(1.0f, 3.0f)
-			);
+	// fully inside, no edge is touched
+	const CL_Pointf inside[] = {
+			CL_Pointf(1.0f, 1.0f),
+			CL_Pointf(3.0f, 1.0f),
+			CL_Pointf(3.0f, 3.0f),
+			CL_Pointf(1.0f, 3.0f)
+	};
+
+	Race::Object obj(pts1, 4);
+
+	CL_LineSegment2f contacts[4];
+
+	BOOST_CHECK_EQUAL(obj.collide(outside, 3, contacts, 4), 0);
+	BOOST_CHECK_EQUAL(obj.collide(inside, 4, contacts, 4), 0);
+}
+
+BOOST_AUTO_TEST_CASE(instance)
+{
+	const CL_Pointf pts[] = {
+			CL_Pointf(0.0f, 0.0f),
+			CL_Pointf(2.0f, 0.0f),
+			CL_Pointf(2.0f, 2.0f),
+			CL_Pointf(0.0f, 2.0f)
+	};
+
+	// car box touching right edge of second instance only
+	const CL_Pointf box[] = {
+			CL_Pointf(11.0f, 1.0f),
+			CL_Pointf(13.0f, 1.0f),
+			CL_Pointf(13.0f, 1.5f),
+			CL_Pointf(11.0f, 1.5f)
+	};
+
+	const Race::ObjectPrototype proto(pts, 4);
+
+	Race::Object obj1(proto, CL_Vec2f(0.0f, 0.0f));
+	Race::Object obj2(proto, CL_Vec2f(10.0f, 0.0f));
+
+	BOOST_CHECK(obj1.getPrototype() == obj2.getPrototype());
+	BOOST_CHECK(obj2.getPoint(1) == CL_Pointf(12.0f, 0.0f));
+	BOOST_CHECK(obj2.getBounds() == CL_Rectf(10.0f, 0.0f, 12.0f, 2.0f));
+
+	CL_LineSegment2f contacts[4];
+
+	BOOST_CHECK_EQUAL(obj1.collide(box, 4, contacts, 4), 0);
+	BOOST_REQUIRE_EQUAL(obj2.collide(box, 4, contacts, 4), 1);
+
+	BOOST_CHECK(contacts[0].p == CL_Pointf(12.0f, 0.0f));
+	BOOST_CHECK(contacts[0].q == CL_Pointf(12.0f, 2.0f));
+}
+
+BOOST_AUTO_TEST_CASE(collisionBenchmark)
+{
+	static const int OBJECT_POINTS = 32;
+	static const float OBJECT_RADIUS = 100.0f;
+	static const int POSITIONS = 256;
+	static const int ITERATIONS = 100;
+
+	// object: regular polygon, car: rotated 18x24 box
+	CL_Pointf pts[OBJECT_POINTS];
+	CL_Contour objContour;
+
+	for (int i = 0; i < OBJECT_POINTS; ++i) {
+		const float a = 2.0f * CL_PI * i / OBJECT_POINTS;
+		pts[i] = CL_Pointf(cos(a) * OBJECT_RADIUS, sin(a) * OBJECT_RADIUS);
+		objContour.get_points().push_back(pts[i]);
+	}
+
+	Race::Object obj(pts, OBJECT_POINTS);
+
+	CL_CollisionOutline objOutline;
+	objOutline.get_contours().push_back(objContour);
+	objOutline.set_inside_test(true);
+	objOutline.calculate_radius();
+	objOutline.calculate_sub_circles();
+	objOutline.enable_collision_info(true, false, true);
+
+	CL_Contour carContour;
+	carContour.get_points().push_back(CL_Pointf(-9.0f, 12.0f));
+	carContour.get_points().push_back(CL_Pointf(9.0f, 12.0f));
+	carContour.get_points().push_back(CL_Pointf(9.0f, -12.0f));
+	carContour.get_points().push_back(CL_Pointf(-9.0f, -12.0f));
 
-			BOOST_CHECK(
-					c2pts[pt.contour2_line_end] == CL_Pointf(3.0f, 1.0f) ||
-					c2pts[pt.contour2_line_end] == CL_Pointf(1.0f, 1.0f)
+	CL_CollisionOutline carOutline;
+	carOutline.get_contours().push_back(carContour);
+	carOutline.set_inside_test(true);
+	carOutline.calculate_radius();
+	carOutline.calculate_smallest_enclosing_discs();
+
+	// car positions around object outline (on heap, arrays are too large)
+	std::vector<CL_Pointf> positions(POSITIONS);
+	std::vector<CL_Angle> angles(POSITIONS);
+	std::vector<CL_Pointf> corners(POSITIONS * 4);
+
+	for (int i = 0; i < POSITIONS; ++i) {
+		const float a = 2.0f * CL_PI * i / POSITIONS;
+		const float r = OBJECT_RADIUS + (i % 5 - 2) * 8.0f;
+
+		positions[i] = CL_Pointf(cos(a) * r, sin(a) * r);
+		angles[i] = CL_Angle(i * 37.0f, cl_degrees);
+
+		for (int j = 0; j < 4; ++j) {
+			const CL_Pointf &c = carContour.get_points()[j];
+			const float rad = angles[i].to_radians();
+
+			corners[i * 4 + j] = CL_Pointf(
+					positions[i].x + c.x * cos(rad) - c.y * sin(rad),
+					positions[i].y + c.x * sin(rad) + c.y * cos(rad)
 			);
+		}
+	}
+
+	// every edge reported by ClanLib must be reported here too
+	CL_LineSegment2f contacts[OBJECT_POINTS];
+	int clanlibContacts = 0, objectContacts = 0;
+
+	for (int i = 0; i < POSITIONS; ++i) {
+		carOutline.set_angle(angles[i]);
+		carOutline.set_translation(positions[i].x, positions[i].y);
 
+		const int count = obj.collide(&corners[i * 4], 4, contacts, OBJECT_POINTS);
+		objectContacts += count;
+
+		if (!objOutline.collide(carOutline)) {
+			continue;
+		}
+
+		foreach (const CL_CollidingContours &cc, objOutline.get_collision_info()) {
+			foreach (const CL_CollisionPoint &pt, cc.points) {
+				const CL_Pointf &p = pts[pt.contour1_line_start];
+				const CL_Pointf &q = pts[pt.contour1_line_end];
+
+				bool found = false;
+
+				for (int j = 0; j < count && !found; ++j) {
+					found = contacts[j].p == p && contacts[j].q == q;
+				}
+
+				BOOST_CHECK(found);
+				++clanlibContacts;
+			}
 		}
 	}
+
+	// timings
+	unsigned start = CL_System::get_time();
+
+	for (int n = 0; n < ITERATIONS; ++n) {
+		for (int i = 0; i < POSITIONS; ++i) {
+			carOutline.set_angle(angles[i]);
+			carOutline.set_translation(positions[i].x, positions[i].y);
+
+			objOutline.collide(carOutline);
+		}
+	}
+
+	const unsigned clanlibTime = CL_System::get_time() - start;
+	start = CL_System::get_time();
+
+	for (int n = 0; n < ITERATIONS; ++n) {
+		for (int i = 0; i < POSITIONS; ++i) {
+			obj.collide(&corners[i * 4], 4, contacts, OBJECT_POINTS);
+		}
+	}
+
+	const unsigned objectTime = CL_System::get_time() - start;
+
+	BOOST_TEST_MESSAGE(
+			"CL_CollisionOutline: " << clanlibTime << " ms ("
+			<< clanlibContacts << " contacts), Object::collide(): "
+			<< objectTime << " ms (" << objectContacts << " contacts)"
+	);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
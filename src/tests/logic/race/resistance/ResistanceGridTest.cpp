@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+#include "logic/race/resistance/Geometry.h"
+#include "logic/race/resistance/ResistanceGrid.h"
+
+BOOST_AUTO_TEST_SUITE(ResistanceGridTest)
+
+BOOST_AUTO_TEST_CASE(fillValue)
+{
+	RaceResistance::ResistanceGrid grid;
+	grid.create(CL_Rectf(0.0f, 0.0f, 100.0f, 100.0f), 10.0f, 1.0f, 0.5f);
+
+	// inside and outside of grid
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(50.0f, 50.0f)), 0.5f, 1.0f);
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(-50.0f, 500.0f)), 0.5f, 1.0f);
+	BOOST_CHECK_CLOSE(grid.sample(CL_Pointf(5.0f, 95.0f)), 0.5f, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(triangle)
+{
+	RaceResistance::ResistanceGrid grid;
+	grid.create(CL_Rectf(0.0f, 0.0f, 100.0f, 100.0f), 10.0f, 1.0f, 1.0f);
+
+	// counter clockwise, lower left half of the grid
+	grid.fillTriangle(
+			CL_Pointf(0.0f, 0.0f), CL_Pointf(0.0f, 100.0f), CL_Pointf(100.0f, 100.0f),
+			0.0f
+	);
+
+	BOOST_CHECK_SMALL(grid.get(CL_Pointf(15.0f, 85.0f)), 0.01f);
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(85.0f, 15.0f)), 1.0f, 1.0f);
+
+	// bilinear sample between two cell centres
+	grid.create(CL_Rectf(0.0f, 0.0f, 20.0f, 10.0f), 10.0f, 1.0f, 1.0f);
+	grid.fillTriangle(
+			CL_Pointf(0.0f, -10.0f), CL_Pointf(10.0f, -10.0f), CL_Pointf(0.0f, 30.0f),
+			0.0f
+	);
+
+	BOOST_CHECK_SMALL(grid.get(CL_Pointf(5.0f, 5.0f)), 0.01f);
+	BOOST_CHECK_CLOSE(grid.sample(CL_Pointf(10.0f, 5.0f)), 0.5f, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(hugeBounds)
+{
+	// 200000 cells on one side, far more than a dense grid could hold
+	RaceResistance::ResistanceGrid grid;
+	grid.create(CL_Rectf(0.0f, 0.0f, 200000.0f, 200000.0f), 1.0f, 1.0f, 1.0f);
+
+	BOOST_CHECK_CLOSE(grid.getCellSize(), 1.0f, 0.01f);
+
+	// narrow strip of track far from the origin
+	grid.fillTriangle(
+			CL_Pointf(150000.0f, 150000.0f), CL_Pointf(150100.0f, 150000.0f),
+			CL_Pointf(150100.0f, 150004.0f),
+			0.0f
+	);
+
+	grid.fillTriangle(
+			CL_Pointf(150000.0f, 150000.0f), CL_Pointf(150100.0f, 150004.0f),
+			CL_Pointf(150000.0f, 150004.0f),
+			0.0f
+	);
+
+	BOOST_CHECK_SMALL(grid.get(CL_Pointf(150050.0f, 150002.0f)), 0.01f);
+	BOOST_CHECK_SMALL(grid.get(CL_Pointf(150000.5f, 150003.5f)), 0.01f);
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(150050.0f, 150006.0f)), 1.0f, 1.0f);
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(1000.0f, 1000.0f)), 1.0f, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(geometryIntersection)
+{
+	RaceResistance::Geometry geom;
+	geom.addCircle(CL_Circlef(CL_Pointf(0.0f, 0.0f), 50.0f));
+	geom.andRect(CL_Rectf(0.0f, 0.0f, 100.0f, 100.0f));
+
+	BOOST_CHECK(geom.contains(CL_Pointf(10.0f, 10.0f)));
+	BOOST_CHECK(!geom.contains(CL_Pointf(-10.0f, -10.0f)));
+	BOOST_CHECK(!geom.contains(CL_Pointf(60.0f, 60.0f)));
+
+	RaceResistance::ResistanceGrid grid;
+	grid.create(CL_Rectf(-100.0f, -100.0f, 100.0f, 100.0f), 10.0f, 1.0f, 0.0f);
+	grid.fill(geom, 1.0f);
+
+	BOOST_CHECK_CLOSE(grid.get(CL_Pointf(15.0f, 15.0f)), 1.0f, 1.0f);
+	BOOST_CHECK_SMALL(grid.get(CL_Pointf(-15.0f, -15.0f)), 0.01f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -84,4 +84,70 @@ BOOST_AUTO_TEST_CASE(EasingNoneLoop)
 	BOOST_CHECK_CLOSE(f.get(), 1.0f, 0.01f);
 }
 
+BOOST_AUTO_TEST_CASE(Queued)
+{
+	Math::Float f;
+	f.animate(0.0f, 1.0f, 100, Math::Easing::NONE);
+	f.animate(1.0f, 0.0f, 1000, Math::Easing::NONE, 500);
+
+	f.update(50);
+	BOOST_CHECK_CLOSE(f.get(), 0.5f, 0.01f);
+
+	// first one has ended, second one has not started yet
+	f.update(250);
+	BOOST_CHECK_CLOSE(f.get(), 1.0f, 0.01f);
+
+	f.update(700);
+	BOOST_CHECK_CLOSE(f.get(), 0.5f, 0.01f);
+
+	f.update(1000);
+	BOOST_CHECK(f.get() == 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(SameStartReplaces)
+{
+	Math::Float f;
+	f.animate(0.0f, 1.0f, 1000, Math::Easing::NONE, 100);
+	f.animate(0.0f, 2.0f, 1000, Math::Easing::NONE, 100);
+
+	f.update(600);
+	BOOST_CHECK_CLOSE(f.get(), 1.0f, 0.01f);
+}
+
+BOOST_AUTO_TEST_CASE(QueueOverflow)
+{
+	Math::Float f;
+
+	for (int i = 1; i <= Math::Float::MAX_QUEUED; ++i) {
+		f.animate(i, i, 10, Math::Easing::NONE, i * 100);
+	}
+
+	// queue is full, the one that would start last is dropped
+	f.animate(9.0f, 9.0f, 10, Math::Easing::NONE, 1000);
+
+	// starts first, so the last queued one is dropped
+	f.animate(5.0f, 5.0f, 10, Math::Easing::NONE, 50);
+
+	f.update(55);
+	BOOST_CHECK_CLOSE(f.get(), 5.0f, 0.01f);
+
+	f.update(50);
+	BOOST_CHECK_CLOSE(f.get(), 1.0f, 0.01f);
+
+	f.update(1000);
+	BOOST_CHECK_CLOSE(f.get(), 3.0f, 0.01f);
+}
+
+BOOST_AUTO_TEST_CASE(Copy)
+{
+	Math::Float f;
+	f.animate(0.0f, 1.0f, 1000, Math::Easing::NONE);
+
+	Math::Float g = f;
+	g.update(500);
+
+	BOOST_CHECK(f.get() == 0.0f);
+	BOOST_CHECK_CLOSE(g.get(), 0.5f, 0.01f);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
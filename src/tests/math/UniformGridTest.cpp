@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <stdlib.h>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <ClanLib/core.h>
+
+#include "common.h"
+#include "math/Rect.h"
+#include "math/UniformGrid.h"
+
+/** Squared distance from fixed point to item bounds centre */
+class CentreDistance
+{
+	public:
+
+		CentreDistance(const std::vector<CL_Rectf> &p_bounds, const CL_Pointf &p_pos) :
+			m_bounds(p_bounds),
+			m_pos(p_pos)
+		{ /* empty */ }
+
+		float operator()(int p_item) const
+		{
+			const CL_Rectf &r = m_bounds[p_item];
+
+			const float dx = (r.left + r.right) / 2.0f - m_pos.x;
+			const float dy = (r.top + r.bottom) / 2.0f - m_pos.y;
+
+			return dx * dx + dy * dy;
+		}
+
+	private:
+
+		const std::vector<CL_Rectf> &m_bounds;
+
+		CL_Pointf m_pos;
+};
+
+static std::vector<CL_Rectf> randomBounds(int p_count, float p_area, float p_maxSize)
+{
+	std::vector<CL_Rectf> bounds;
+
+	for (int i = 0; i < p_count; ++i) {
+		const float x = p_area * (rand() / static_cast<float>(RAND_MAX));
+		const float y = p_area * (rand() / static_cast<float>(RAND_MAX));
+		const float w = p_maxSize * (rand() / static_cast<float>(RAND_MAX));
+		const float h = p_maxSize * (rand() / static_cast<float>(RAND_MAX));
+
+		bounds.push_back(CL_Rectf(x, y, x + w, y + h));
+	}
+
+	return bounds;
+}
+
+BOOST_AUTO_TEST_SUITE(UniformGridTest)
+
+BOOST_AUTO_TEST_CASE(query)
+{
+	srand(1);
+
+	std::vector<CL_Rectf> bounds = randomBounds(500, 10000.0f, 200.0f);
+
+	// one item over the whole area is kept out of cells
+	bounds.push_back(CL_Rectf(-100.0f, 5000.0f, 20000.0f, 5001.0f));
+
+	Math::UniformGrid grid;
+	grid.build(bounds, 50.0f);
+
+	BOOST_CHECK_EQUAL(grid.getItemCount(), static_cast<int>(bounds.size()));
+
+	std::vector<int> result, expected;
+
+	for (int q = 0; q < 100; ++q) {
+		const CL_Rectf rect = randomBounds(1, 11000.0f, 1000.0f)[0];
+
+		grid.query(rect, &result);
+
+		expected.clear();
+
+		for (int i = 0; i < static_cast<int>(bounds.size()); ++i) {
+			if (Math::Rect::overlaps(bounds[i], rect)) {
+				expected.push_back(i);
+			}
+		}
+
+		// every item reported once
+		std::sort(result.begin(), result.end());
+		BOOST_CHECK(result == expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(closest)
+{
+	srand(2);
+
+	const std::vector<CL_Rectf> bounds = randomBounds(300, 5000.0f, 0.0f);
+
+	Math::UniformGrid grid;
+	grid.build(bounds, 100.0f);
+
+	for (int q = 0; q < 100; ++q) {
+		// some points lay far outside of the grid
+		const CL_Rectf p = randomBounds(1, 8000.0f, 0.0f)[0];
+		const CL_Pointf pos(p.left - 1500.0f, p.top - 1500.0f);
+
+		const CentreDistance distance(bounds, pos);
+
+		int best = 0;
+
+		for (int i = 1; i < static_cast<int>(bounds.size()); ++i) {
+			if (distance(i) < distance(best)) {
+				best = i;
+			}
+		}
+
+		const int found = grid.closest(pos, distance);
+
+		BOOST_REQUIRE(found != -1);
+		BOOST_CHECK_CLOSE(distance(found), distance(best), 0.001f);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+	Math::UniformGrid grid;
+	grid.build(std::vector<CL_Rectf>(), 10.0f);
+
+	std::vector<int> result(1, 0);
+	grid.query(CL_Rectf(0.0f, 0.0f, 10.0f, 10.0f), &result);
+
+	BOOST_CHECK(result.empty());
+	BOOST_CHECK_EQUAL(
+			grid.closest(CL_Pointf(), CentreDistance(std::vector<CL_Rectf>(), CL_Pointf())),
+			-1
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ClanLib/core.h>
+#include <ClanLib/application.h>
+
+#include "logic/race/level/CompiledLevel.h"
+#include "logic/race/level/Level.h"
+
+/**
+ * Compiles XML level into binary *.glev file.
+ * <p>
+ * Usage: levelc level.xml [output.glev]
+ */
+class LevelCompiler {
+	public:
+		static int main(const std::vector<CL_String> &args);
+};
+
+CL_ClanApplication app(&LevelCompiler::main);
+
+int LevelCompiler::main(const std::vector<CL_String> &args)
+{
+	CL_SetupCore setup_core;
+	CL_ConsoleLogger logger;
+
+	if (args.size() < 2) {
+		CL_Console::write_line("usage: %1 <level.xml> [output.glev]", args[0]);
+		return 1;
+	}
+
+	const CL_String &source = args[1];
+	const CL_String output = args.size() >= 3 ?
+			args[2] : Race::CompiledLevel::getCompiledName(source);
+
+	if (output == source) {
+		CL_Console::write_line("source is already compiled: %1", source);
+		return 1;
+	}
+
+	try {
+		Race::Level level;
+		level.initialize();
+
+		if (!level.load(source)) {
+			return 1;
+		}
+
+		Race::CompiledLevel::write(
+				level,
+				Race::CompiledLevel::hashFile(source),
+				output
+		);
+
+		CL_Console::write_line("%1 -> %2", source, output);
+
+	} catch (CL_Exception &e) {
+		CL_Console::write_line("cannot compile level: %1", e.message);
+		return 1;
+	}
+
+	return 0;
+}
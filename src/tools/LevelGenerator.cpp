@@ -0,0 +1,450 @@
+/*
+ * Copyright (c) 2009-2010, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <vector>
+
+#include <ClanLib/core.h>
+#include <ClanLib/application.h>
+
+#include "common.h"
+#include "logic/race/level/CompiledLevel.h"
+#include "logic/race/level/Level.h"
+
+/**
+ * Generates random levels of any size, so performance can be measured
+ * on tracks much longer than the shipped ones. The same seed and
+ * parameters always give the same level.
+ * <p>
+ * Usage: levelgen [options] output.xml
+ * <p>
+ * Options:
+ * <ul>
+ * <li>-p count - track points (10 - 10000, default 100)</li>
+ * <li>-s seed - random seed (default 1)</li>
+ * <li>-r meters - track radius (default 8)</li>
+ * <li>-v meters - track radius variation (default 2)</li>
+ * <li>-h value - shift variation (0 - 1, default 0.5)</li>
+ * <li>-d value - objects per track point (default 1)</li>
+ * <li>-c - compile the level (*.glev) too</li>
+ * </ul>
+ * <p>
+ * Reference corpus: -p 10 (small), -p 500 (medium) and -p 10000 (huge),
+ * all with default seed.
+ */
+class LevelGenerator {
+	public:
+		static int main(const std::vector<CL_String> &args);
+};
+
+CL_ClanApplication app(&LevelGenerator::main);
+
+/** Platform independent random numbers (xorshift) */
+class Random
+{
+	public:
+
+		Random(unsigned p_seed) :
+			m_state(p_seed != 0 ? p_seed : 1)
+		{ /* empty */ }
+
+		/** @return Random number in [0, 1) */
+		float next()
+		{
+			m_state ^= m_state << 13;
+			m_state ^= m_state >> 17;
+			m_state ^= m_state << 5;
+
+			return (m_state >> 8) / 16777216.0f;
+		}
+
+		/** @return Random number in [p_from, p_to) */
+		float range(float p_from, float p_to)
+		{
+			return p_from + next() * (p_to - p_from);
+		}
+
+	private:
+
+		unsigned m_state;
+};
+
+struct GeneratorParams
+{
+	int m_points;
+	unsigned m_seed;
+	float m_radius;
+	float m_radiusVariation;
+	float m_shiftVariation;
+	float m_objectDensity;
+	bool m_compile;
+	CL_String m_output;
+};
+
+/** Track point in meters */
+struct GeneratedPoint
+{
+	float m_x, m_y, m_radius, m_shift;
+};
+
+static void writeLine(CL_File &p_file, const char *p_format, ...)
+{
+	char buffer[256];
+
+	va_list args;
+	va_start(args, p_format);
+	const int length = vsnprintf(buffer, sizeof(buffer), p_format, args);
+	va_end(args);
+
+	// truncated line would leave broken xml
+	if (length < 0 || length >= static_cast<int>(sizeof(buffer))) {
+		throw CL_Exception("cannot format level line");
+	}
+
+	p_file.write(buffer, length);
+}
+
+/**
+ * Builds closed track around star-shaped curve (radius is positive for
+ * every angle), so the track never crosses itself.
+ */
+static void generateTrack(
+		const GeneratorParams &p_params,
+		Random &p_random,
+		std::vector<GeneratedPoint> *p_points
+)
+{
+	// distance between track points (m)
+	static const float SPACING = 40.0f;
+	// sum of harmonic amplitudes must stay below 1
+	static const int HARMONICS = 4;
+	static const float MAX_AMPLITUDE = 0.2f;
+	// limits radius change between two points to this part of spacing
+	static const float MAX_STEP = 0.5f;
+	// the narrowest track (m)
+	static const float MIN_RADIUS = 3.0f;
+
+	const int count = p_params.m_points;
+	const float baseRadius = count * SPACING / (2.0f * CL_PI);
+
+	float amplitudes[HARMONICS], phases[HARMONICS];
+	int frequencies[HARMONICS];
+
+	for (int h = 0; h < HARMONICS; ++h) {
+		// low frequencies give long curves, high ones give chicanes
+		frequencies[h] = 2 + static_cast<int>(p_random.range(0.0f, count / 8.0f));
+
+		// high frequencies must be shallow to keep curves smooth
+		amplitudes[h] = p_random.range(
+				0.0f, std::min(MAX_AMPLITUDE, MAX_STEP / frequencies[h])
+		);
+
+		phases[h] = p_random.range(0.0f, 2.0f * CL_PI);
+	}
+
+	p_points->resize(count);
+
+	for (int i = 0; i < count; ++i) {
+		const float angle = 2.0f * CL_PI * i / count;
+
+		float r = 1.0f;
+
+		for (int h = 0; h < HARMONICS; ++h) {
+			r += amplitudes[h] * sin(frequencies[h] * angle + phases[h]);
+		}
+
+		r *= baseRadius;
+
+		GeneratedPoint &pt = (*p_points)[i];
+
+		pt.m_x = cos(angle) * r;
+		pt.m_y = sin(angle) * r;
+
+		pt.m_radius = std::max(
+				MIN_RADIUS,
+				p_params.m_radius + p_random.range(
+						-p_params.m_radiusVariation, p_params.m_radiusVariation
+				)
+		);
+
+		pt.m_shift = p_random.range(
+				-p_params.m_shiftVariation, p_params.m_shiftVariation
+		);
+	}
+}
+
+static void writeObject(
+		CL_File &p_file,
+		const char *p_name,
+		const CL_Pointf p_geometry[], int p_count,
+		const std::vector<CL_Pointf> &p_positions
+)
+{
+	writeLine(p_file, "\t\t\t<object name=\"%s\">\n", p_name);
+	writeLine(p_file, "\t\t\t\t<geometry>\n");
+
+	for (int i = 0; i < p_count; ++i) {
+		writeLine(
+				p_file, "\t\t\t\t\t<vertex x=\"%.2f\" y=\"%.2f\" />\n",
+				p_geometry[i].x, p_geometry[i].y
+		);
+	}
+
+	writeLine(p_file, "\t\t\t\t</geometry>\n");
+	writeLine(p_file, "\t\t\t\t<refs>\n");
+
+	foreach (const CL_Pointf &pos, p_positions) {
+		writeLine(
+				p_file,
+				"\t\t\t\t\t<ref><position x=\"%.2f\" y=\"%.2f\" /></ref>\n",
+				pos.x, pos.y
+		);
+	}
+
+	writeLine(p_file, "\t\t\t\t</refs>\n");
+	writeLine(p_file, "\t\t\t</object>\n");
+}
+
+static void writeLevel(
+		const GeneratorParams &p_params,
+		const std::vector<GeneratedPoint> &p_points,
+		Random &p_random
+)
+{
+	// distance of objects from track edge (m)
+	static const float OBJECT_DISTANCE = 2.5f;
+	static const float OBJECT_SPREAD = 3.0f;
+
+	// tyre (same as in demo level) and concrete block
+	static const CL_Pointf TYRE[] = {
+			CL_Pointf(-0.5f, 0.0f), CL_Pointf(-0.35f, 0.35f),
+			CL_Pointf(0.0f, 0.5f), CL_Pointf(0.35f, 0.35f),
+			CL_Pointf(0.5f, 0.0f), CL_Pointf(0.35f, -0.35f),
+			CL_Pointf(0.0f, -0.5f), CL_Pointf(-0.35f, -0.35f)
+	};
+
+	static const CL_Pointf BLOCK[] = {
+			CL_Pointf(-1.0f, -0.5f), CL_Pointf(1.0f, -0.5f),
+			CL_Pointf(1.0f, 0.5f), CL_Pointf(-1.0f, 0.5f)
+	};
+
+	const int count = static_cast<signed>(p_points.size());
+
+	// objects are placed by the track, on both sides
+	std::vector<CL_Pointf> tyres, blocks;
+
+	for (int i = 0; i < count; ++i) {
+		const GeneratedPoint &prev = p_points[(i + count - 1) % count];
+		const GeneratedPoint &curr = p_points[i];
+		const GeneratedPoint &next = p_points[(i + 1) % count];
+
+		CL_Vec2f normal(prev.m_y - next.m_y, next.m_x - prev.m_x);
+		normal.normalize();
+
+		float expected = p_params.m_objectDensity;
+
+		while (expected > 0.0f) {
+			if (expected < 1.0f && p_random.next() >= expected) {
+				break;
+			}
+
+			expected -= 1.0f;
+
+			const float side = p_random.next() < 0.5f ? -1.0f : 1.0f;
+			const float distance =
+					curr.m_radius + OBJECT_DISTANCE
+					+ p_random.range(0.0f, OBJECT_SPREAD);
+
+			const CL_Pointf pos(
+					curr.m_x + normal.x * distance * side,
+					curr.m_y + normal.y * distance * side
+			);
+
+			if (p_random.next() < 0.8f) {
+				tyres.push_back(pos);
+			} else {
+				blocks.push_back(pos);
+			}
+		}
+	}
+
+	CL_File file(p_params.m_output, CL_File::create_always, CL_File::access_write);
+
+	writeLine(file, "<level format=\"1.0\">\n");
+	writeLine(file, "\t<meta>\n");
+	writeLine(
+			file,
+			"\t\t<name>Generated %d points, seed %u</name>\n",
+			p_params.m_points, p_params.m_seed
+	);
+	writeLine(file, "\t</meta>\n");
+	writeLine(file, "\t<content>\n");
+	writeLine(file, "\t\t<track>\n");
+
+	foreach (const GeneratedPoint &pt, p_points) {
+		writeLine(
+				file,
+				"\t\t\t<point x=\"%.2f\" y=\"%.2f\" radius=\"%.2f\" shift=\"%.2f\" />\n",
+				pt.m_x, pt.m_y, pt.m_radius, pt.m_shift
+		);
+	}
+
+	writeLine(file, "\t\t</track>\n");
+	writeLine(file, "\t\t<objects>\n");
+
+	if (!tyres.empty()) {
+		writeObject(file, "tyre", TYRE, sizeof(TYRE) / sizeof(TYRE[0]), tyres);
+	}
+
+	if (!blocks.empty()) {
+		writeObject(file, "block", BLOCK, sizeof(BLOCK) / sizeof(BLOCK[0]), blocks);
+	}
+
+	writeLine(file, "\t\t</objects>\n");
+	writeLine(file, "\t</content>\n");
+	writeLine(file, "</level>\n");
+
+	file.close();
+
+	CL_Console::write_line(
+			"%1: %2 track points, %3 objects",
+			p_params.m_output, count, tyres.size() + blocks.size()
+	);
+}
+
+static bool parseArgs(const std::vector<CL_String> &args, GeneratorParams *p_params)
+{
+	p_params->m_points = 100;
+	p_params->m_seed = 1;
+	p_params->m_radius = 8.0f;
+	p_params->m_radiusVariation = 2.0f;
+	p_params->m_shiftVariation = 0.5f;
+	p_params->m_objectDensity = 1.0f;
+	p_params->m_compile = false;
+
+	const int count = static_cast<signed>(args.size());
+
+	for (int i = 1; i < count; ++i) {
+		const CL_String &arg = args[i];
+
+		if (arg == "-c") {
+			p_params->m_compile = true;
+		} else if (arg.length() == 2 && arg[0] == '-' && i + 1 < count) {
+			const CL_String &value = args[++i];
+
+			switch (arg[1]) {
+				case 'p':
+					p_params->m_points = CL_StringHelp::local8_to_int(value);
+					break;
+				case 's':
+					p_params->m_seed = CL_StringHelp::local8_to_uint(value);
+					break;
+				case 'r':
+					p_params->m_radius = CL_StringHelp::local8_to_float(value);
+					break;
+				case 'v':
+					p_params->m_radiusVariation = CL_StringHelp::local8_to_float(value);
+					break;
+				case 'h':
+					p_params->m_shiftVariation = CL_StringHelp::local8_to_float(value);
+					break;
+				case 'd':
+					p_params->m_objectDensity = CL_StringHelp::local8_to_float(value);
+					break;
+				default:
+					return false;
+			}
+		} else if (p_params->m_output.empty() && arg[0] != '-') {
+			p_params->m_output = arg;
+		} else {
+			return false;
+		}
+	}
+
+	return
+			!p_params->m_output.empty()
+			&& p_params->m_points >= 10 && p_params->m_points <= 10000
+			&& p_params->m_radius > 0.0f
+			&& p_params->m_radiusVariation >= 0.0f
+			&& p_params->m_shiftVariation >= 0.0f && p_params->m_shiftVariation <= 1.0f
+			&& p_params->m_objectDensity >= 0.0f;
+}
+
+int LevelGenerator::main(const std::vector<CL_String> &args)
+{
+	CL_SetupCore setup_core;
+	CL_ConsoleLogger logger;
+
+	GeneratorParams params;
+
+	if (!parseArgs(args, &params)) {
+		CL_Console::write_line(
+				"usage: %1 [-p points] [-s seed] [-r radius] [-v radius_variation] "
+				"[-h shift_variation] [-d object_density] [-c] <output.xml>",
+				args[0]
+		);
+		return 1;
+	}
+
+	try {
+		Random random(params.m_seed);
+
+		std::vector<GeneratedPoint> points;
+		generateTrack(params, random, &points);
+		writeLevel(params, points, random);
+
+		if (params.m_compile) {
+			Race::Level level;
+			level.initialize();
+
+			if (!level.load(params.m_output)) {
+				return 1;
+			}
+
+			const CL_String output =
+					Race::CompiledLevel::getCompiledName(params.m_output);
+
+			Race::CompiledLevel::write(
+					level,
+					Race::CompiledLevel::hashFile(params.m_output),
+					output
+			);
+
+			CL_Console::write_line("%1 -> %2", params.m_output, output);
+		}
+
+	} catch (CL_Exception &e) {
+		CL_Console::write_line("cannot generate level: %1", e.message);
+		return 1;
+	}
+
+	return 0;
+}